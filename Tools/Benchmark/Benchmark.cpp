@@ -0,0 +1,484 @@
+#include "pch.hpp"
+#include "PluginCore.h"
+#include "PluginCore/CommonExtenderPlatform.h"
+#include "PluginCore/InitializationEvent.h"
+#include "PluginCore/TimerService.h"
+#include "PluginCore/Coroutine.h"
+#include "PluginCore/EventBus.h"
+#include "PluginCore/WorkerPool.h"
+#include "PluginCore/FormCache.h"
+#include "PluginCore/MemoryTracker.h"
+#include "PluginCore/UTF8.h"
+#include "PluginCore/ScriptExtenderDefinesBase.h"
+#include "PluginCore/ScriptExtenderDefinesExtra.h"
+#include "PluginCore/ScriptExtenderInterfaceIncludes.h"
+
+#include <kxf/EventSystem/EvtHandler.h>
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <unordered_map>
+
+namespace
+{
+	using namespace xSE;
+
+	constexpr auto g_PlatformType = PlatformType::SKSE64;
+
+	class BenchmarkPlugin final: public kxf::RTTI::Implementation<BenchmarkPlugin, kxf::EvtHandler, IExtenderPlugin>
+	{
+		public:
+			BenchmarkPlugin()
+			{
+				Bind(InitializationEvent::EvtQuery, [](InitializationEvent& event)
+				{
+				});
+				Bind(InitializationEvent::EvtLoad, [](InitializationEvent& event)
+				{
+				});
+			}
+
+		public:
+			// IExtenderPlugin
+			kxf::String GetName() const override
+			{
+				return "PluginCoreBenchmark";
+			}
+			kxf::String GetAuthor() const override
+			{
+				return "xSE PluginDev";
+			}
+			kxf::Version GetVersion() const override
+			{
+				return kxf::Version("1.0");
+			}
+			kxf::FlagSet<ExtenderPluginFlag> GetFlags() const override
+			{
+				return ExtenderPluginFlag::None;
+			}
+	};
+
+	CommonExtenderPlatform& GetSharedPlatform()
+	{
+		static CommonExtenderPlatform g_Platform(g_PlatformType);
+		return g_Platform;
+	}
+}
+
+namespace
+{
+	void BM_GetName(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			benchmark::DoNotOptimize(platform.GetName());
+		}
+	}
+	void BM_GetGameName(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			benchmark::DoNotOptimize(platform.GetGameName());
+		}
+	}
+	void BM_GetFullName(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			benchmark::DoNotOptimize(platform.GetFullName());
+		}
+	}
+
+	void BM_DirectoryAccessor(benchmark::State& state, std::shared_ptr<kxf::IFileSystem>(CommonExtenderPlatform::*func)() const)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			benchmark::DoNotOptimize((platform.*func)());
+		}
+	}
+
+	// Arguments: has category, indent
+	void BM_LogString(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+
+		const kxf::String category = state.range(0) != 0 ? "Benchmark" : "";
+		const size_t indent = static_cast<size_t>(state.range(1));
+		const kxf::String message = "The quick brown fox jumps over the lazy dog";
+
+		for (auto _: state)
+		{
+			platform.LogString(category, message, indent);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	void BM_LogSymbol(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+
+		const Symbol category = SymbolTable::GetInstance().Intern(std::string_view("Benchmark"));
+		const kxf::String message = "The quick brown fox jumps over the lazy dog";
+
+		for (auto _: state)
+		{
+			platform.LogSymbol(category, message, 0);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	void BM_Log(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			platform.Log("Processed {} of {} items in '{}'", 42, 100, "Benchmark");
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	void BM_LogCategory(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+
+		const Symbol category = SymbolTable::GetInstance().Intern(std::string_view("Benchmark"));
+		for (auto _: state)
+		{
+			platform.LogCategory<1>(category, "Processed {} of {} items in '{}'", 42, 100, "Benchmark");
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	void BM_LogPlatform(benchmark::State& state)
+	{
+		auto& platform = GetSharedPlatform();
+		for (auto _: state)
+		{
+			platform.LogPlatform<2>("Processed {} of {} items in '{}'", 42, 100, "Benchmark");
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	// Arguments: string length, whether it's ASCII only. The framework conversion is the baseline.
+	void BM_UTF8Encode(benchmark::State& state)
+	{
+		std::wstring text;
+		for (int64_t i = 0; i < state.range(0); i++)
+		{
+			text += state.range(1) != 0 || i % 16 != 0 ? static_cast<wchar_t>(L'a' + i % 26) : L'\x0416';
+		}
+		const kxf::String value(text.c_str());
+
+		std::string buffer;
+		for (auto _: state)
+		{
+			buffer.clear();
+			UTF8::Append(buffer, value);
+			benchmark::DoNotOptimize(buffer.data());
+		}
+		state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(wchar_t));
+	}
+	void BM_UTF8EncodeFramework(benchmark::State& state)
+	{
+		const kxf::String value(std::string(static_cast<size_t>(state.range(0)), 'a'));
+		for (auto _: state)
+		{
+			benchmark::DoNotOptimize(value.ToUTF8());
+		}
+		state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(wchar_t));
+	}
+
+	// Arguments: pending timers
+	void BM_TimerScheduleCancel(benchmark::State& state)
+	{
+		TimerService timers;
+		for (int64_t i = 0; i < state.range(0); i++)
+		{
+			timers.Schedule(TimerClock::GameTime, std::chrono::milliseconds(1000 + i), []()
+			{
+			});
+		}
+
+		for (auto _: state)
+		{
+			auto handle = timers.Schedule(TimerClock::GameTime, std::chrono::milliseconds(500), []()
+			{
+			});
+			benchmark::DoNotOptimize(timers.Cancel(handle));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	// Arguments: repeating timers, each one fires every 100 ms and the frames are 16 ms long
+	void BM_TimerAdvance(benchmark::State& state)
+	{
+		size_t fired = 0;
+		TimerService timers;
+		for (int64_t i = 0; i < state.range(0); i++)
+		{
+			timers.ScheduleRepeating(TimerClock::RealTime, std::chrono::milliseconds(100 + i % 100), [&]()
+			{
+				fired++;
+			});
+		}
+
+		for (auto _: state)
+		{
+			timers.Advance(std::chrono::milliseconds(16), {});
+		}
+		state.counters["fired"] = benchmark::Counter(static_cast<double>(fired), benchmark::Counter::kAvgIterations);
+	}
+
+	Task<int> GetValue(int value)
+	{
+		co_return value;
+	}
+	Task<> SumValues(int count, int& result)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			result += co_await GetValue(i);
+		}
+	}
+
+	// One task awaiting a thousand short child tasks, measures frame allocation and the transfers between them
+	void BM_TaskAwait(benchmark::State& state)
+	{
+		int result = 0;
+		for (auto _: state)
+		{
+			SumValues(1000, result).Start();
+		}
+		benchmark::DoNotOptimize(result);
+		state.SetItemsProcessed(state.iterations() * 1000);
+	}
+
+	Task<> WaitFrames(CoroutineScheduler& scheduler, const bool& stop)
+	{
+		while (!stop)
+		{
+			co_await scheduler.NextFrame();
+		}
+	}
+
+	// Arguments: coroutines waiting for the next frame, every one of them is resumed once per iteration
+	void BM_CoroutineNextFrame(benchmark::State& state)
+	{
+		WorkerPool workerPool(1);
+		TimerService timers;
+		CoroutineScheduler scheduler(workerPool, timers);
+
+		bool stop = false;
+		for (int64_t i = 0; i < state.range(0); i++)
+		{
+			WaitFrames(scheduler, stop).Start();
+		}
+
+		for (auto _: state)
+		{
+			scheduler.ResumePending();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+
+		// Lets every coroutine run to completion so the frames are freed
+		stop = true;
+		scheduler.ResumePending();
+	}
+
+	// Arguments: stack sample interval in bytes, zero only counts. Works without 'xSE_MEMORY_TRACKING' as the tracker's
+	// allocation functions are called directly.
+	void BM_MemoryTrackerAllocate(benchmark::State& state)
+	{
+		auto& tracker = MemoryTracker::GetInstance();
+		tracker.SetStackSampleInterval(static_cast<size_t>(state.range(0)));
+
+		for (auto _: state)
+		{
+			void* ptr = MemoryTracker::Allocate(64, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+			benchmark::DoNotOptimize(ptr);
+			MemoryTracker::Deallocate(ptr, false);
+		}
+		tracker.SetStackSampleInterval(0);
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	struct HitEvent final
+	{
+		uint32_t Attacker = 0;
+		uint32_t Target = 0;
+		float Damage = 0;
+	};
+	struct HitCounter final
+	{
+		double TotalDamage = 0;
+
+		void OnHit(const HitEvent& event) noexcept
+		{
+			TotalDamage += event.Damage;
+		}
+	};
+
+	// Arguments: subscriber count
+	void BM_EventBusPublish(benchmark::State& state)
+	{
+		EventBus events;
+		std::vector<HitCounter> counters(static_cast<size_t>(state.range(0)));
+		for (HitCounter& counter: counters)
+		{
+			events.Subscribe<&HitCounter::OnHit>(counter);
+		}
+
+		HitEvent event = {0x14, 0x7, 1.0f};
+		for (auto _: state)
+		{
+			events.Publish(event);
+		}
+		benchmark::DoNotOptimize(counters.front().TotalDamage);
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Arguments: events queued per frame
+	void BM_EventBusFlush(benchmark::State& state)
+	{
+		EventBus events;
+		HitCounter counter;
+		events.Subscribe<&HitCounter::OnHit>(counter);
+
+		for (auto _: state)
+		{
+			for (int64_t i = 0; i < state.range(0); i++)
+			{
+				events.Enqueue(HitEvent{0x14, static_cast<uint32_t>(i), 1.0f});
+			}
+			events.Flush();
+		}
+		benchmark::DoNotOptimize(counter.TotalDamage);
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Stands in for the game's form map
+	std::unordered_map<uint32_t, uint32_t> g_FormMap;
+	void* ResolveFromFormMap(uint32_t formID)
+	{
+		auto it = g_FormMap.find(formID);
+		return it != g_FormMap.end() ? &it->second : nullptr;
+	}
+
+	// Arguments: distinct forms looked up, with zero the cache is bypassed and every lookup goes to the map
+	void BM_FormCacheResolve(benchmark::State& state)
+	{
+		constexpr uint32_t formCount = 200000;
+		if (g_FormMap.empty())
+		{
+			for (uint32_t i = 1; i <= formCount; i++)
+			{
+				g_FormMap.emplace(FormID::MakeRegular(static_cast<uint8_t>(i % 200), i), i);
+			}
+		}
+
+		FormCache cache;
+		cache.SetResolver(ResolveFromFormMap);
+
+		const uint32_t workingSet = static_cast<uint32_t>(state.range(0));
+		uint32_t i = 0;
+		for (auto _: state)
+		{
+			const uint32_t n = workingSet != 0 ? i % workingSet + 1 : i % formCount + 1;
+			const uint32_t formID = FormID::MakeRegular(static_cast<uint8_t>(n % 200), n);
+			benchmark::DoNotOptimize(workingSet != 0 ? cache.Resolve(formID) : ResolveFromFormMap(formID));
+			i++;
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	// Full startup as seen by the script extender: query and load on a freshly initialized platform
+	void BM_QueryLoad(benchmark::State& state)
+	{
+		MockSEInterface seInterface;
+		PluginInfo pluginInfo;
+
+		for (auto _: state)
+		{
+			state.PauseTiming();
+			auto platform = std::make_unique<CommonExtenderPlatform>(g_PlatformType);
+			platform->Initialize(std::make_shared<BenchmarkPlugin>());
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(platform->OnQuery(&seInterface, &pluginInfo));
+			benchmark::DoNotOptimize(platform->OnLoad(&seInterface));
+
+			state.PauseTiming();
+			platform->Terminate();
+			platform = nullptr;
+			state.ResumeTiming();
+		}
+	}
+}
+
+BENCHMARK(BM_GetName);
+BENCHMARK(BM_GetGameName);
+BENCHMARK(BM_GetFullName);
+
+BENCHMARK_CAPTURE(BM_DirectoryAccessor, GameRoot, &CommonExtenderPlatform::GetGameRootDirectory);
+BENCHMARK_CAPTURE(BM_DirectoryAccessor, GameData, &CommonExtenderPlatform::GetGameDataDirectory);
+BENCHMARK_CAPTURE(BM_DirectoryAccessor, Platform, &CommonExtenderPlatform::GetPlatformDirectory);
+BENCHMARK_CAPTURE(BM_DirectoryAccessor, PlatformPlugins, &CommonExtenderPlatform::GetPlatformPluginsDirectory);
+BENCHMARK_CAPTURE(BM_DirectoryAccessor, PlatformLogs, &CommonExtenderPlatform::GetPlatformLogsDirectory);
+
+BENCHMARK(BM_LogString)->ArgNames({"category", "indent"})->ArgsProduct({{0, 1}, {0, 2}});
+BENCHMARK(BM_LogSymbol);
+BENCHMARK(BM_Log);
+BENCHMARK(BM_LogCategory);
+BENCHMARK(BM_LogPlatform);
+
+BENCHMARK(BM_UTF8Encode)->ArgNames({"length", "ascii"})->ArgsProduct({{64, 1024}, {0, 1}});
+BENCHMARK(BM_UTF8EncodeFramework)->Arg(64)->Arg(1024);
+
+BENCHMARK(BM_TimerScheduleCancel)->Arg(0)->Arg(10000);
+BENCHMARK(BM_TimerAdvance)->Arg(100)->Arg(10000);
+
+BENCHMARK(BM_TaskAwait);
+BENCHMARK(BM_CoroutineNextFrame)->Arg(100)->Arg(10000);
+
+BENCHMARK(BM_EventBusPublish)->Arg(1)->Arg(16);
+BENCHMARK(BM_EventBusFlush)->Arg(100)->Arg(10000);
+
+BENCHMARK(BM_MemoryTrackerAllocate)->Arg(0)->Arg(512 * 1024);
+
+BENCHMARK(BM_FormCacheResolve)->Arg(0)->Arg(1000)->Arg(10000);
+
+BENCHMARK(BM_QueryLoad)->Iterations(1000);
+
+int main(int argc, char** argv)
+{
+	// Defaults go first so anything passed on the command line overrides them
+	std::vector<char*> arguments = {argv[0]};
+	char outFile[] = "--benchmark_out=PluginCoreBenchmark.json";
+	char outFormat[] = "--benchmark_out_format=json";
+	char repetitions[] = "--benchmark_repetitions=5";
+	char aggregatesOnly[] = "--benchmark_report_aggregates_only=true";
+	arguments.insert(arguments.end(), {outFile, outFormat, repetitions, aggregatesOnly});
+	arguments.insert(arguments.end(), argv + 1, argv + argc);
+
+	int argumentCount = static_cast<int>(arguments.size());
+	benchmark::Initialize(&argumentCount, arguments.data());
+	if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data()))
+	{
+		return 1;
+	}
+
+	// Bring the shared platform into the same state as in a game so logging goes to both the log file and the SDK log
+	MockSEInterface seInterface;
+	PluginInfo pluginInfo;
+	auto& platform = GetSharedPlatform();
+	platform.Initialize(std::make_shared<BenchmarkPlugin>());
+	platform.OnQuery(&seInterface, &pluginInfo);
+	platform.OnLoad(&seInterface);
+
+	benchmark::AddCustomContext("xse_platform", xSE_NAME_A);
+	benchmark::AddCustomContext("xse_platform_type", platform.GetName().ToUTF8());
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	platform.Terminate();
+	return 0;
+}
@@ -0,0 +1,435 @@
+#include "pch.hpp"
+#include "PluginCore.h"
+#include "PluginCore/CommonExtenderPlatform.h"
+#include "PluginCore/InitializationEvent.h"
+#include "PluginCore/ScriptExtenderDefinesBase.h"
+#include "PluginCore/ScriptExtenderDefinesExtra.h"
+#include "PluginCore/ScriptExtenderInterfaceIncludes.h"
+
+#include <kxf/EventSystem/EvtHandler.h>
+#include <kxf/FileSystem/IFileSystem.h>
+#include <Windows.h>
+#include <Psapi.h>
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <format>
+#include <vector>
+
+// Acts like a script extender loader: creates or loads N plugins, queries all of them and then loads the ones which
+// accepted, the same two passes SKSE and F4SE make. Reports time spent in each phase and private memory for every plugin.
+//
+//	LoadOrderSimulator [--count <n>] [--plugins <directory>] [--load-work <us>] [--load-alloc <KB>] [--csv <file>] [--keep-logs] [--editor]
+//
+// By default the plugins are synthetic, each one is a separate platform instance in this process which is what every
+// plugin DLL has. With '--plugins' DLLs built for the mock platform are loaded from the directory instead.
+// '--editor' reports an editor session, synthetic plugins don't allow the editor so this measures the cost of rejection.
+//
+// Synthetic plugins share one binary, so they only approximate real startup cost. The framework modules are global to
+// the binary and initialized by the first platform that bootstraps ('InitializeModules'), the numbers of every later
+// plugin leave that cost out. The framework log is global too, its messages go to the log of whichever plugin has
+// bootstrapped last. Only '--plugins' mode, where every DLL has its own copy of the framework, measures the real cost.
+
+namespace
+{
+	using namespace xSE;
+	using Clock = std::chrono::steady_clock;
+	using TQueryFunction = bool(__cdecl*)(const xSE_Interface*, PluginInfo*);
+	using TLoadFunction = bool(__cdecl*)(const xSE_Interface*);
+
+	struct Options final
+	{
+		size_t PluginCount = 200;
+		std::filesystem::path PluginsDirectory;
+		std::filesystem::path CSVFile;
+		std::chrono::microseconds LoadWork = {};
+		size_t LoadAllocation = 0;
+		bool KeepLogs = false;
+		bool IsEditor = false;
+	};
+
+	struct PluginRecord final
+	{
+		std::string Name;
+		Clock::duration Create = {};
+		Clock::duration Query = {};
+		Clock::duration Load = {};
+		int64_t Memory = 0;
+		bool IsQueried = false;
+		bool IsLoaded = false;
+
+		Clock::duration GetTotal() const noexcept
+		{
+			return Create + Query + Load;
+		}
+	};
+
+	struct PluginSlot final
+	{
+		PluginRecord Record;
+
+		// Synthetic plugins
+		std::unique_ptr<CommonExtenderPlatform> Platform;
+		std::shared_ptr<kxf::IFileSystem> LogsDirectory;
+		kxf::String LogFileName;
+
+		// Plugin DLLs
+		HMODULE Module = nullptr;
+		TQueryFunction QueryFunction = nullptr;
+		TLoadFunction LoadFunction = nullptr;
+	};
+
+	class SyntheticPlugin final: public kxf::RTTI::Implementation<SyntheticPlugin, kxf::EvtHandler, IExtenderPlugin>
+	{
+		private:
+			kxf::String m_Name;
+			std::vector<uint8_t> m_Data;
+
+		public:
+			SyntheticPlugin(size_t index, const Options& options)
+				:m_Name(kxf::Format("SyntheticPlugin{:04}", index))
+			{
+				Bind(InitializationEvent::EvtQuery, [](InitializationEvent& event)
+				{
+				});
+				Bind(InitializationEvent::EvtLoad, [this, &options](InitializationEvent& event)
+				{
+					// Stand-in for whatever a real plugin does in its load handler
+					if (options.LoadAllocation != 0)
+					{
+						m_Data.resize(options.LoadAllocation, 0xCD);
+					}
+					for (auto start = Clock::now(); Clock::now() - start < options.LoadWork;)
+					{
+					}
+				});
+			}
+
+		public:
+			// IExtenderPlugin
+			kxf::String GetName() const override
+			{
+				return m_Name;
+			}
+			kxf::String GetAuthor() const override
+			{
+				return "xSE PluginDev";
+			}
+			kxf::Version GetVersion() const override
+			{
+				return kxf::Version("1.0");
+			}
+			kxf::FlagSet<ExtenderPluginFlag> GetFlags() const override
+			{
+				return ExtenderPluginFlag::None;
+			}
+	};
+
+	PluginHandle g_CurrentPluginHandle = 0;
+	PluginHandle GetCurrentPluginHandle()
+	{
+		return g_CurrentPluginHandle;
+	}
+
+	int64_t GetPrivateBytes() noexcept
+	{
+		PROCESS_MEMORY_COUNTERS_EX counters = {};
+		counters.cb = sizeof(counters);
+		if (::GetProcessMemoryInfo(::GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+		{
+			return static_cast<int64_t>(counters.PrivateUsage);
+		}
+		return 0;
+	}
+	double ToMicroseconds(Clock::duration value) noexcept
+	{
+		return std::chrono::duration<double, std::micro>(value).count();
+	}
+	double ToMilliseconds(Clock::duration value) noexcept
+	{
+		return std::chrono::duration<double, std::milli>(value).count();
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		auto ParseNumber = [](std::string_view value, size_t& result)
+		{
+			auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+			return ec == std::errc() && ptr == value.data() + value.size();
+		};
+
+		for (int i = 1; i < argc; i++)
+		{
+			std::string_view name = argv[i];
+			std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+
+			size_t number = 0;
+			if (name == "--keep-logs")
+			{
+				options.KeepLogs = true;
+				continue;
+			}
+			else if (name == "--editor")
+			{
+				options.IsEditor = true;
+				continue;
+			}
+			else if (name == "--count" && ParseNumber(value, number))
+			{
+				options.PluginCount = number;
+			}
+			else if (name == "--load-work" && ParseNumber(value, number))
+			{
+				options.LoadWork = std::chrono::microseconds(number);
+			}
+			else if (name == "--load-alloc" && ParseNumber(value, number))
+			{
+				options.LoadAllocation = number * 1024;
+			}
+			else if (name == "--plugins" && !value.empty())
+			{
+				options.PluginsDirectory = value;
+			}
+			else if (name == "--csv" && !value.empty())
+			{
+				options.CSVFile = value;
+			}
+			else
+			{
+				std::fputs(std::format("Invalid argument: {}\n", name).c_str(), stderr);
+				return false;
+			}
+			i++;
+		}
+		return true;
+	}
+
+	std::vector<PluginSlot> CreateSlots(const Options& options)
+	{
+		std::vector<PluginSlot> slots;
+		if (!options.PluginsDirectory.empty())
+		{
+			for (const auto& entry: std::filesystem::directory_iterator(options.PluginsDirectory))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".dll")
+				{
+					auto& slot = slots.emplace_back();
+					slot.Record.Name = entry.path().filename().string();
+				}
+			}
+		}
+		else
+		{
+			slots.resize(options.PluginCount);
+		}
+		return slots;
+	}
+	bool CreatePlugin(PluginSlot& slot, size_t index, const Options& options)
+	{
+		if (!options.PluginsDirectory.empty())
+		{
+			slot.Module = ::LoadLibraryW((options.PluginsDirectory / slot.Record.Name).c_str());
+			if (slot.Module)
+			{
+				slot.QueryFunction = reinterpret_cast<TQueryFunction>(::GetProcAddress(slot.Module, _CRT_STRINGIZE(xSE_QUERYFUNCTION)));
+				slot.LoadFunction = reinterpret_cast<TLoadFunction>(::GetProcAddress(slot.Module, _CRT_STRINGIZE(xSE_LOADFUNCTION)));
+			}
+			return slot.QueryFunction && slot.LoadFunction;
+		}
+		else
+		{
+			auto plugin = std::make_shared<SyntheticPlugin>(index, options);
+			slot.Record.Name = plugin->GetName().ToUTF8();
+			slot.LogFileName = plugin->GetName() + ".log";
+
+			slot.Platform = std::make_unique<CommonExtenderPlatform>(PlatformType::SKSE64);
+			slot.LogsDirectory = slot.Platform->GetPlatformLogsDirectory();
+			return slot.Platform->Initialize(std::move(plugin));
+		}
+	}
+
+	void PrintStatistics(std::string_view name, std::vector<double> values)
+	{
+		if (values.empty())
+		{
+			return;
+		}
+		std::ranges::sort(values);
+
+		auto GetPercentile = [&](double percentile)
+		{
+			return values[std::min(values.size() - 1, static_cast<size_t>(values.size() * percentile / 100.0))];
+		};
+
+		double sum = 0;
+		for (double value: values)
+		{
+			sum += value;
+		}
+		std::fputs(std::format("  {:<8}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}\n", name, sum / values.size(), GetPercentile(50), GetPercentile(90), GetPercentile(99), values.back()).c_str(), stdout);
+	}
+	void PrintReport(const std::vector<PluginSlot>& slots, Clock::duration totalTime, int64_t totalMemory)
+	{
+		std::vector<double> create;
+		std::vector<double> query;
+		std::vector<double> load;
+		std::vector<double> total;
+		size_t queried = 0;
+		size_t loaded = 0;
+		Clock::duration createTime = {};
+		Clock::duration queryTime = {};
+		Clock::duration loadTime = {};
+
+		for (const auto& slot: slots)
+		{
+			const auto& record = slot.Record;
+			create.push_back(ToMicroseconds(record.Create));
+			query.push_back(ToMicroseconds(record.Query));
+			if (record.IsQueried)
+			{
+				load.push_back(ToMicroseconds(record.Load));
+			}
+			total.push_back(ToMicroseconds(record.GetTotal()));
+
+			queried += record.IsQueried ? 1 : 0;
+			loaded += record.IsLoaded ? 1 : 0;
+			createTime += record.Create;
+			queryTime += record.Query;
+			loadTime += record.Load;
+		}
+
+		std::fputs(std::format("Plugins: {} (queried: {}, loaded: {})\n", slots.size(), queried, loaded).c_str(), stdout);
+		std::fputs(std::format("Total time: {:.2f} ms (create: {:.2f} ms, query: {:.2f} ms, load: {:.2f} ms)\n",
+							   ToMilliseconds(totalTime),
+							   ToMilliseconds(createTime),
+							   ToMilliseconds(queryTime),
+							   ToMilliseconds(loadTime)).c_str(), stdout
+		);
+		std::fputs(std::format("Private memory: {:.2f} MB ({:.1f} KB per plugin)\n",
+							   totalMemory / (1024.0 * 1024.0),
+							   !slots.empty() ? totalMemory / 1024.0 / slots.size() : 0.0).c_str(), stdout
+		);
+
+		std::fputs(std::format("\nPer plugin, us\n  {:<8}{:>12}{:>12}{:>12}{:>12}{:>12}\n", "", "mean", "p50", "p90", "p99", "max").c_str(), stdout);
+		PrintStatistics("create", std::move(create));
+		PrintStatistics("query", std::move(query));
+		PrintStatistics("load", std::move(load));
+		PrintStatistics("total", std::move(total));
+
+		std::vector<const PluginRecord*> slowest;
+		for (const auto& slot: slots)
+		{
+			slowest.push_back(&slot.Record);
+		}
+		std::ranges::sort(slowest, std::ranges::greater(), &PluginRecord::GetTotal);
+		slowest.resize(std::min<size_t>(slowest.size(), 10));
+
+		std::fputs("\nSlowest plugins\n", stdout);
+		for (const PluginRecord* record: slowest)
+		{
+			std::fputs(std::format("  {:<40}{:>12.1f} us{:>12.1f} KB\n", record->Name, ToMicroseconds(record->GetTotal()), record->Memory / 1024.0).c_str(), stdout);
+		}
+	}
+	void WriteCSV(const std::vector<PluginSlot>& slots, const std::filesystem::path& path)
+	{
+		std::ofstream stream(path, std::ios::out|std::ios::trunc);
+		stream << "name,create_us,query_us,load_us,total_us,memory_bytes,queried,loaded\n";
+		for (const auto& slot: slots)
+		{
+			const auto& record = slot.Record;
+			stream << std::format("{},{:.3f},{:.3f},{:.3f},{:.3f},{},{},{}\n",
+								  record.Name,
+								  ToMicroseconds(record.Create),
+								  ToMicroseconds(record.Query),
+								  ToMicroseconds(record.Load),
+								  ToMicroseconds(record.GetTotal()),
+								  record.Memory,
+								  record.IsQueried ? 1 : 0,
+								  record.IsLoaded ? 1 : 0
+			);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	MockSEInterface seInterface;
+	seInterface.GetPluginHandle = GetCurrentPluginHandle;
+	seInterface.isEditor = options.IsEditor ? 1 : 0;
+
+	std::vector<PluginSlot> slots = CreateSlots(options);
+	const int64_t initialMemory = GetPrivateBytes();
+	const auto startTime = Clock::now();
+
+	// First pass: load every plugin and ask whether it wants to be loaded
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		PluginSlot& slot = slots[i];
+		PluginRecord& record = slot.Record;
+
+		const int64_t memory = GetPrivateBytes();
+		const auto createStart = Clock::now();
+		const bool isCreated = CreatePlugin(slot, i, options);
+		record.Create = Clock::now() - createStart;
+
+		if (isCreated)
+		{
+			PluginInfo pluginInfo;
+			g_CurrentPluginHandle = static_cast<PluginHandle>(i + 1);
+
+			const auto queryStart = Clock::now();
+			record.IsQueried = slot.Platform ? slot.Platform->OnQuery(&seInterface, &pluginInfo) : slot.QueryFunction(&seInterface, &pluginInfo);
+			record.Query = Clock::now() - queryStart;
+		}
+		record.Memory = GetPrivateBytes() - memory;
+	}
+
+	// Second pass: load everything that accepted the query
+	for (PluginSlot& slot: slots)
+	{
+		PluginRecord& record = slot.Record;
+		if (record.IsQueried)
+		{
+			const int64_t memory = GetPrivateBytes();
+			const auto loadStart = Clock::now();
+			record.IsLoaded = slot.Platform ? slot.Platform->OnLoad(&seInterface) : slot.LoadFunction(&seInterface);
+			record.Load = Clock::now() - loadStart;
+			record.Memory += GetPrivateBytes() - memory;
+		}
+	}
+
+	const auto totalTime = Clock::now() - startTime;
+	PrintReport(slots, totalTime, GetPrivateBytes() - initialMemory);
+	if (options.PluginsDirectory.empty())
+	{
+		std::fputs("\nSynthetic plugins share the framework, its initialization is only counted for the first one. Use '--plugins' to measure real startup cost.\n", stdout);
+	}
+	if (!options.CSVFile.empty())
+	{
+		WriteCSV(slots, options.CSVFile);
+	}
+
+	for (PluginSlot& slot: slots)
+	{
+		if (slot.Platform)
+		{
+			slot.Platform->Terminate();
+			slot.Platform = nullptr;
+
+			if (slot.LogsDirectory && !options.KeepLogs)
+			{
+				slot.LogsDirectory->RemoveItem(slot.LogFileName);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,314 @@
+#include "TelemetryProtocol.h"
+#include <Windows.h>
+
+#include <chrono>
+#include <thread>
+#include <string>
+#include <format>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+// Reference consumer for the PluginCore telemetry channel. Attaches to the channel of the given plugin, waiting for
+// it to appear if needed, and prints every record as it arrives. Reattaches when the game is restarted.
+//
+//	TelemetryConsumer <plugin name> [--no-logs] [--no-metrics] [--no-events]
+
+namespace
+{
+	using namespace xSE::Telemetry;
+
+	struct Options final
+	{
+		std::wstring PluginName;
+		bool ShowLogs = true;
+		bool ShowMetrics = true;
+		bool ShowEvents = true;
+	};
+
+	volatile bool g_Stop = false;
+
+	class ChannelView final
+	{
+		private:
+			HANDLE m_MappingHandle = nullptr;
+			TelemetryChannelHeader* m_Header = nullptr;
+			const std::byte* m_Ring = nullptr;
+			uint64_t m_SessionID = 0;
+
+		public:
+			ChannelView() noexcept = default;
+			ChannelView(const ChannelView&) = delete;
+			~ChannelView()
+			{
+				Close();
+			}
+
+		public:
+			bool Open(const std::wstring& pluginName)
+			{
+				Close();
+
+				const std::wstring mappingName = MappingPrefix + pluginName;
+				m_MappingHandle = ::OpenFileMappingW(FILE_MAP_READ|FILE_MAP_WRITE, FALSE, mappingName.c_str());
+				if (!m_MappingHandle)
+				{
+					return false;
+				}
+
+				// The whole section is mapped, its size is only known from the header but mapping zero bytes maps everything
+				void* view = ::MapViewOfFile(m_MappingHandle, FILE_MAP_READ|FILE_MAP_WRITE, 0, 0, 0);
+				if (!view)
+				{
+					Close();
+					return false;
+				}
+
+				m_Header = static_cast<TelemetryChannelHeader*>(view);
+				if (m_Header->Magic.load(std::memory_order_acquire) != Magic || m_Header->Version != Version)
+				{
+					Close();
+					return false;
+				}
+
+				m_Ring = static_cast<const std::byte*>(view) + m_Header->HeaderSize;
+				m_SessionID = m_Header->SessionID;
+				return true;
+			}
+			void Close() noexcept
+			{
+				if (m_Header)
+				{
+					::UnmapViewOfFile(m_Header);
+					m_Header = nullptr;
+					m_Ring = nullptr;
+				}
+				if (m_MappingHandle)
+				{
+					::CloseHandle(m_MappingHandle);
+					m_MappingHandle = nullptr;
+				}
+			}
+			bool IsOpen() const noexcept
+			{
+				return m_Header != nullptr;
+			}
+			bool IsSessionChanged() const noexcept
+			{
+				return m_Header->Magic.load(std::memory_order_acquire) != Magic || m_Header->SessionID != m_SessionID;
+			}
+
+			const TelemetryChannelHeader& GetHeader() const noexcept
+			{
+				return *m_Header;
+			}
+
+			// Calls 'func' for every record published since the last call and then releases their space to the producer
+			template<class TFunc>
+			size_t Consume(TFunc&& func)
+			{
+				const uint64_t writePosition = m_Header->WritePosition.load(std::memory_order_acquire);
+				uint64_t readPosition = m_Header->ReadPosition.load(std::memory_order_relaxed);
+
+				size_t count = 0;
+				while (readPosition < writePosition)
+				{
+					TelemetryRecordHeader header = {};
+					const std::byte* record = m_Ring + (readPosition & (m_Header->Capacity - 1));
+					std::memcpy(&header, record, sizeof(header));
+					if (header.Size < sizeof(header) || header.Size > m_Header->Capacity)
+					{
+						// Corrupted or a producer restarted under us, drop everything
+						readPosition = writePosition;
+						break;
+					}
+
+					if (header.Type != RecordType::Padding)
+					{
+						func(header, record + sizeof(header));
+						count++;
+					}
+					readPosition += header.Size;
+				}
+
+				// A producer that restarted while we were reading has reset the positions, ours belongs to the old session
+				if (!IsSessionChanged())
+				{
+					m_Header->ReadPosition.store(readPosition, std::memory_order_release);
+				}
+				return count;
+			}
+
+		public:
+			ChannelView& operator=(const ChannelView&) = delete;
+	};
+
+	std::string FormatTimestamp(uint64_t timestamp)
+	{
+		using namespace std::chrono;
+
+		const auto time = system_clock::time_point(microseconds(timestamp));
+		return std::format("{:%H:%M:%S}", floor<milliseconds>(time));
+	}
+	void PrintRecord(const Options& options, const TelemetryRecordHeader& header, const std::byte* payload)
+	{
+		switch (header.Type)
+		{
+			case RecordType::Log:
+			{
+				if (options.ShowLogs)
+				{
+					TelemetryLogRecord record = {};
+					std::memcpy(&record, payload, sizeof(record));
+
+					const char* text = reinterpret_cast<const char*>(payload + sizeof(record));
+					const std::string_view category(text, record.CategoryLength);
+					const std::string_view message(text + record.CategoryLength, record.MessageLength);
+
+					std::fputs(std::format("{} [{:>5}] {:{}}{}{}\n",
+										   FormatTimestamp(header.Timestamp),
+										   record.ThreadID,
+										   "",
+										   record.Indent * 4,
+										   category.empty() ? std::string() : std::format("<{}> ", category),
+										   message).c_str(), stdout);
+				}
+				break;
+			}
+			case RecordType::Metric:
+			{
+				if (options.ShowMetrics)
+				{
+					TelemetryMetricRecord record = {};
+					std::memcpy(&record, payload, sizeof(record));
+
+					const std::string_view name(reinterpret_cast<const char*>(payload + sizeof(record)), record.NameLength);
+					if (record.Kind == MetricKind::Histogram)
+					{
+						std::fputs(std::format("{} metric {}: count={} p50={}ns p90={}ns p99={}ns max={}ns\n",
+											   FormatTimestamp(header.Timestamp),
+											   name,
+											   record.Count,
+											   record.P50,
+											   record.P90,
+											   record.P99,
+											   record.Max).c_str(), stdout);
+					}
+					else
+					{
+						std::fputs(std::format("{} metric {}: {}\n", FormatTimestamp(header.Timestamp), name, record.Value).c_str(), stdout);
+					}
+				}
+				break;
+			}
+			case RecordType::Event:
+			{
+				if (options.ShowEvents)
+				{
+					TelemetryEventRecord record = {};
+					std::memcpy(&record, payload, sizeof(record));
+
+					const std::string_view name(reinterpret_cast<const char*>(payload + sizeof(record)), record.NameLength);
+					std::fputs(std::format("{} event {} ({} bytes)\n", FormatTimestamp(header.Timestamp), name, record.DataSize).c_str(), stdout);
+				}
+				break;
+			}
+		};
+	}
+
+	bool ParseOptions(int argc, wchar_t** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::wstring_view argument = argv[i];
+			if (argument == L"--no-logs")
+			{
+				options.ShowLogs = false;
+			}
+			else if (argument == L"--no-metrics")
+			{
+				options.ShowMetrics = false;
+			}
+			else if (argument == L"--no-events")
+			{
+				options.ShowEvents = false;
+			}
+			else if (options.PluginName.empty() && !argument.starts_with(L"--"))
+			{
+				options.PluginName = argument;
+			}
+			else
+			{
+				std::fwprintf(stderr, L"Invalid argument: %s\n", argv[i]);
+				return false;
+			}
+		}
+
+		if (options.PluginName.empty())
+		{
+			std::fputs("Usage: TelemetryConsumer <plugin name> [--no-logs] [--no-metrics] [--no-events]\n", stderr);
+			return false;
+		}
+		return true;
+	}
+}
+
+int wmain(int argc, wchar_t** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	::SetConsoleCtrlHandler([](DWORD) -> BOOL
+	{
+		g_Stop = true;
+		return TRUE;
+	}, TRUE);
+
+	ChannelView channel;
+	uint64_t lastDropped = 0;
+	bool isWaitingReported = false;
+
+	while (!g_Stop)
+	{
+		if (!channel.IsOpen() || channel.IsSessionChanged())
+		{
+			if (!channel.Open(options.PluginName))
+			{
+				if (!isWaitingReported)
+				{
+					std::fwprintf(stderr, L"Waiting for '%s%s'...\n", MappingPrefix, options.PluginName.c_str());
+					isWaitingReported = true;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(500));
+				continue;
+			}
+
+			const auto& header = channel.GetHeader();
+			std::fprintf(stderr, "Attached to process %u, %u KB ring\n", header.ProcessID, header.Capacity / 1024);
+			isWaitingReported = false;
+			lastDropped = 0;
+		}
+
+		const size_t count = channel.Consume([&](const TelemetryRecordHeader& header, const std::byte* payload)
+		{
+			PrintRecord(options, header, payload);
+		});
+
+		if (const uint64_t dropped = channel.GetHeader().DroppedRecords.load(std::memory_order_relaxed); dropped != lastDropped)
+		{
+			std::fprintf(stderr, "Producer dropped %llu records\n", static_cast<unsigned long long>(dropped - lastDropped));
+			lastDropped = dropped;
+		}
+
+		// Stay responsive under load, back off when idle
+		if (count == 0)
+		{
+			std::fflush(stdout);
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+#include "pch.hpp"
+#include "Tests.hpp"
+#include "PluginCore/MockScaleformBackend.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+	using namespace xSE;
+	using CallType = MockScaleformBackend::CallType;
+
+	struct InventoryItem final
+	{
+		std::string Name;
+		int Count = 0;
+		bool IsEquipped = false;
+	};
+
+	constexpr auto g_ItemDescriptor = ScaleformDescribe
+	(
+		ScaleformField("name", &InventoryItem::Name),
+		ScaleformField("count", &InventoryItem::Count),
+		ScaleformField("equipped", &InventoryItem::IsEquipped)
+	);
+	using TItemObject = ScaleformObjectBinding<InventoryItem, decltype(g_ItemDescriptor)>;
+	using TItemArray = ScaleformArrayBinding<InventoryItem, decltype(g_ItemDescriptor)>;
+}
+
+xSE_TEST(ObjectBindingPushesOnlyChangedFields)
+{
+	MockScaleformBackend backend;
+	TItemObject binding(backend, g_ItemDescriptor);
+
+	InventoryItem item = {"Iron Sword", 1, false};
+	auto stats = binding.Update(item);
+	xSE_CHECK(stats.ObjectsCreated == 1);
+	xSE_CHECK(stats.FieldsPushed == 3);
+	xSE_CHECK(backend.CountCalls(CallType::SetMember) == 3);
+
+	backend.ClearCalls();
+	stats = binding.Update(item);
+	xSE_CHECK(stats.FieldsPushed == 0);
+	xSE_CHECK(stats.FieldsSkipped == 3);
+	xSE_CHECK(backend.GetCalls().empty());
+
+	item.Count = 2;
+	stats = binding.Update(item);
+	xSE_CHECK(stats.FieldsPushed == 1);
+	xSE_CHECK(backend.GetCalls().size() == 1);
+	xSE_CHECK(backend.GetCalls()[0].Type == CallType::SetMember);
+	xSE_CHECK(backend.GetCalls()[0].Name == "count");
+
+	// Invalidation pushes everything again, as after the movie was reloaded
+	backend.ClearCalls();
+	binding.Invalidate();
+	stats = binding.Update(item);
+	xSE_CHECK(stats.FieldsPushed == 3);
+	xSE_CHECK(backend.CountCalls(CallType::CreateObject) == 0);
+}
+
+xSE_TEST(ObjectBindingMoveReleasesOwnedObject)
+{
+	MockScaleformBackend backend;
+	{
+		TItemObject first(backend, g_ItemDescriptor);
+		TItemObject second(backend, g_ItemDescriptor);
+		first.Update({"Apple", 1, false});
+		second.Update({"Bread", 2, false});
+		xSE_CHECK(backend.GetLiveCount() == 2);
+
+		const auto firstHandle = first.GetHandle();
+		const auto secondHandle = second.GetHandle();
+		first = std::move(second);
+		xSE_CHECK(first.GetHandle() == secondHandle);
+		xSE_CHECK(second.GetHandle() == IScaleformBackend::InvalidHandle);
+		xSE_CHECK(!backend.IsLive(firstHandle));
+		xSE_CHECK(backend.GetLiveCount() == 1);
+
+		TItemObject third(std::move(first));
+		xSE_CHECK(third.GetHandle() == secondHandle);
+		xSE_CHECK(backend.GetLiveCount() == 1);
+	}
+	xSE_CHECK(backend.GetLiveCount() == 0);
+}
+
+xSE_TEST(ArrayBindingSkipsUnchangedList)
+{
+	MockScaleformBackend backend;
+	TItemArray binding(backend, g_ItemDescriptor);
+
+	std::vector<InventoryItem> items = {{"Apple", 3, false}, {"Bread", 1, false}, {"Iron Sword", 1, true}};
+	auto stats = binding.Update(items);
+	xSE_CHECK(backend.CountCalls(CallType::CreateArray) == 1);
+	xSE_CHECK(stats.ObjectsCreated == 3);
+	xSE_CHECK(stats.ElementsAssigned == 3);
+	xSE_CHECK(backend.CountCalls(CallType::SetArraySize) == 1);
+
+	backend.ClearCalls();
+	stats = binding.Update(items);
+	xSE_CHECK(backend.GetCalls().empty());
+	xSE_CHECK(stats.FieldsSkipped == 9);
+
+	items[1].Count = 5;
+	stats = binding.Update(items);
+	xSE_CHECK(backend.GetCalls().size() == 1);
+	xSE_CHECK(stats.FieldsPushed == 1);
+	xSE_CHECK(stats.ElementsAssigned == 0);
+}
+
+xSE_TEST(ArrayBindingReusesElementsAfterShrinking)
+{
+	MockScaleformBackend backend;
+	TItemArray binding(backend, g_ItemDescriptor);
+
+	std::vector<InventoryItem> items = {{"Apple", 3, false}, {"Bread", 1, false}, {"Iron Sword", 1, true}};
+	binding.Update(items);
+	std::vector<IScaleformBackend::Handle> elementHandles;
+	for (const auto& call: backend.GetCalls())
+	{
+		if (call.Type == CallType::SetElement)
+		{
+			elementHandles.push_back(call.ValueHandle);
+		}
+	}
+	xSE_CHECK(elementHandles.size() == 3);
+
+	// Shrinking only resizes the array and keeps the element objects alive
+	backend.ClearCalls();
+	auto stats = binding.Update(std::span(items).first(1));
+	xSE_CHECK(backend.GetCalls().size() == 1);
+	xSE_CHECK(backend.GetCalls()[0].Type == CallType::SetArraySize);
+	xSE_CHECK(backend.GetCalls()[0].Index == 1);
+	xSE_CHECK(backend.CountCalls(CallType::ReleaseValue) == 0);
+
+	// Growing back reassigns the cached objects without recreating or repopulating them
+	backend.ClearCalls();
+	stats = binding.Update(items);
+	xSE_CHECK(stats.ObjectsCreated == 0);
+	xSE_CHECK(stats.FieldsPushed == 0);
+	xSE_CHECK(stats.ElementsAssigned == 2);
+	xSE_CHECK(backend.CountCalls(CallType::SetMember) == 0);
+
+	size_t elementIndex = 1;
+	for (const auto& call: backend.GetCalls())
+	{
+		if (call.Type == CallType::SetElement)
+		{
+			xSE_CHECK(call.Index == elementIndex);
+			xSE_CHECK(call.ValueHandle == elementHandles[elementIndex]);
+			elementIndex++;
+		}
+		else if (call.Type == CallType::SetArraySize)
+		{
+			xSE_CHECK(call.Index == 3);
+		}
+	}
+	xSE_CHECK(elementIndex == 3);
+
+	// Growing past the cached elements creates new ones
+	items.push_back({"Torch", 1, false});
+	backend.ClearCalls();
+	stats = binding.Update(items);
+	xSE_CHECK(stats.ObjectsCreated == 1);
+	xSE_CHECK(stats.ElementsAssigned == 1);
+	xSE_CHECK(stats.FieldsPushed == 3);
+}
+
+xSE_TEST(ArrayBindingReleasesEverything)
+{
+	MockScaleformBackend backend;
+	{
+		TItemArray binding(backend, g_ItemDescriptor);
+
+		std::vector<InventoryItem> items = {{"Apple", 3, false}, {"Bread", 1, false}};
+		binding.Update(items);
+		xSE_CHECK(backend.GetLiveCount() == 3);
+	}
+	xSE_CHECK(backend.GetLiveCount() == 0);
+}
@@ -0,0 +1,53 @@
+#include "Tests.hpp"
+#include <cstdio>
+#include <string_view>
+
+namespace
+{
+	size_t g_FailureCount = 0;
+}
+
+namespace xSE::Tests
+{
+	std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> g_TestCases;
+		return g_TestCases;
+	}
+	void ReportFailure(const char* file, int line, const char* expression)
+	{
+		std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+		g_FailureCount++;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace xSE::Tests;
+
+	size_t failedTests = 0;
+	size_t testCount = 0;
+	for (const TestCase& test: GetTestCases())
+	{
+		bool isSelected = argc <= 1;
+		for (int i = 1; i < argc && !isSelected; i++)
+		{
+			isSelected = std::string_view(argv[i]) == test.Name;
+		}
+		if (!isSelected)
+		{
+			continue;
+		}
+
+		const size_t failuresBefore = g_FailureCount;
+		test.Function();
+		testCount++;
+
+		const bool isPassed = g_FailureCount == failuresBefore;
+		failedTests += isPassed ? 0 : 1;
+		std::printf("[%s] %s\n", isPassed ? "PASS" : "FAIL", test.Name);
+	}
+
+	std::printf("%zu of %zu tests passed\n", testCount - failedTests, testCount);
+	return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+
+// Just enough of a test harness for PluginCore's host-testable parts. Tests register themselves with 'xSE_TEST' and
+// report failed checks with 'xSE_CHECK', the runner executes all of them (or the ones named on the command line).
+
+namespace xSE::Tests
+{
+	using TTestFunction = void(*)();
+
+	struct TestCase final
+	{
+		const char* Name = nullptr;
+		TTestFunction Function = nullptr;
+	};
+
+	std::vector<TestCase>& GetTestCases();
+	void ReportFailure(const char* file, int line, const char* expression);
+
+	struct TestRegistration final
+	{
+		TestRegistration(const char* name, TTestFunction function)
+		{
+			GetTestCases().push_back({name, function});
+		}
+	};
+}
+
+#define xSE_TEST(name)	\
+	static void name();	\
+	static const ::xSE::Tests::TestRegistration name##_Registration(#name, &name);	\
+	static void name()
+
+#define xSE_CHECK(expression)	((expression) ? static_cast<void>(0) : ::xSE::Tests::ReportFailure(__FILE__, __LINE__, #expression))
@@ -0,0 +1,120 @@
+#include "pch.hpp"
+#include "Tests.hpp"
+#include "PluginCore/UTF8.h"
+#include <string>
+#include <string_view>
+
+namespace
+{
+	using namespace xSE;
+	using UTF8::EncodePath;
+
+	std::string EncodeUsing(EncodePath path, std::u16string_view source, bool& isAvailable)
+	{
+		std::string result(UTF8::GetMaxEncodedLength(source.size()), '\0');
+
+		size_t written = 0;
+		isAvailable = UTF8::EncodeUsing(path, source, result.data(), written);
+		result.resize(written);
+		return result;
+	}
+
+	// Compares the vectorized paths with the scalar one, the paths the CPU doesn't support are skipped
+	bool MatchesScalar(std::u16string_view source)
+	{
+		bool isAvailable = false;
+		const std::string expected = EncodeUsing(EncodePath::Scalar, source, isAvailable);
+		for (EncodePath path: {EncodePath::SSE2, EncodePath::AVX2})
+		{
+			const std::string actual = EncodeUsing(path, source, isAvailable);
+			if (isAvailable && actual != expected)
+			{
+				return false;
+			}
+		}
+
+		std::string appended = "Prefix";
+		UTF8::Append(appended, source);
+		return appended == "Prefix" + expected;
+	}
+
+	std::u16string MakeASCII(size_t length)
+	{
+		std::u16string result;
+		for (size_t i = 0; i < length; i++)
+		{
+			result += static_cast<char16_t>(u'a' + i % 26);
+		}
+		return result;
+	}
+}
+
+xSE_TEST(UTF8ScalarEncoding)
+{
+	bool isAvailable = false;
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, u"Abc", isAvailable) == "Abc");
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, u"\u00E9\u0416", isAvailable) == "\xC3\xA9\xD0\x96");
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, u"\u20AC", isAvailable) == "\xE2\x82\xAC");
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, u"\U0001F600", isAvailable) == "\xF0\x9F\x98\x80");
+
+	// Lone surrogates, a low one on its own or a high one not followed by a low one
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, std::u16string{0xDC00}, isAvailable) == "\xEF\xBF\xBD");
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, std::u16string{0xD800, u'a'}, isAvailable) == "\xEF\xBF\xBD" "a");
+	xSE_CHECK(EncodeUsing(EncodePath::Scalar, std::u16string{0xD800, 0xD800, 0xDC00}, isAvailable) == "\xEF\xBF\xBD\xF0\x90\x80\x80");
+	xSE_CHECK(isAvailable);
+}
+
+xSE_TEST(UTF8VectorizedMatchesScalarASCII)
+{
+	// Every length around the 8 (SSE2) and 16 (AVX2) character blocks, that is the 16 and 32 byte loads
+	for (size_t length = 0; length <= 70; length++)
+	{
+		xSE_CHECK(MatchesScalar(MakeASCII(length)));
+	}
+}
+
+xSE_TEST(UTF8VectorizedMatchesScalarMixed)
+{
+	constexpr char16_t nonASCII[] = {0x80, 0xFF, 0x100, 0x7FF, 0x800, 0xFFFD, 0xFFFF};
+
+	// A single non-ASCII character at every position ends the vector block early
+	for (size_t length: {7, 8, 9, 15, 16, 17, 31, 32, 33, 48})
+	{
+		for (size_t position = 0; position < length; position++)
+		{
+			for (char16_t c: nonASCII)
+			{
+				std::u16string text = MakeASCII(length);
+				text[position] = c;
+				xSE_CHECK(MatchesScalar(text));
+			}
+		}
+	}
+}
+
+xSE_TEST(UTF8VectorizedMatchesScalarSurrogates)
+{
+	for (size_t length: {8, 9, 16, 17, 32, 33})
+	{
+		for (size_t position = 0; position < length; position++)
+		{
+			// A pair which may straddle a block boundary
+			std::u16string text = MakeASCII(length);
+			text.insert(position, std::u16string{0xD83D, 0xDE00});
+			xSE_CHECK(MatchesScalar(text));
+
+			// Lone high and low surrogates, including one at the very end
+			text = MakeASCII(length);
+			text[position] = 0xD83D;
+			xSE_CHECK(MatchesScalar(text));
+
+			text[position] = 0xDE00;
+			xSE_CHECK(MatchesScalar(text));
+
+			// Swapped pair
+			text = MakeASCII(length);
+			text.insert(position, std::u16string{0xDE00, 0xD83D});
+			xSE_CHECK(MatchesScalar(text));
+		}
+	}
+}
@@ -47,6 +47,11 @@ namespace
 
 	xSE::CommonExtenderPlatform g_Platform = xSE::PlatformType::F4SEVR;
 
+	#elif xSE_PLATFORM_MOCK
+
+	// Host-side tools pretend to be SKSE64 so the name and directory accessors have something to return
+	xSE::CommonExtenderPlatform g_Platform = xSE::PlatformType::SKSE64;
+
 	#endif
 }
 
@@ -1,9 +1,36 @@
 #pragma once
 #include "Framework.hpp"
+#include "SymbolTable.h"
+#include "Profiler.h"
+#include <chrono>
+#include <memory_resource>
+#include <span>
+
+class GFxMovieView;
 
 namespace kxf
 {
 	class IFileSystem;
+	class FSPath;
+}
+
+namespace xSE
+{
+	class ArchiveFileSystem;
+	class ConfigFile;
+	class CoroutineScheduler;
+	class DataFileSystem;
+	class EventBus;
+	class FormCache;
+	class LocalizationService;
+	class ConsoleCommandDispatcher;
+	class IScaleformBackend;
+	class MetricsRegistry;
+	class PluginFile;
+	struct PluginFileVisitor;
+	class TelemetryChannel;
+	class TimerService;
+	class WorkerPool;
 }
 
 namespace xSE
@@ -56,6 +83,7 @@ namespace xSE
 		public:
 			virtual PlatformType GetType() const = 0;
 			virtual kxf::String GetName() const = 0;
+			virtual Symbol GetNameSymbol() const = 0;
 			virtual kxf::String GetGameName() const = 0;
 			virtual kxf::String GetFullName() const = 0;
 			virtual kxf::Version GetVersion() const = 0;
@@ -66,22 +94,53 @@ namespace xSE
 			virtual std::shared_ptr<kxf::IFileSystem> GetPlatformPluginsDirectory() const = 0;
 			virtual std::shared_ptr<kxf::IFileSystem> GetPlatformLogsDirectory() const = 0;
 
+			virtual const ConfigFile& GetConfig() const = 0;
+
+			virtual WorkerPool& GetWorkerPool() = 0;
+			virtual std::shared_ptr<ArchiveFileSystem> OpenArchive(const kxf::FSPath& path) = 0;
+			virtual std::shared_ptr<DataFileSystem> OpenDataFileSystem(std::span<const kxf::FSPath> archives) = 0;
+			virtual std::shared_ptr<PluginFile> OpenPluginFile(const kxf::FSPath& path) = 0;
+			virtual size_t ParsePluginFiles(std::span<const kxf::FSPath> paths, const PluginFileVisitor& visitor) = 0;
+
+			virtual ConsoleCommandDispatcher& GetConsoleCommandDispatcher() = 0;
+			virtual std::unique_ptr<IScaleformBackend> CreateScaleformBackend(GFxMovieView& movie) const = 0;
+
+			virtual std::pmr::memory_resource& GetFrameMemoryResource() = 0;
+			virtual std::pmr::memory_resource& GetPoolMemoryResource() = 0;
+
+			virtual MetricsRegistry& GetMetrics() = 0;
+			virtual bool EnableMetricsReporting(std::chrono::milliseconds interval) = 0;
+			virtual bool EnableMemoryReporting(std::chrono::milliseconds interval) = 0;
+			virtual bool ExportProfilerTrace() = 0;
+			virtual TelemetryChannel& GetTelemetry() = 0;
+			virtual bool EnableTelemetry(size_t capacity, std::chrono::milliseconds metricsInterval) = 0;
+
+			virtual TimerService& GetTimers() = 0;
+			virtual CoroutineScheduler& GetCoroutines() = 0;
+			virtual EventBus& GetEvents() = 0;
+			virtual FormCache& GetFormCache() = 0;
+			virtual LocalizationService& GetLocalization() = 0;
+
 			virtual bool Initialize(std::shared_ptr<IExtenderPlugin> plugin) = 0;
 			virtual void Terminate() = 0;
+			// Without the game's delta game time timers follow real time and keep running while the game is paused
+			virtual void ProcessFrame() = 0;
+			virtual void ProcessFrame(std::chrono::microseconds gameTimeDelta) = 0;
 
 			virtual void LogString(const kxf::String& category, kxf::String logString, size_t indent = 0) = 0;
+			virtual void LogSymbol(Symbol category, kxf::String logString, size_t indent = 0) = 0;
 
 		public:
 			template<size_t indent = 0>
 			void Log(const kxf::String& logString)
 			{
-				LogString({}, logString, indent);
+				LogSymbol(Symbol(), logString, indent);
 			}
 
 			template<size_t indent = 0, class ...Args>
 			void Log(const kxf::String& format, Args&&... args)
 			{
-				LogString({}, kxf::Format(format, std::forward<Args>(args)...), indent);
+				LogSymbol(Symbol(), kxf::Format(format, std::forward<Args>(args)...), indent);
 			}
 
 			template<size_t indent = 0>
@@ -90,16 +149,28 @@ namespace xSE
 				LogString(category, logString, indent);
 			}
 
+			template<size_t indent = 0>
+			void LogCategory(Symbol category, const kxf::String& logString)
+			{
+				LogSymbol(category, logString, indent);
+			}
+
+			template<size_t indent = 0, class ...Args>
+			void LogCategory(Symbol category, const kxf::String& format, Args&&... args)
+			{
+				LogSymbol(category, kxf::Format(format, std::forward<Args>(args)...), indent);
+			}
+
 			template<size_t indent = 0>
 			void LogPlatform(const kxf::String& logString)
 			{
-				LogString(GetName(), logString, indent);
+				LogSymbol(GetNameSymbol(), logString, indent);
 			}
 
 			template<size_t indent = 0, class ...Args>
 			void LogPlatform(const kxf::String& format, Args&&... args)
 			{
-				LogString(GetName(), kxf::Format(format, std::forward<Args>(args)...), indent);
+				LogSymbol(GetNameSymbol(), kxf::Format(format, std::forward<Args>(args)...), indent);
 			}
 	};
 }
@@ -0,0 +1,833 @@
+#include "pch.hpp"
+#include "ArchiveFileSystem.h"
+#include "WorkerPool.h"
+#include "DataPath.h"
+#include "UTF8.h"
+#include <kxf/IO/MemoryStream.h>
+#include <zlib.h>
+#include <lz4.h>
+#include <lz4frame.h>
+#include <bit>
+
+namespace
+{
+	using namespace xSE::DataPath;
+
+	namespace BSA
+	{
+		constexpr uint32_t IncludeDirectoryNames = 0x1;
+		constexpr uint32_t IncludeFileNames = 0x2;
+		constexpr uint32_t CompressedArchive = 0x4;
+		constexpr uint32_t EmbedFileNames = 0x100;
+
+		constexpr uint32_t SizeCompressionToggle = 0x40000000;
+		constexpr uint32_t SizeMask = 0x3FFFFFFF;
+	}
+	namespace BA2
+	{
+		constexpr uint32_t CompressionLZ4 = 3;
+	}
+
+	std::string ToNormalizedPath(const kxf::FSPath& path)
+	{
+		std::string result = xSE::UTF8::ToString(path.GetFullPath());
+		NormalizeInPlace(result);
+		return result;
+	}
+
+	class DataReader final
+	{
+		private:
+			std::span<const std::byte> m_Data;
+			size_t m_Offset = 0;
+
+		public:
+			DataReader(std::span<const std::byte> data, size_t offset = 0) noexcept
+				:m_Data(data), m_Offset(offset)
+			{
+			}
+
+		public:
+			size_t GetOffset() const noexcept
+			{
+				return m_Offset;
+			}
+
+			template<class T>
+			bool Read(T& value) noexcept
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+
+				if (m_Offset <= m_Data.size() && sizeof(T) <= m_Data.size() - m_Offset)
+				{
+					std::memcpy(&value, m_Data.data() + m_Offset, sizeof(T));
+					m_Offset += sizeof(T);
+					return true;
+				}
+				return false;
+			}
+			bool Read(std::string_view& value, size_t length) noexcept
+			{
+				if (m_Offset <= m_Data.size() && length <= m_Data.size() - m_Offset)
+				{
+					value = {reinterpret_cast<const char*>(m_Data.data() + m_Offset), length};
+					m_Offset += length;
+					return true;
+				}
+				return false;
+			}
+			bool Skip(size_t length) noexcept
+			{
+				if (m_Offset <= m_Data.size() && length <= m_Data.size() - m_Offset)
+				{
+					m_Offset += length;
+					return true;
+				}
+				return false;
+			}
+	};
+
+	class PathHasher final
+	{
+		private:
+			uint64_t m_Hash = 14695981039346656037ull;
+
+		public:
+			void Add(char c) noexcept
+			{
+				m_Hash ^= static_cast<uint8_t>(NormalizeChar(c));
+				m_Hash *= 1099511628211ull;
+			}
+			void Add(std::string_view value) noexcept
+			{
+				for (char c: value)
+				{
+					Add(c);
+				}
+			}
+			uint64_t GetHash() const noexcept
+			{
+				return m_Hash;
+			}
+	};
+
+	std::string_view GetEntryDirectory(const xSE::ArchiveEntry& entry) noexcept
+	{
+		return !entry.Directory.empty() ? entry.Directory : xSE::DataPath::GetParent(entry.Name);
+	}
+	bool MatchesEntry(const xSE::ArchiveEntry& entry, std::string_view normalizedPath) noexcept
+	{
+		if (entry.Directory.empty())
+		{
+			return EqualsNormalized(entry.Name, normalizedPath);
+		}
+		else
+		{
+			const size_t directoryLength = entry.Directory.size();
+			return normalizedPath.size() == directoryLength + 1 + entry.Name.size() &&
+				normalizedPath[directoryLength] == '\\' &&
+				EqualsNormalized(entry.Directory, normalizedPath.substr(0, directoryLength)) &&
+				EqualsNormalized(entry.Name, normalizedPath.substr(directoryLength + 1));
+		}
+	}
+	bool DecompressZLib(std::span<const std::byte> source, std::byte* destination, size_t size) noexcept
+	{
+		uLongf destinationSize = static_cast<uLongf>(size);
+		const int result = ::uncompress(reinterpret_cast<Bytef*>(destination), &destinationSize, reinterpret_cast<const Bytef*>(source.data()), static_cast<uLong>(source.size()));
+		return result == Z_OK && destinationSize == size;
+	}
+	bool DecompressLZ4Frame(std::span<const std::byte> source, std::byte* destination, size_t size) noexcept
+	{
+		LZ4F_dctx* context = nullptr;
+		if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION)))
+		{
+			return false;
+		}
+
+		size_t written = 0;
+		size_t read = 0;
+		while (read < source.size() && written < size)
+		{
+			size_t destinationSize = size - written;
+			size_t sourceSize = source.size() - read;
+			const size_t result = LZ4F_decompress(context, destination + written, &destinationSize, source.data() + read, &sourceSize, nullptr);
+			if (LZ4F_isError(result))
+			{
+				break;
+			}
+
+			written += destinationSize;
+			read += sourceSize;
+			if (result == 0)
+			{
+				break;
+			}
+		}
+
+		LZ4F_freeDecompressionContext(context);
+		return written == size;
+	}
+	bool DecompressLZ4Block(std::span<const std::byte> source, std::byte* destination, size_t size) noexcept
+	{
+		const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(source.data()), reinterpret_cast<char*>(destination), static_cast<int>(source.size()), static_cast<int>(size));
+		return result >= 0 && static_cast<size_t>(result) == size;
+	}
+
+	class ArchiveInputStream final: public kxf::MemoryInputStream
+	{
+		private:
+			xSE::ArchiveData m_Data;
+
+		public:
+			ArchiveInputStream(xSE::ArchiveData data)
+				:MemoryInputStream(data.GetData(), data.GetSize()), m_Data(std::move(data))
+			{
+			}
+	};
+}
+
+namespace xSE
+{
+	uint64_t ArchiveFileSystem::HashPath(std::string_view path) noexcept
+	{
+		PathHasher hasher;
+		hasher.Add(path);
+		return hasher.GetHash();
+	}
+
+	bool ArchiveFileSystem::ParseBSA()
+	{
+		struct Header final
+		{
+			char ID[4];
+			uint32_t Version;
+			uint32_t Offset;
+			uint32_t ArchiveFlags;
+			uint32_t FolderCount;
+			uint32_t FileCount;
+			uint32_t TotalFolderNameLength;
+			uint32_t TotalFileNameLength;
+			uint16_t FileFlags;
+			uint16_t Padding;
+		};
+		struct FolderRecord final
+		{
+			uint32_t FileCount = 0;
+		};
+
+		Header header = {};
+		if (!DataReader(m_File.MapView(0, sizeof(Header)).GetView()).Read(header) || header.Version < 103 || header.Version > 105 || header.Offset != sizeof(Header))
+		{
+			return false;
+		}
+
+		// Everything up to the end of the file names, the entry data follows it
+		const uint64_t folderRecordSize = header.Version >= 105 ? 24 : 16;
+		const uint64_t directorySize = sizeof(Header) + header.FolderCount * (folderRecordSize + 1) + header.TotalFolderNameLength + header.FileCount * 16ull + header.TotalFileNameLength;
+		m_Directory = m_File.MapView(0, directorySize);
+		if (m_Directory.IsEmpty())
+		{
+			return false;
+		}
+
+		DataReader reader(m_Directory.GetView(), sizeof(Header));
+
+		// Without names the entries can't be looked up by path
+		if ((header.ArchiveFlags & (BSA::IncludeDirectoryNames|BSA::IncludeFileNames)) != (BSA::IncludeDirectoryNames|BSA::IncludeFileNames))
+		{
+			return false;
+		}
+		m_Version = header.Version;
+		m_HasEmbeddedNames = header.Version >= 104 && (header.ArchiveFlags & BSA::EmbedFileNames);
+		m_UseLZ4 = header.Version >= 105;
+
+		// Folder records only matter for their file counts, the file blocks follow them in the same order
+		std::vector<FolderRecord> folders(header.FolderCount);
+		for (FolderRecord& folder: folders)
+		{
+			uint64_t hash = 0;
+			uint32_t unused = 0;
+			uint64_t offset = 0;
+
+			bool isRead = reader.Read(hash) && reader.Read(folder.FileCount);
+			if (header.Version >= 105)
+			{
+				isRead = isRead && reader.Read(unused) && reader.Read(offset);
+			}
+			else
+			{
+				isRead = isRead && reader.Read(unused);
+			}
+
+			if (!isRead)
+			{
+				return false;
+			}
+		}
+
+		m_Entries.reserve(header.FileCount);
+		const bool isCompressedByDefault = header.ArchiveFlags & BSA::CompressedArchive;
+		for (const FolderRecord& folder: folders)
+		{
+			// Length-prefixed and null-terminated
+			uint8_t nameLength = 0;
+			std::string_view directory;
+			if (!reader.Read(nameLength) || !reader.Read(directory, nameLength))
+			{
+				return false;
+			}
+			if (!directory.empty() && directory.back() == '\0')
+			{
+				directory.remove_suffix(1);
+			}
+
+			for (uint32_t i = 0; i < folder.FileCount; i++)
+			{
+				uint64_t hash = 0;
+				uint32_t size = 0;
+				uint32_t offset = 0;
+				if (!reader.Read(hash) || !reader.Read(size) || !reader.Read(offset))
+				{
+					return false;
+				}
+
+				ArchiveEntry& entry = m_Entries.emplace_back();
+				entry.Directory = directory;
+				entry.Offset = offset;
+				entry.StoredSize = size & BSA::SizeMask;
+				entry.IsCompressed = (size & BSA::SizeCompressionToggle) ? !isCompressedByDefault : isCompressedByDefault;
+
+				// The real size is in front of the data for compressed and name-prefixed entries, see 'GetEntrySize'
+				entry.Size = entry.IsCompressed || m_HasEmbeddedNames ? 0 : entry.StoredSize;
+			}
+		}
+
+		// Null-terminated file names in the same order as the file records
+		std::string_view names;
+		if (m_Entries.size() != header.FileCount || !reader.Read(names, header.TotalFileNameLength))
+		{
+			return false;
+		}
+		for (ArchiveEntry& entry: m_Entries)
+		{
+			const size_t length = names.find('\0');
+			if (length == names.npos)
+			{
+				return false;
+			}
+			entry.Name = names.substr(0, length);
+			names.remove_prefix(length + 1);
+		}
+
+		m_Format = ArchiveFormat::BSA;
+		return true;
+	}
+	bool ArchiveFileSystem::ParseBA2()
+	{
+		struct Header final
+		{
+			char ID[4];
+			uint32_t Version;
+			char Type[4];
+			uint32_t FileCount;
+			uint64_t NameTableOffset;
+		};
+
+		// BA2 is only used by the 64-bit games, the directory is the whole file
+		m_Directory = m_File.MapView(0, m_File.GetSize());
+
+		DataReader reader(m_Directory.GetView());
+		Header header = {};
+		if (!reader.Read(header))
+		{
+			return false;
+		}
+		m_Version = header.Version;
+
+		// Newer versions extend the header
+		if (header.Version == 2 || header.Version == 3)
+		{
+			uint64_t unknown = 0;
+			if (!reader.Read(unknown))
+			{
+				return false;
+			}
+		}
+		if (header.Version == 3)
+		{
+			uint32_t compressionFormat = 0;
+			if (!reader.Read(compressionFormat))
+			{
+				return false;
+			}
+			m_UseLZ4 = compressionFormat == BA2::CompressionLZ4;
+		}
+
+		const std::string_view type(header.Type, sizeof(header.Type));
+		m_Entries.resize(header.FileCount);
+		if (type == "GNRL")
+		{
+			for (ArchiveEntry& entry: m_Entries)
+			{
+				uint32_t nameHash = 0;
+				char extension[4] = {};
+				uint32_t directoryHash = 0;
+				uint32_t flags = 0;
+				uint64_t offset = 0;
+				uint32_t packedSize = 0;
+				uint32_t size = 0;
+				uint32_t alignment = 0;
+
+				if (!reader.Read(nameHash) || !reader.Read(extension) || !reader.Read(directoryHash) || !reader.Read(flags) ||
+					!reader.Read(offset) || !reader.Read(packedSize) || !reader.Read(size) || !reader.Read(alignment))
+				{
+					return false;
+				}
+
+				entry.Offset = offset;
+				entry.Size = size;
+				entry.IsCompressed = packedSize != 0;
+				entry.StoredSize = entry.IsCompressed ? packedSize : size;
+			}
+			m_Format = ArchiveFormat::BA2General;
+		}
+		else if (type == "DX10")
+		{
+			// Textures are split in chunks per mip range, they're indexed so lookups work but can't be read as files
+			for (ArchiveEntry& entry: m_Entries)
+			{
+				uint32_t nameHash = 0;
+				char extension[4] = {};
+				uint32_t directoryHash = 0;
+				uint8_t unknown = 0;
+				uint8_t chunkCount = 0;
+				uint16_t chunkHeaderSize = 0;
+				if (!reader.Read(nameHash) || !reader.Read(extension) || !reader.Read(directoryHash) || !reader.Read(unknown) ||
+					!reader.Read(chunkCount) || !reader.Read(chunkHeaderSize) || !reader.Skip(8))
+				{
+					return false;
+				}
+
+				for (uint8_t i = 0; i < chunkCount; i++)
+				{
+					uint64_t offset = 0;
+					uint32_t packedSize = 0;
+					uint32_t size = 0;
+					if (!reader.Read(offset) || !reader.Read(packedSize) || !reader.Read(size) || !reader.Skip(8))
+					{
+						return false;
+					}
+					entry.Size += size;
+				}
+			}
+			m_Format = ArchiveFormat::BA2Textures;
+		}
+		else
+		{
+			return false;
+		}
+
+		// Name table: 16-bit length followed by the path without terminator
+		DataReader nameReader(m_Directory.GetView(), static_cast<size_t>(header.NameTableOffset));
+		for (ArchiveEntry& entry: m_Entries)
+		{
+			uint16_t length = 0;
+			if (!nameReader.Read(length) || !nameReader.Read(entry.Name, length))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	void ArchiveFileSystem::BuildIndex()
+	{
+		// Open addressing at no more than 50% load, buckets store entry index + 1 so zero marks an empty one
+		m_EntryHashes.resize(m_Entries.size());
+		m_Buckets.assign(std::bit_ceil(std::max<size_t>(m_Entries.size() * 2, 16)), 0);
+		const size_t mask = m_Buckets.size() - 1;
+
+		for (size_t i = 0; i < m_Entries.size(); i++)
+		{
+			const ArchiveEntry& entry = m_Entries[i];
+
+			PathHasher hasher;
+			if (!entry.Directory.empty())
+			{
+				hasher.Add(entry.Directory);
+				hasher.Add('\\');
+			}
+			hasher.Add(entry.Name);
+			m_EntryHashes[i] = hasher.GetHash();
+
+			for (size_t bucket = m_EntryHashes[i] & mask; ; bucket = (bucket + 1) & mask)
+			{
+				if (m_Buckets[bucket] == 0)
+				{
+					m_Buckets[bucket] = static_cast<uint32_t>(i + 1);
+					break;
+				}
+			}
+
+			// Register the directory and all of its parents
+			for (std::string directory = Normalize(GetEntryDirectory(entry)); !directory.empty();)
+			{
+				const uint64_t hash = HashPath(directory);
+				if (m_DirectoryIndex.contains(hash))
+				{
+					break;
+				}
+				m_DirectoryIndex.emplace(hash, static_cast<uint32_t>(m_Directories.size()));
+
+				const size_t separator = directory.rfind('\\');
+				m_Directories.emplace_back(directory);
+				directory.resize(separator != directory.npos ? separator : 0);
+			}
+		}
+	}
+
+	const ArchiveEntry* ArchiveFileSystem::FindEntry(std::string_view normalizedPath, uint64_t hash) const noexcept
+	{
+		if (m_Buckets.empty())
+		{
+			return nullptr;
+		}
+
+		const size_t mask = m_Buckets.size() - 1;
+		for (size_t bucket = hash & mask; m_Buckets[bucket] != 0; bucket = (bucket + 1) & mask)
+		{
+			const size_t index = m_Buckets[bucket] - 1;
+			if (m_EntryHashes[index] == hash && MatchesEntry(m_Entries[index], normalizedPath))
+			{
+				return &m_Entries[index];
+			}
+		}
+		return nullptr;
+	}
+	ArchiveData ArchiveFileSystem::DecompressBSA(const ArchiveEntry& entry, std::span<const std::byte> data) const
+	{
+		uint32_t size = 0;
+		DataReader reader(data);
+		if (!reader.Read(size))
+		{
+			return {};
+		}
+		data = data.subspan(reader.GetOffset());
+
+		auto buffer = std::make_unique<std::byte[]>(size);
+		const bool isDecompressed = m_UseLZ4 ? DecompressLZ4Frame(data, buffer.get(), size) : DecompressZLib(data, buffer.get(), size);
+		if (isDecompressed)
+		{
+			return {std::move(buffer), size};
+		}
+		return {};
+	}
+	ArchiveData ArchiveFileSystem::DecompressBA2(const ArchiveEntry& entry, std::span<const std::byte> data) const
+	{
+		auto buffer = std::make_unique<std::byte[]>(entry.Size);
+		const bool isDecompressed = m_UseLZ4 ? DecompressLZ4Block(data, buffer.get(), entry.Size) : DecompressZLib(data, buffer.get(), entry.Size);
+		if (isDecompressed)
+		{
+			return {std::move(buffer), entry.Size};
+		}
+		return {};
+	}
+	kxf::FileItem ArchiveFileSystem::MakeItem(const ArchiveEntry& entry) const
+	{
+		kxf::FileItem item(kxf::FSPath(kxf::String::FromUTF8(entry.GetPath())));
+		item.SetAttributes(kxf::FileAttribute::Normal|kxf::FileAttribute::ReadOnly);
+		item.SetSize(kxf::DataSize::FromBytes(GetEntrySize(entry)));
+		if (entry.IsCompressed)
+		{
+			item.SetCompressedSize(kxf::DataSize::FromBytes(entry.StoredSize));
+		}
+		return item;
+	}
+
+	bool ArchiveFileSystem::Open(const kxf::FSPath& path)
+	{
+		Close();
+
+		const bool isOpened = sizeof(void*) < 8 ? m_File.OpenWindowed(path) : m_File.Open(path);
+		if (!isOpened)
+		{
+			return false;
+		}
+
+		const MappedView magicView = m_File.MapView(0, std::min<size_t>(m_File.GetSize(), 4));
+		const std::string_view magic(reinterpret_cast<const char*>(magicView.GetData()), magicView.GetSize());
+		bool isParsed = false;
+		if (magic == std::string_view("BSA\0", 4))
+		{
+			isParsed = ParseBSA();
+		}
+		else if (magic == "BTDX")
+		{
+			isParsed = ParseBA2();
+		}
+
+		if (isParsed)
+		{
+			m_Path = path;
+			BuildIndex();
+			return true;
+		}
+
+		Close();
+		return false;
+	}
+	void ArchiveFileSystem::Close() noexcept
+	{
+		m_Entries.clear();
+		m_EntryHashes.clear();
+		m_Buckets.clear();
+		m_Directories.clear();
+		m_DirectoryIndex.clear();
+
+		m_Format = ArchiveFormat::None;
+		m_Version = 0;
+		m_HasEmbeddedNames = false;
+		m_UseLZ4 = false;
+		m_Path = {};
+		m_Directory.Reset();
+		m_File.Close();
+	}
+
+	const ArchiveEntry* ArchiveFileSystem::FindEntry(std::string_view path) const noexcept
+	{
+		// Fast path for paths which are already in canonical form
+		if (IsNormalized(path))
+		{
+			return FindEntry(path, HashPath(path));
+		}
+		else
+		{
+			const std::string normalizedPath = Normalize(path);
+			return FindEntry(normalizedPath, HashPath(normalizedPath));
+		}
+	}
+	const ArchiveEntry* ArchiveFileSystem::FindEntry(const kxf::FSPath& path) const
+	{
+		const std::string normalizedPath = ToNormalizedPath(path);
+		return FindEntry(normalizedPath, HashPath(normalizedPath));
+	}
+	uint32_t ArchiveFileSystem::GetEntrySize(const ArchiveEntry& entry) const noexcept
+	{
+		if (entry.Size != 0 || m_Format != ArchiveFormat::BSA)
+		{
+			return entry.Size;
+		}
+
+		const MappedView view = m_File.MapView(entry.Offset, entry.StoredSize);
+		DataReader reader(view.GetView());
+		uint32_t size = entry.StoredSize;
+		if (m_HasEmbeddedNames)
+		{
+			uint8_t nameLength = 0;
+			if (!reader.Read(nameLength) || !reader.Skip(nameLength))
+			{
+				return 0;
+			}
+			size -= 1 + nameLength;
+		}
+		if (entry.IsCompressed && !reader.Read(size))
+		{
+			return 0;
+		}
+		return size;
+	}
+
+	ArchiveData ArchiveFileSystem::ReadEntry(const ArchiveEntry& entry) const
+	{
+		MappedView view = m_File.MapView(entry.Offset, entry.StoredSize);
+		auto data = view.GetView();
+		if (data.empty())
+		{
+			return {};
+		}
+
+		switch (m_Format)
+		{
+			case ArchiveFormat::BSA:
+			{
+				size_t offset = 0;
+				if (m_HasEmbeddedNames)
+				{
+					const size_t nameLength = static_cast<uint8_t>(data[0]);
+					if (1 + nameLength > data.size())
+					{
+						return {};
+					}
+					offset = 1 + nameLength;
+				}
+				return entry.IsCompressed ? DecompressBSA(entry, data.subspan(offset)) : ArchiveData(std::move(view), offset);
+			}
+			case ArchiveFormat::BA2General:
+			{
+				return entry.IsCompressed ? DecompressBA2(entry, data) : ArchiveData(std::move(view));
+			}
+		};
+		return {};
+	}
+	std::future<ArchiveData> ArchiveFileSystem::ReadEntryAsync(const ArchiveEntry& entry) const
+	{
+		if (m_WorkerPool && entry.IsCompressed)
+		{
+			// The entry is copied, it may be a temporary of the caller
+			return m_WorkerPool->Submit([this, self = weak_from_this().lock(), entry]()
+			{
+				return ReadEntry(entry);
+			});
+		}
+
+		// Nothing to offload for views
+		std::promise<ArchiveData> promise;
+		promise.set_value(ReadEntry(entry));
+		return promise.get_future();
+	}
+	std::vector<ArchiveData> ArchiveFileSystem::ReadEntries(std::span<const ArchiveEntry* const> entries) const
+	{
+		std::vector<ArchiveData> result(entries.size());
+		auto Read = [&](size_t index)
+		{
+			if (entries[index])
+			{
+				result[index] = ReadEntry(*entries[index]);
+			}
+		};
+
+		if (m_WorkerPool)
+		{
+			m_WorkerPool->ParallelFor(entries.size(), Read);
+		}
+		else
+		{
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				Read(i);
+			}
+		}
+		return result;
+	}
+
+	// IFileSystem
+	bool ArchiveFileSystem::IsValidPathName(const kxf::FSPath& path) const
+	{
+		return !path.GetFullPath().ContainsAnyOfCharacters(GetForbiddenPathNameCharacters());
+	}
+	kxf::String ArchiveFileSystem::GetForbiddenPathNameCharacters(const kxf::String& except) const
+	{
+		kxf::String result;
+		for (auto c: kxf::String("<>:\"|?*"))
+		{
+			if (!except.Contains(c))
+			{
+				result += c;
+			}
+		}
+		return result;
+	}
+
+	kxf::FSPath ArchiveFileSystem::ResolvePath(const kxf::FSPath& relativePath) const
+	{
+		return m_Path / relativePath;
+	}
+
+	bool ArchiveFileSystem::ItemExist(const kxf::FSPath& path) const
+	{
+		return FileExist(path) || DirectoryExist(path);
+	}
+	bool ArchiveFileSystem::FileExist(const kxf::FSPath& path) const
+	{
+		return FindEntry(path) != nullptr;
+	}
+	bool ArchiveFileSystem::DirectoryExist(const kxf::FSPath& path) const
+	{
+		const std::string normalizedPath = ToNormalizedPath(path);
+		return normalizedPath.empty() || m_DirectoryIndex.contains(HashPath(normalizedPath));
+	}
+
+	kxf::FileItem ArchiveFileSystem::GetItem(const kxf::FSPath& path) const
+	{
+		if (const ArchiveEntry* entry = FindEntry(path))
+		{
+			return MakeItem(*entry);
+		}
+		else if (DirectoryExist(path))
+		{
+			kxf::FileItem item(path);
+			item.SetAttributes(kxf::FileAttribute::Directory|kxf::FileAttribute::ReadOnly);
+			return item;
+		}
+		return {};
+	}
+	kxf::Enumerator<kxf::FileItem> ArchiveFileSystem::EnumItems(const kxf::FSPath& directory, const kxf::FSPath& query, kxf::FlagSet<kxf::FSActionFlag> flags) const
+	{
+		const std::string normalizedDirectory = ToNormalizedPath(directory);
+		const std::string pattern = query ? xSE::UTF8::ToString(query.GetFullPath()) : std::string("*");
+		const bool recursive = flags.Contains(kxf::FSActionFlag::Recursive);
+
+		std::vector<kxf::FileItem> items;
+		if (!flags.Contains(kxf::FSActionFlag::LimitToFiles))
+		{
+			for (const std::string& path: m_Directories)
+			{
+				if (IsInDirectory(GetParent(path), normalizedDirectory, recursive) && MatchesWildcard(GetName(path), pattern))
+				{
+					kxf::FileItem& item = items.emplace_back(kxf::FSPath(kxf::String::FromUTF8(path)));
+					item.SetAttributes(kxf::FileAttribute::Directory|kxf::FileAttribute::ReadOnly);
+				}
+			}
+		}
+		if (!flags.Contains(kxf::FSActionFlag::LimitToDirectories))
+		{
+			for (const ArchiveEntry& entry: m_Entries)
+			{
+				if (IsInDirectory(GetEntryDirectory(entry), normalizedDirectory, recursive) && MatchesWildcard(GetName(entry.Name), pattern))
+				{
+					items.emplace_back(MakeItem(entry));
+				}
+			}
+		}
+
+		const size_t count = items.size();
+		return kxf::Enumerator<kxf::FileItem>([items = std::move(items)](kxf::IEnumerator& enumerator) mutable -> std::optional<kxf::FileItem>
+		{
+			const size_t index = enumerator.GetCurrentStep();
+			if (index < items.size())
+			{
+				return std::move(items[index]);
+			}
+
+			enumerator.TerminateEnumeration();
+			return {};
+		}, count);
+	}
+	bool ArchiveFileSystem::IsDirectoryEmpty(const kxf::FSPath& directory) const
+	{
+		// Archives don't store empty directories
+		return !DirectoryExist(directory);
+	}
+
+	std::unique_ptr<kxf::IStream> ArchiveFileSystem::GetStream(const kxf::FSPath& path,
+															   kxf::FlagSet<kxf::IOStreamAccess> access,
+															   kxf::IOStreamDisposition disposition,
+															   kxf::FlagSet<kxf::IOStreamShare> share,
+															   kxf::FlagSet<kxf::IOStreamFlag> streamFlags,
+															   kxf::FlagSet<kxf::FSActionFlag> flags
+	)
+	{
+		if (access.Contains(kxf::IOStreamAccess::Write) || disposition != kxf::IOStreamDisposition::OpenExisting)
+		{
+			return nullptr;
+		}
+
+		if (const ArchiveEntry* entry = FindEntry(path))
+		{
+			if (auto data = ReadEntry(*entry); !data.IsEmpty() || GetEntrySize(*entry) == 0)
+			{
+				return std::make_unique<ArchiveInputStream>(std::move(data));
+			}
+		}
+		return nullptr;
+	}
+}
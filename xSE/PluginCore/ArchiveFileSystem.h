@@ -0,0 +1,250 @@
+#pragma once
+#include "Framework.hpp"
+#include "MappedFile.h"
+#include <kxf/FileSystem/IFileSystem.h>
+#include <span>
+#include <future>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace xSE
+{
+	class WorkerPool;
+}
+
+namespace xSE
+{
+	enum class ArchiveFormat
+	{
+		None = -1,
+
+		BSA,
+		BA2General,
+		BA2Textures
+	};
+
+	struct ArchiveEntry final
+	{
+		// Both are views into the mapped archive. BA2 stores full paths so 'Directory' is empty for them.
+		std::string_view Directory;
+		std::string_view Name;
+
+		uint64_t Offset = 0;
+		uint32_t StoredSize = 0;
+		uint32_t Size = 0;
+		bool IsCompressed = false;
+
+		std::string GetPath() const
+		{
+			std::string path;
+			if (!Directory.empty())
+			{
+				path.reserve(Directory.size() + Name.size() + 1);
+				path += Directory;
+				path += '\\';
+			}
+			path += Name;
+			return path;
+		}
+	};
+
+	// Contents of an archived file: either a view directly into the mapped archive or a decompressed buffer
+	class ArchiveData final
+	{
+		private:
+			std::unique_ptr<std::byte[]> m_Buffer;
+			MappedView m_Mapping;
+			std::span<const std::byte> m_View;
+
+		public:
+			ArchiveData() noexcept = default;
+			ArchiveData(MappedView mapping, size_t offset = 0) noexcept
+				:m_Mapping(std::move(mapping)), m_View(m_Mapping.GetView().subspan(offset))
+			{
+			}
+			ArchiveData(std::unique_ptr<std::byte[]> buffer, size_t size) noexcept
+				:m_Buffer(std::move(buffer)), m_View(m_Buffer.get(), size)
+			{
+			}
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				return m_View.empty();
+			}
+			bool IsOwned() const noexcept
+			{
+				return m_Buffer != nullptr;
+			}
+
+			const std::byte* GetData() const noexcept
+			{
+				return m_View.data();
+			}
+			size_t GetSize() const noexcept
+			{
+				return m_View.size();
+			}
+			std::span<const std::byte> GetView() const noexcept
+			{
+				return m_View;
+			}
+	};
+}
+
+namespace xSE
+{
+	// Read-only file system over a single BSA (versions 103-105) or BA2 archive. The archive is memory mapped and its
+	// directory tables are indexed in place, entry names are views into the mapping. Uncompressed files are served as
+	// views without copying, compressed ones (zlib or LZ4 depending on the format) are decompressed on request, either
+	// on the calling thread or on the worker pool for asynchronous and batch reads.
+	// In 32-bit processes the vanilla archives often don't fit into the free address space as a whole, there only the
+	// directory is mapped for as long as the archive is open and every read maps a window around its entry.
+	class xSE_API ArchiveFileSystem final: public kxf::RTTI::Implementation<ArchiveFileSystem, kxf::IFileSystem>, public std::enable_shared_from_this<ArchiveFileSystem>
+	{
+		public:
+			static uint64_t HashPath(std::string_view path) noexcept;
+
+		private:
+			MappedFile m_File;
+			MappedView m_Directory;
+			kxf::FSPath m_Path;
+			ArchiveFormat m_Format = ArchiveFormat::None;
+			uint32_t m_Version = 0;
+			bool m_HasEmbeddedNames = false;
+			bool m_UseLZ4 = false;
+			WorkerPool* m_WorkerPool = nullptr;
+
+			std::vector<ArchiveEntry> m_Entries;
+			std::vector<uint64_t> m_EntryHashes;
+			std::vector<uint32_t> m_Buckets;
+
+			std::vector<std::string> m_Directories;
+			std::unordered_map<uint64_t, uint32_t> m_DirectoryIndex;
+
+		private:
+			bool ParseBSA();
+			bool ParseBA2();
+			void BuildIndex();
+
+			const ArchiveEntry* FindEntry(std::string_view normalizedPath, uint64_t hash) const noexcept;
+			ArchiveData DecompressBSA(const ArchiveEntry& entry, std::span<const std::byte> data) const;
+			ArchiveData DecompressBA2(const ArchiveEntry& entry, std::span<const std::byte> data) const;
+			kxf::FileItem MakeItem(const ArchiveEntry& entry) const;
+
+		public:
+			ArchiveFileSystem(WorkerPool* workerPool = nullptr) noexcept
+				:m_WorkerPool(workerPool)
+			{
+			}
+			ArchiveFileSystem(const ArchiveFileSystem&) = delete;
+
+		public:
+			bool Open(const kxf::FSPath& path);
+			void Close() noexcept;
+			bool IsOpen() const noexcept
+			{
+				return m_File.IsOpen();
+			}
+
+			ArchiveFormat GetFormat() const noexcept
+			{
+				return m_Format;
+			}
+			uint32_t GetVersion() const noexcept
+			{
+				return m_Version;
+			}
+			const kxf::FSPath& GetArchivePath() const noexcept
+			{
+				return m_Path;
+			}
+
+			std::span<const ArchiveEntry> GetEntries() const noexcept
+			{
+				return m_Entries;
+			}
+			const ArchiveEntry* FindEntry(std::string_view path) const noexcept;
+			const ArchiveEntry* FindEntry(const kxf::FSPath& path) const;
+			uint32_t GetEntrySize(const ArchiveEntry& entry) const noexcept;
+
+			ArchiveData ReadEntry(const ArchiveEntry& entry) const;
+			// An archive owned by a 'shared_ptr', as all the ones opened by the platform are, is kept alive until the read
+			// is done. Any other one has to outlive the future.
+			std::future<ArchiveData> ReadEntryAsync(const ArchiveEntry& entry) const;
+			std::vector<ArchiveData> ReadEntries(std::span<const ArchiveEntry* const> entries) const;
+
+		public:
+			// IFileSystem
+			bool IsNull() const override
+			{
+				return !m_File.IsOpen();
+			}
+			bool IsValidPathName(const kxf::FSPath& path) const override;
+			kxf::String GetForbiddenPathNameCharacters(const kxf::String& except = {}) const override;
+
+			bool IsLookupScoped() const override
+			{
+				return true;
+			}
+			kxf::FSPath ResolvePath(const kxf::FSPath& relativePath) const override;
+			kxf::FSPath GetLookupDirectory() const override
+			{
+				return m_Path;
+			}
+
+			bool ItemExist(const kxf::FSPath& path) const override;
+			bool FileExist(const kxf::FSPath& path) const override;
+			bool DirectoryExist(const kxf::FSPath& path) const override;
+
+			kxf::FileItem GetItem(const kxf::FSPath& path) const override;
+			kxf::Enumerator<kxf::FileItem> EnumItems(const kxf::FSPath& directory, const kxf::FSPath& query = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) const override;
+			bool IsDirectoryEmpty(const kxf::FSPath& directory) const override;
+
+			std::unique_ptr<kxf::IStream> GetStream(const kxf::FSPath& path,
+													kxf::FlagSet<kxf::IOStreamAccess> access,
+													kxf::IOStreamDisposition disposition,
+													kxf::FlagSet<kxf::IOStreamShare> share = kxf::IOStreamShare::Read,
+													kxf::FlagSet<kxf::IOStreamFlag> streamFlags = kxf::IOStreamFlag::None,
+													kxf::FlagSet<kxf::FSActionFlag> flags = {}
+			) override;
+
+			// Archives are read-only
+			bool CreateDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override
+			{
+				return false;
+			}
+			bool ChangeAttributes(const kxf::FSPath& path, kxf::FlagSet<kxf::FileAttribute> attributes) override
+			{
+				return false;
+			}
+			bool ChangeTimestamp(const kxf::FSPath& path, kxf::DateTime creationTime, kxf::DateTime modificationTime, kxf::DateTime lastAccessTime) override
+			{
+				return false;
+			}
+			bool CopyItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override
+			{
+				return false;
+			}
+			bool MoveItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override
+			{
+				return false;
+			}
+			bool RenameItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override
+			{
+				return false;
+			}
+			bool RemoveItem(const kxf::FSPath& path) override
+			{
+				return false;
+			}
+			bool RemoveDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override
+			{
+				return false;
+			}
+
+		public:
+			ArchiveFileSystem& operator=(const ArchiveFileSystem&) = delete;
+	};
+}
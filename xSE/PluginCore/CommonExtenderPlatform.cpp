@@ -3,6 +3,12 @@
 #include "ScriptExtenderDefinesExtra.h"
 #include "ScriptExtenderInterfaceIncludes.h"
 #include "InitializationEvent.h"
+#include "ScaleformBridge.h"
+#include "ArchiveFileSystem.h"
+#include "DataFileSystem.h"
+#include "PluginFileParser.h"
+#include "MemoryTracker.h"
+#include "UTF8.h"
 
 #include <kxf/IO/IStream.h>
 #include <kxf/IO/StreamReaderWriter.h>
@@ -11,6 +17,124 @@
 #include <kxf/System/DynamicLibrary.h>
 #include <kxf/System/ShellOperations.h>
 #include <kxf/FileSystem/NativeFileSystem.h>
+#include <format>
+#include <ctime>
+
+namespace
+{
+	template<class TOutputIt>
+	TOutputIt FormatLogTimestamp(TOutputIt it)
+	{
+		using namespace std::chrono;
+
+		auto now = system_clock::now();
+		auto time = system_clock::to_time_t(now);
+		auto milliseconds = duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+
+		std::tm localTime = {};
+		localtime_s(&localTime, &time);
+
+		return std::format_to(it, "[{:04}-{:02}-{:02} {:02}:{:02}:{:02}:{:03}] ",
+							  localTime.tm_year + 1900,
+							  localTime.tm_mon + 1,
+							  localTime.tm_mday,
+							  localTime.tm_hour,
+							  localTime.tm_min,
+							  localTime.tm_sec,
+							  milliseconds
+		);
+	}
+
+	#if xSE_HAS_MESSAGING_INTERFACE
+	void OnPlatformMessage(xSE_MessagingInterface::Message* message)
+	{
+		auto platform = xSE::GetPlatform();
+
+		// Loading a save or starting a new game replaces most of the forms, whatever was cached is gone with them
+		switch (message->type)
+		{
+			case xSE_MessagingInterface::kMessage_PreLoadGame:
+			case xSE_MessagingInterface::kMessage_PostLoadGame:
+			case xSE_MessagingInterface::kMessage_NewGame:
+			{
+				platform->GetFormCache().Invalidate();
+				break;
+			}
+		};
+
+		// Waiting coroutines see the message after the cache is up to date
+		platform->GetCoroutines().NotifyMessage({message->type, message->data, message->dataLen});
+	}
+	#endif
+
+	// Redirects the framework log to the platform's log file
+	class FrameworkLogTarget final: public wxLog
+	{
+		private:
+			xSE::CommonExtenderPlatform& m_Platform;
+
+		protected:
+			void DoLogRecord(wxLogLevel level, const wxString& message, const wxLogRecordInfo& info) override
+			{
+				auto TranslateLevel = [](wxLogLevel level)
+				{
+					switch (level)
+					{
+						case wxLOG_Info:
+						{
+							return "Framework:Info";
+						}
+						case wxLOG_Error:
+						{
+							return "Framework:Error";
+						}
+						case wxLOG_Trace:
+						{
+							return "Framework:Trace";
+						}
+						case wxLOG_Debug:
+						{
+							return "Framework:Debug";
+						}
+						case wxLOG_Status:
+						{
+							return "Framework:Status";
+						}
+						case wxLOG_Message:
+						{
+							return "Framework:Message";
+						}
+						case wxLOG_Warning:
+						{
+							return "Framework:Warning";
+						}
+						case wxLOG_Progress:
+						{
+							return "Framework:Progress";
+						}
+						case wxLOG_FatalError:
+						{
+							return "Framework:FatalError";
+						}
+					};
+					return "Framework";
+				};
+				m_Platform.LogCategory(xSE::SymbolTable::GetInstance().Intern(std::string_view(TranslateLevel(level))), message);
+			}
+
+		public:
+			FrameworkLogTarget(xSE::CommonExtenderPlatform& platform)
+				:m_Platform(platform)
+			{
+			}
+
+		public:
+			const xSE::CommonExtenderPlatform& GetPlatform() const noexcept
+			{
+				return m_Platform;
+			}
+	};
+}
 
 namespace xSE
 {
@@ -94,11 +218,68 @@ namespace xSE
 		};
 		return {};
 	}
+	kxf::FSPath CommonExtenderPlatform::GetGameDataDirectoryPath() const
+	{
+		return kxf::NativeFileSystem::GetExecutingModuleRootDirectory() / "Data";
+	}
 	kxf::FSPath CommonExtenderPlatform::GetPlatformDirectoryPath() const
 	{
-		return kxf::NativeFileSystem::GetExecutingModuleRootDirectory() / "Data" / GetPlatformFolderName();
+		return GetGameDataDirectoryPath() / GetPlatformFolderName();
 	}
 
+	struct CommonExtenderPlatform::Services final
+	{
+		ConfigFile Config;
+		ConsoleCommandDispatcher Commands;
+		FrameArenaResource FrameArena;
+		MetricsRegistry Metrics;
+		WorkerPool Workers;
+		TimerService Timers;
+		CoroutineScheduler Coroutines;
+		EventBus Events;
+		TelemetryChannel Telemetry;
+		FormCache Forms;
+		LocalizationService Localization;
+
+		Services()
+			:Coroutines(Workers, Timers)
+		{
+		}
+	};
+
+	auto CommonExtenderPlatform::GetServices() const -> Services&
+	{
+		if (auto services = m_Services.load(std::memory_order_acquire))
+		{
+			return *services;
+		}
+
+		std::lock_guard lock(m_ServicesLock);
+		if (auto services = m_Services.load(std::memory_order_relaxed))
+		{
+			return *services;
+		}
+
+		auto services = new Services();
+		m_Services.store(services, std::memory_order_release);
+		return *services;
+	}
+
+	CommonExtenderPlatform::~CommonExtenderPlatform()
+	{
+		delete m_Services.load(std::memory_order_acquire);
+	}
+
+	void CommonExtenderPlatform::InitializeConfig()
+	{
+		if (auto fs = GetPlatformPluginsDirectory())
+		{
+			if (auto stream = fs->OpenToRead(m_Plugin->GetName() + ".ini"))
+			{
+				GetServices().Config.Load(*stream);
+			}
+		}
+	}
 	void CommonExtenderPlatform::InitializeLogger()
 	{
 		// Disable asserts as they're not useful here
@@ -113,67 +294,7 @@ namespace xSE
 		// Redirect the framework log to our own log file
 		if (m_LogStream)
 		{
-			class LogTarget final: public wxLog
-			{
-				private:
-					CommonExtenderPlatform& m_Platform;
-
-				protected:
-					void DoLogRecord(wxLogLevel level, const wxString& message, const wxLogRecordInfo& info) override
-					{
-						auto TranslateLevel = [](wxLogLevel level)
-						{
-							switch (level)
-							{
-								case wxLOG_Info:
-								{
-									return "Info";
-								}
-								case wxLOG_Error:
-								{
-									return "Error";
-								}
-								case wxLOG_Trace:
-								{
-									return "Trace";
-								}
-								case wxLOG_Debug:
-								{
-									return "Debug";
-								}
-								case wxLOG_Status:
-								{
-									return "Status";
-								}
-								case wxLOG_Message:
-								{
-									return "Message";
-								}
-								case wxLOG_Warning:
-								{
-									return "Warning";
-								}
-								case wxLOG_Progress:
-								{
-									return "Progress";
-								}
-								case wxLOG_FatalError:
-								{
-									return "FatalError";
-								}
-							};
-							return "";
-						};
-						m_Platform.LogCategory(kxf::Format("Framework:{}", TranslateLevel(level)), message);
-					}
-
-				public:
-					LogTarget(CommonExtenderPlatform& instance)
-						:m_Platform(instance)
-					{
-					}
-			};
-			kxf::Log::SetActiveTarget(std::make_unique<LogTarget>(*this));
+			kxf::Log::SetActiveTarget(std::make_unique<FrameworkLogTarget>(*this));
 		}
 		else
 		{
@@ -181,23 +302,42 @@ namespace xSE
 			kxf::Log::Enable(false);
 		}
 	}
+	void CommonExtenderPlatform::TerminateLogger()
+	{
+		// The framework log is global to the binary and our target refers to this platform. If another platform
+		// has installed its own target since, that one owns the log now and ours is already gone. The target is
+		// recognized by its platform rather than by address, a new target may have been allocated where ours was.
+		auto target = dynamic_cast<FrameworkLogTarget*>(wxLog::GetActiveTarget());
+		if (target && &target->GetPlatform() == this)
+		{
+			delete wxLog::SetActiveTarget(nullptr);
+		}
+		m_LogStream = nullptr;
+	}
 	bool CommonExtenderPlatform::InitializeModules()
 	{
-		using kxf::NativeAPISet;
-
-		auto& loader = kxf::NativeAPILoader::GetInstance();
-		loader.LoadLibraries
-		({
-			NativeAPISet::NtDLL,
-			NativeAPISet::Kernel32,
-			NativeAPISet::KernelBase,
-			NativeAPISet::User32,
-			NativeAPISet::ShlWAPI,
-			NativeAPISet::DbgHelp
-		});
+		// Framework modules are global to the binary, when several platforms share a process (host-side tools)
+		// only the first one registers them, otherwise every module would be registered and initialized again.
+		static const bool g_Initialized = []()
+		{
+			using kxf::NativeAPISet;
 
-		wxModule::RegisterModules();
-		if (!wxModule::InitializeModules())
+			auto& loader = kxf::NativeAPILoader::GetInstance();
+			loader.LoadLibraries
+			({
+				NativeAPISet::NtDLL,
+				NativeAPISet::Kernel32,
+				NativeAPISet::KernelBase,
+				NativeAPISet::User32,
+				NativeAPISet::ShlWAPI,
+				NativeAPISet::DbgHelp
+			});
+
+			wxModule::RegisterModules();
+			return wxModule::InitializeModules();
+		}();
+
+		if (!g_Initialized)
 		{
 			Log<1>("Initializing framework: failed");
 			return false;
@@ -205,6 +345,201 @@ namespace xSE
 		return true;
 	}
 
+	void CommonExtenderPlatform::InitializeDiagnostics()
+	{
+		const ConfigFile& config = GetServices().Config;
+		if (config.GetBool("Profiler", "Capture"))
+		{
+			if (auto fs = GetPlatformLogsDirectory())
+			{
+				auto interval = std::chrono::milliseconds(config.GetInt("Profiler", "CaptureInterval", 250));
+				if (Profiler::GetInstance().StartCapture(fs->OpenToWrite(m_Plugin->GetName() + ".trace.json"), interval))
+				{
+					Log<1>("Profiler capture started");
+				}
+			}
+		}
+		else if (config.GetBool("Profiler", "Enabled"))
+		{
+			Profiler::GetInstance().Enable();
+			Log<1>("Profiler enabled");
+		}
+
+		if (auto interval = config.GetInt("Metrics", "ReportInterval"); interval > 0)
+		{
+			EnableMetricsReporting(std::chrono::milliseconds(interval));
+		}
+		if (auto interval = config.GetInt("Memory", "ReportInterval"); interval > 0)
+		{
+			MemoryTracker::GetInstance().SetStackSampleInterval(static_cast<size_t>(std::max<int64_t>(config.GetInt("Memory", "StackSampleInterval"), 0)));
+			if (EnableMemoryReporting(std::chrono::milliseconds(interval)))
+			{
+				Log<1>("Memory reporting started");
+			}
+			else if (!MemoryTracker::IsAvailable())
+			{
+				Log<1>("Memory reporting requested but PluginCore was built without 'xSE_MEMORY_TRACKING'");
+			}
+		}
+		if (config.GetBool("Telemetry", "Enabled"))
+		{
+			const size_t capacity = static_cast<size_t>(std::max<int64_t>(config.GetInt("Telemetry", "Capacity", 1024), 0)) * 1024;
+			if (EnableTelemetry(capacity, std::chrono::milliseconds(config.GetInt("Telemetry", "MetricsInterval", 1000))))
+			{
+				Log<1>("Telemetry channel opened");
+			}
+		}
+	}
+
+	void CommonExtenderPlatform::InitializeLocalization()
+	{
+		// Tables are only opened on demand, this just tells the service where to look
+		auto& services = GetServices();
+		services.Localization.SetDataDirectory(GetGameDataDirectoryPath());
+		services.Localization.SetLanguage(services.Config.GetString("Localization", "Language", "English"));
+	}
+
+	bool CommonExtenderPlatform::Bootstrap()
+	{
+		if (!m_BootstrapCalled)
+		{
+			m_BootstrapCalled = true;
+
+			// Nothing is created before this point for a plugin rejected during the query
+			GetServices();
+			InitializeConfig();
+			InitializeLogger();
+
+			// Register modules
+			Log("Initializing framework");
+			m_Bootstrapped = InitializeModules();
+			if (m_Bootstrapped)
+			{
+				InitializeDiagnostics();
+				InitializeLocalization();
+			}
+		}
+		return m_Bootstrapped;
+	}
+	void CommonExtenderPlatform::InitializeFormCache()
+	{
+		#if xSE_HAS_FORM_LOOKUP
+		GetServices().Forms.SetResolver([](uint32_t formID) -> void*
+		{
+			return xSE_LOOKUP_FORM(formID);
+		});
+		#endif
+	}
+	void CommonExtenderPlatform::InitializeMessaging(const void* seInterface)
+	{
+		#if xSE_HAS_MESSAGING_INTERFACE
+		auto se = static_cast<const xSE_Interface*>(seInterface);
+		if (auto messaging = static_cast<xSE_MessagingInterface*>(se->QueryInterface(kInterface_Messaging)))
+		{
+			if (!messaging->RegisterListener(m_PluginHandle, xSE_MESSAGING_SENDER, OnPlatformMessage))
+			{
+				LogPlatform<1>("Couldn't register the message listener, form cache will only be invalidated manually and messages can't be awaited");
+			}
+		}
+		#endif
+	}
+	void CommonExtenderPlatform::LogEarly(const char* message)
+	{
+		if (m_BootstrapCalled)
+		{
+			LogPlatform<1>(message);
+		}
+		else
+		{
+			// No log file yet, and a rejected plugin shouldn't create one
+			#if xSE_HAS_LOG
+			if (m_SEVersion == xSE_PACKED_VERSION)
+			{
+				auto pluginName = m_PluginNameSymbol ? m_PluginNameSymbol.GetString() : std::string_view("xSE PluginCore");
+				xSE_LOG("<%s> %s", pluginName.data(), message);
+			}
+			#endif
+		}
+	}
+
+	void CommonExtenderPlatform::AdvanceFrame(std::optional<std::chrono::microseconds> gameTimeDelta)
+	{
+		using namespace std::chrono;
+
+		// Everything allocated from the frame arena during the previous frame is released here
+		auto& services = GetServices();
+		services.FrameArena.Reset();
+
+		// Nothing has elapsed before the first frame. Without the game's own delta game time follows real time.
+		const auto now = steady_clock::now();
+		const auto realTimeDelta = m_LastFrameTime != steady_clock::time_point() ? duration_cast<microseconds>(now - m_LastFrameTime) : microseconds::zero();
+		m_LastFrameTime = now;
+		services.Timers.Advance(realTimeDelta, gameTimeDelta.value_or(realTimeDelta));
+		services.Coroutines.ResumePending();
+		services.Events.Flush();
+
+		Profiler::GetInstance().MarkFrame();
+	}
+	void CommonExtenderPlatform::WriteLogLine(std::string_view category, const kxf::String& logString, size_t indent)
+	{
+		// Logging alone doesn't create the services
+		Services* services = m_Services.load(std::memory_order_acquire);
+		const bool isTelemetryOpen = services && services->Telemetry.IsOpen();
+		const bool isXSELogCompatible = xSE_HAS_LOG && m_SEVersion == xSE_PACKED_VERSION;
+		if (!m_LogStream && !isTelemetryOpen && !isXSELogCompatible)
+		{
+			return;
+		}
+
+		// The line is assembled as UTF-8 in a pooled buffer and the message is transcoded straight into it, every target
+		// takes its part of the same buffer instead of converting the string again.
+		std::pmr::string line(&GetPoolMemoryResource());
+		line.reserve(UTF8::GetMaxEncodedLength(logString.length()) + category.length() + indent * 4 + 32);
+
+		// Add indent and timestamp
+		line.append(indent * 4, ' ');
+		FormatLogTimestamp(std::back_inserter(line));
+
+		// Add category
+		if (!category.empty())
+		{
+			line += '<';
+			line += category;
+			line += "> ";
+		}
+
+		// Add the message itself
+		const size_t messageOffset = line.size();
+		UTF8::Append(line, logString);
+		const std::string_view message = std::string_view(line).substr(messageOffset);
+
+		// Log to xSE target if supported and compatible
+		#if xSE_HAS_LOG
+		if (isXSELogCompatible)
+		{
+			auto pluginName = m_PluginNameSymbol ? m_PluginNameSymbol.GetString() : std::string_view("xSE PluginCore");
+			xSE_LOG("<%.*s> %.*s", static_cast<int>(pluginName.size()), pluginName.data(), static_cast<int>(message.size()), message.data());
+		}
+		#endif
+
+		if ((m_LogStream || isTelemetryOpen) && !logString.IsEmptyOrWhitespace())
+		{
+			// Publish to the telemetry channel
+			if (isTelemetryOpen)
+			{
+				services->Telemetry.PublishLog(category, message, indent);
+			}
+
+			// Write and flush
+			if (m_LogStream)
+			{
+				line += '\n';
+				m_LogStream->Write(line.data(), line.size());
+				m_LogStream->Flush();
+			}
+		}
+	}
+
 	// IExtenderPlatform
 	xSE::PlatformType CommonExtenderPlatform::GetType() const
 	{
@@ -257,6 +592,11 @@ namespace xSE
 		};
 		return {};
 	}
+	Symbol CommonExtenderPlatform::GetNameSymbol() const
+	{
+		// Interned by 'Initialize', nothing is interned while the DLL's globals are constructed
+		return m_NameSymbol ? m_NameSymbol : SymbolTable::GetInstance().Intern(GetName());
+	}
 	kxf::String CommonExtenderPlatform::GetFullName() const
 	{
 		auto result = GetGameName();
@@ -336,7 +676,7 @@ namespace xSE
 	{
 		if (!IsNull())
 		{
-			return std::make_shared<kxf::ScopedNativeFileSystem>(kxf::NativeFileSystem::GetExecutingModuleRootDirectory() / "Data");
+			return std::make_shared<kxf::ScopedNativeFileSystem>(GetGameDataDirectoryPath());
 		}
 		return nullptr;
 	}
@@ -365,143 +705,327 @@ namespace xSE
 		return nullptr;
 	}
 
-	bool CommonExtenderPlatform::Initialize(std::shared_ptr<IExtenderPlugin> plugin)
+	const ConfigFile& CommonExtenderPlatform::GetConfig() const
 	{
-		if (!m_Plugin)
+		return GetServices().Config;
+	}
+
+	WorkerPool& CommonExtenderPlatform::GetWorkerPool()
+	{
+		return GetServices().Workers;
+	}
+	std::shared_ptr<ArchiveFileSystem> CommonExtenderPlatform::OpenArchive(const kxf::FSPath& path)
+	{
+		if (!IsNull())
 		{
-			m_Plugin = std::move(plugin);
-			if (m_Plugin->QueryInterface(m_EvtHandler))
+			// Relative paths are looked up in the game's data directory, same as the game does it
+			auto archive = std::make_shared<ArchiveFileSystem>(&GetServices().Workers);
+			if (archive->Open(path.IsAbsolute() ? path : GetGameDataDirectoryPath() / path))
 			{
-				InitializeLogger();
-
-				// Register modules
-				Log("Initializing framework");
-				return InitializeModules();
+				return archive;
 			}
-			return false;
 		}
-		return true;
+		return nullptr;
 	}
-	void CommonExtenderPlatform::Terminate()
+	std::shared_ptr<DataFileSystem> CommonExtenderPlatform::OpenDataFileSystem(std::span<const kxf::FSPath> archives)
 	{
-		if (m_Plugin)
+		xSE_MEMORY_SCOPE("DataFileSystem");
+		if (!IsNull())
 		{
-			m_Plugin = nullptr;
+			auto fileSystem = std::make_shared<DataFileSystem>(GetGameDataDirectoryPath());
+			for (const kxf::FSPath& path: archives)
+			{
+				if (auto archive = OpenArchive(path))
+				{
+					fileSystem->AddArchive(std::move(archive));
+				}
+				else
+				{
+					LogPlatform("Couldn't open archive '{}'", path.GetFullPath());
+				}
+			}
+			return fileSystem;
 		}
+		return nullptr;
 	}
 
-	void CommonExtenderPlatform::LogString(const kxf::String& category, kxf::String logString, size_t indent)
+	std::shared_ptr<PluginFile> CommonExtenderPlatform::OpenPluginFile(const kxf::FSPath& path)
 	{
-		// Log to xSE target if supported and compatible
-		#if xSE_HAS_LOG
-		if (m_SEVersion == xSE_PACKED_VERSION)
+		if (IsPluginFileFormatSupported())
 		{
-			auto logStringSE = kxf::Format("<{}>", m_Plugin ? m_Plugin->GetName() : "xSE PluginCore", logString);
-			xSE_LOG("%s", logStringSE.nc_str());
+			auto file = std::make_shared<PluginFile>();
+			if (file->Open(path.IsAbsolute() ? path : GetGameDataDirectoryPath() / path))
+			{
+				return file;
+			}
+		}
+		return nullptr;
+	}
+	size_t CommonExtenderPlatform::ParsePluginFiles(std::span<const kxf::FSPath> paths, const PluginFileVisitor& visitor)
+	{
+		xSE_MEMORY_SCOPE("PluginFile");
+		if (IsPluginFileFormatSupported())
+		{
+			const kxf::FSPath dataDirectory = GetGameDataDirectoryPath();
+
+			std::vector<kxf::FSPath> resolvedPaths;
+			resolvedPaths.reserve(paths.size());
+			for (const kxf::FSPath& path: paths)
+			{
+				resolvedPaths.emplace_back(path.IsAbsolute() ? path : dataDirectory / path);
+			}
+			return PluginFileParser(&GetServices().Workers).Parse(resolvedPaths, visitor);
 		}
+		return 0;
+	}
+
+	ConsoleCommandDispatcher& CommonExtenderPlatform::GetConsoleCommandDispatcher()
+	{
+		return GetServices().Commands;
+	}
+	std::unique_ptr<IScaleformBackend> CommonExtenderPlatform::CreateScaleformBackend(GFxMovieView& movie) const
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		return std::make_unique<GFxScaleformBackend>(movie);
+		#else
+		return nullptr;
 		#endif
+	}
+
+	std::pmr::memory_resource& CommonExtenderPlatform::GetFrameMemoryResource()
+	{
+		return GetServices().FrameArena;
+	}
+	std::pmr::memory_resource& CommonExtenderPlatform::GetPoolMemoryResource()
+	{
+		return GetPooledObjectResource();
+	}
 
-		// Log to our own target
-		if (m_LogStream && !logString.IsEmptyOrWhitespace())
+	MetricsRegistry& CommonExtenderPlatform::GetMetrics()
+	{
+		return GetServices().Metrics;
+	}
+	bool CommonExtenderPlatform::EnableMetricsReporting(std::chrono::milliseconds interval)
+	{
+		auto& metrics = GetServices().Metrics;
+		if (m_Plugin && !metrics.IsReporting())
+		{
+			if (auto fs = GetPlatformLogsDirectory())
+			{
+				return metrics.StartReporting(fs->OpenToWrite(m_Plugin->GetName() + ".metrics.csv"), interval);
+			}
+		}
+		return false;
+	}
+	bool CommonExtenderPlatform::EnableMemoryReporting(std::chrono::milliseconds interval)
+	{
+		auto& tracker = MemoryTracker::GetInstance();
+		if (MemoryTracker::IsAvailable() && m_Plugin && !tracker.IsReporting())
 		{
-			kxf::IO::OutputStreamWriter writer(*m_LogStream);
+			if (auto fs = GetPlatformLogsDirectory())
+			{
+				// Allocation sites are only written when stacks are sampled
+				std::unique_ptr<kxf::IOutputStream> stackStream;
+				if (tracker.GetStackSampleInterval() != 0)
+				{
+					stackStream = fs->OpenToWrite(m_Plugin->GetName() + ".memory.stacks.log");
+				}
 
-			// Add category
-			if (!category.IsEmpty())
+				tracker.SetOwnerName(m_Plugin->GetName().ToUTF8());
+				return tracker.StartReporting(fs->OpenToWrite(m_Plugin->GetName() + ".memory.csv"), std::move(stackStream), interval);
+			}
+		}
+		return false;
+	}
+	bool CommonExtenderPlatform::ExportProfilerTrace()
+	{
+		// Everything already goes to the trace file in capture mode
+		auto& profiler = Profiler::GetInstance();
+		if (m_Plugin && profiler.IsEnabled() && !profiler.IsCapturing())
+		{
+			if (auto fs = GetPlatformLogsDirectory())
 			{
-				logString.Prepend("> ");
-				logString.Prepend(category);
-				logString.Prepend('<');
+				if (auto stream = fs->OpenToWrite(m_Plugin->GetName() + ".trace.json"))
+				{
+					profiler.ExportChromeTrace(*stream);
+					return true;
+				}
 			}
+		}
+		return false;
+	}
 
-			const size_t indentChars = indent * 4;
-			if (indentChars != 0)
+	TelemetryChannel& CommonExtenderPlatform::GetTelemetry()
+	{
+		return GetServices().Telemetry;
+	}
+	bool CommonExtenderPlatform::EnableTelemetry(size_t capacity, std::chrono::milliseconds metricsInterval)
+	{
+		auto& services = GetServices();
+		if (m_Plugin && !services.Telemetry.IsOpen() && services.Telemetry.Open(m_Plugin->GetName(), capacity))
+		{
+			// Metrics are sampled on the main thread from the frame hook
+			if (metricsInterval.count() > 0)
 			{
-				logString.Prepend(' ', indentChars);
+				services.Timers.ScheduleRepeating(TimerClock::RealTime, metricsInterval, [&services]()
+				{
+					for (const MetricValue& value: services.Metrics.GetValues())
+					{
+						services.Telemetry.PublishMetric(value);
+					}
+				});
 			}
+			return true;
+		}
+		return false;
+	}
 
-			// Add timestamp
-			auto timeStamp = kxf::DateTime::Now();
-			kxf::String timeStampFormatted = kxf::Format("[{}:{:0>3}] ", timeStamp.FormatISOCombined(' '), timeStamp.GetMillisecond());
-			if (indentChars != 0)
+	TimerService& CommonExtenderPlatform::GetTimers()
+	{
+		return GetServices().Timers;
+	}
+	CoroutineScheduler& CommonExtenderPlatform::GetCoroutines()
+	{
+		return GetServices().Coroutines;
+	}
+	EventBus& CommonExtenderPlatform::GetEvents()
+	{
+		return GetServices().Events;
+	}
+	FormCache& CommonExtenderPlatform::GetFormCache()
+	{
+		return GetServices().Forms;
+	}
+	LocalizationService& CommonExtenderPlatform::GetLocalization()
+	{
+		return GetServices().Localization;
+	}
+
+	bool CommonExtenderPlatform::Initialize(std::shared_ptr<IExtenderPlugin> plugin)
+	{
+		// Only the minimum needed to answer the query, the rest waits for 'Bootstrap'
+		if (!m_Plugin)
+		{
+			m_Plugin = std::move(plugin);
+			m_NameSymbol = SymbolTable::GetInstance().Intern(GetName());
+			m_PluginNameSymbol = SymbolTable::GetInstance().Intern(m_Plugin->GetName());
+			return m_Plugin->QueryInterface(m_EvtHandler);
+		}
+		return true;
+	}
+	void CommonExtenderPlatform::Terminate()
+	{
+		if (m_Plugin)
+		{
+			// A plugin rejected at query time never created the services
+			Services* services = m_Services.load(std::memory_order_acquire);
+			if (services)
 			{
-				logString.Insert(indentChars, timeStampFormatted);
+				services->Metrics.StopReporting();
 			}
-			else
+			MemoryTracker::GetInstance().StopReporting();
+			Profiler::GetInstance().StopCapture();
+			if (services)
 			{
-				logString.Prepend(timeStampFormatted);
+				services->Workers.Shutdown();
+				services->Coroutines.Clear();
+				services->Events.Clear();
+				services->Timers.Clear();
+				services->Localization.Unload();
+				services->Telemetry.Close();
 			}
+			TerminateLogger();
+			m_Plugin = nullptr;
+		}
+	}
+	void CommonExtenderPlatform::ProcessFrame()
+	{
+		AdvanceFrame({});
+	}
+	void CommonExtenderPlatform::ProcessFrame(std::chrono::microseconds gameTimeDelta)
+	{
+		AdvanceFrame(gameTimeDelta);
+	}
 
-			// Write and flush
-			writer.WriteStringUTF8(logString.Append('\n'));
-			m_LogStream->Flush();
+	void CommonExtenderPlatform::LogString(const kxf::String& category, kxf::String logString, size_t indent)
+	{
+		if (category.IsEmpty())
+		{
+			WriteLogLine({}, logString, indent);
+		}
+		else
+		{
+			std::pmr::string categoryUTF8(&GetPoolMemoryResource());
+			UTF8::Append(categoryUTF8, category);
+			WriteLogLine(categoryUTF8, logString, indent);
 		}
 	}
+	void CommonExtenderPlatform::LogSymbol(Symbol category, kxf::String logString, size_t indent)
+	{
+		WriteLogLine(category.GetString(), logString, indent);
+	}
 
 	// CommonExtenderPlatform
 	bool CommonExtenderPlatform::OnQuery(const void* seInterface, void* pluginInfo)
 	{
-		LogPlatform("[" _CRT_STRINGIZE(xSE_QUERYFUNCTION) "] On query plugin");
+		// The plugin may still be rejected here, so nothing is initialized and nothing is logged to our own log
+		// until all the checks have passed.
 		if (m_QueryCalled)
 		{
-			LogPlatform<1>("OnQuery has already been called");
+			LogEarly("OnQuery has already been called");
 			return false;
 		}
 		m_QueryCalled = true;
 
-		if (!m_Plugin)
+		if (!m_Plugin || !seInterface)
 		{
-			LogPlatform<1>("Plugin is not initialized");
+			LogEarly("Plugin is not initialized");
 			return false;
 		}
 
-		if (seInterface)
-		{
-			LogPlatform<1>("Processing xSE interface");
+		auto se = static_cast<const xSE_Interface*>(seInterface);
+		m_SEVersion = xSE_INTERFACE_VERSION(se);
+		m_SEInterface = seInterface;
 
-			auto se = static_cast<const xSE_Interface*>(seInterface);
-			m_SEVersion = xSE_INTERFACE_VERSION(se);
-			m_SEInterface = seInterface;
-			LogPlatform<1>("xSE runtime version: {}; compiled version: {}", m_SEVersion, static_cast<decltype(m_SEVersion)>(xSE_PACKED_VERSION));
-
-			if (auto info = static_cast<PluginInfo*>(pluginInfo))
-			{
-				LogPlatform<1>("Processing plugin info");
+		if (auto info = static_cast<PluginInfo*>(pluginInfo))
+		{
+			m_PluginName = m_Plugin->GetName();
+			info->infoVersion = PluginInfo::kInfoVersion;
+			info->name = m_PluginName.nc_str();
+			info->version = static_cast<uint32_t>(m_Plugin->GetVersion().ToInteger());
+		}
 
-				m_PluginName = m_Plugin->GetName();
-				info->infoVersion = PluginInfo::kInfoVersion;
-				info->name = m_PluginName.nc_str();
-				info->version = static_cast<uint32_t>(m_Plugin->GetVersion().ToInteger());
-			}
+		auto flags = m_Plugin->GetFlags();
+		if (m_SEVersion != xSE_PACKED_VERSION && !flags.Contains(ExtenderPluginFlag::VersionIndependent))
+		{
+			LogEarly("Runtime xSE version doesn't match the compiled version");
+			return false;
+		}
+		if (se->isEditor && !flags.Contains(ExtenderPluginFlag::AllowEditor))
+		{
+			LogEarly("Loading in editor mode disabled");
+			return false;
+		}
 
-			auto flags = m_Plugin->GetFlags();
-			LogPlatform<1>("Preparing to load plugin");
+		// Accepted, bring up the framework
+		if (!Bootstrap())
+		{
+			return false;
+		}
 
-			if (m_SEVersion == xSE_PACKED_VERSION || flags.Contains(ExtenderPluginFlag::VersionIndependent))
-			{
-				if (flags.Contains(ExtenderPluginFlag::VersionIndependent))
-				{
-					LogPlatform<2>("The plugin reported itself as a version independent");
-				}
-				if (se->isEditor && !flags.Contains(ExtenderPluginFlag::AllowEditor))
-				{
-					LogPlatform<2>("Loading in editor mode disabled");
-					return false;
-				}
+		LogPlatform("[" _CRT_STRINGIZE(xSE_QUERYFUNCTION) "] On query plugin");
+		LogPlatform<1>("xSE runtime version: {}; compiled version: {}", m_SEVersion, static_cast<decltype(m_SEVersion)>(xSE_PACKED_VERSION));
+		if (flags.Contains(ExtenderPluginFlag::VersionIndependent))
+		{
+			LogPlatform<1>("The plugin reported itself as a version independent");
+		}
 
-				m_PluginHandle = se->GetPluginHandle();
-				if (!m_EvtHandler->ProcessEvent(InitializationEvent::EvtQuery))
-				{
-					LogPlatform<2>("The plugin didn't process the query event");
-				}
-				return true;
-			}
-			else
-			{
-				LogPlatform<1>("Runtime xSE version doesn't match the compiled version");
-			}
+		m_PluginHandle = se->GetPluginHandle();
+		if (!m_EvtHandler->ProcessEvent(InitializationEvent::EvtQuery))
+		{
+			LogPlatform<1>("The plugin didn't process the query event");
 		}
-		return false;
+		return true;
 	}
 	bool CommonExtenderPlatform::OnLoad(const void* seInterface)
 	{
@@ -512,6 +1036,11 @@ namespace xSE
 		}
 		#endif
 
+		if (!m_Plugin || !Bootstrap())
+		{
+			return false;
+		}
+
 		LogPlatform("[" _CRT_STRINGIZE(xSE_LOADFUNCTION) "] On load plugin");
 		if (m_LoadCalled)
 		{
@@ -519,7 +1048,9 @@ namespace xSE
 			return false;
 		}
 		m_LoadCalled = true;
-		
+		InitializeFormCache();
+		InitializeMessaging(seInterface);
+
 		if (m_EvtHandler->ProcessEvent(InitializationEvent::EvtLoad))
 		{
 			return true;
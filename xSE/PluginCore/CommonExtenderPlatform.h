@@ -2,10 +2,25 @@
 #include "Framework.hpp"
 #include "PluginCore.h"
 #include "ScriptExtenderDefinesBase.h"
+#include "ConsoleCommandDispatcher.h"
+#include "MemoryResources.h"
+#include "SymbolTable.h"
+#include "MetricsRegistry.h"
+#include "ConfigFile.h"
+#include "WorkerPool.h"
+#include "TimerService.h"
+#include "Coroutine.h"
+#include "EventBus.h"
+#include "TelemetryChannel.h"
+#include "FormCache.h"
+#include "LocalizationService.h"
 
 #include <kxf/IO/IStream.h>
 #include <kxf/EventSystem/IEvtHandler.h>
 #include <kxf/FileSystem/IFileSystem.h>
+#include <optional>
+#include <atomic>
+#include <mutex>
 
 namespace xSE
 {
@@ -13,13 +28,21 @@ namespace xSE
 	{
 		private:
 			PlatformType m_PlatformType = PlatformType::None;
+			Symbol m_NameSymbol;
 			
 			std::shared_ptr<IExtenderPlugin> m_Plugin;
 			std::shared_ptr<kxf::IEvtHandler> m_EvtHandler;
 			std::unique_ptr<kxf::IOutputStream> m_LogStream;
+			std::chrono::steady_clock::time_point m_LastFrameTime;
+
+			// The platform is a DLL-global, its services are only created when first needed
+			struct Services;
+			mutable std::atomic<Services*> m_Services = nullptr;
+			mutable std::mutex m_ServicesLock;
 
 			// xSE info
 			kxf::String m_PluginName;
+			Symbol m_PluginNameSymbol;
 			const void* m_SEInterface = nullptr;
 			uint32_t m_PluginHandle = std::numeric_limits<uint32_t>::max();
 			uint32_t m_SEVersion = 0;
@@ -27,30 +50,55 @@ namespace xSE
 			uint32_t m_EditorVersion = 0;
 			bool m_QueryCalled = false;
 			bool m_LoadCalled = false;
+			bool m_BootstrapCalled = false;
+			bool m_Bootstrapped = false;
 
 		private:
 			bool IsNull() const
 			{
 				return m_PlatformType == PlatformType::None;
 			}
+			bool IsPluginFileFormatSupported() const
+			{
+				// Morrowind and Oblivion plugins use different record headers which 'PluginFile' doesn't read
+				return !IsNull() && m_PlatformType != PlatformType::MWSE && m_PlatformType != PlatformType::OBSE;
+			}
 
 			kxf::String GetPlatformFolderName() const;
 			kxf::FSPath GetGameConfigPath() const;
+			kxf::FSPath GetGameDataDirectoryPath() const;
 			kxf::FSPath GetPlatformDirectoryPath() const;
 
+			void InitializeConfig();
 			void InitializeLogger();
+			void TerminateLogger();
+			void InitializeDiagnostics();
+			void InitializeLocalization();
 			bool InitializeModules();
+			bool Bootstrap();
+			void InitializeFormCache();
+			void InitializeMessaging(const void* seInterface);
+
+			void LogEarly(const char* message);
+
+			Services& GetServices() const;
+
+			void AdvanceFrame(std::optional<std::chrono::microseconds> gameTimeDelta);
+			void WriteLogLine(std::string_view category, const kxf::String& logString, size_t indent);
 
 		public:
 			CommonExtenderPlatform(PlatformType type) noexcept
 				:m_PlatformType(type)
 			{
 			}
+			CommonExtenderPlatform(const CommonExtenderPlatform&) = delete;
+			~CommonExtenderPlatform();
 
 		public:
 			// IExtenderPlatform
 			xSE::PlatformType GetType() const override;
 			kxf::String GetName() const override;
+			Symbol GetNameSymbol() const override;
 			kxf::String GetFullName() const override;
 			kxf::String GetGameName() const override;
 			kxf::Version GetVersion() const override;
@@ -61,10 +109,40 @@ namespace xSE
 			std::shared_ptr<kxf::IFileSystem> GetPlatformPluginsDirectory() const override;
 			std::shared_ptr<kxf::IFileSystem> GetPlatformLogsDirectory() const override;
 
+			const ConfigFile& GetConfig() const override;
+
+			WorkerPool& GetWorkerPool() override;
+			std::shared_ptr<ArchiveFileSystem> OpenArchive(const kxf::FSPath& path) override;
+			std::shared_ptr<DataFileSystem> OpenDataFileSystem(std::span<const kxf::FSPath> archives) override;
+			std::shared_ptr<PluginFile> OpenPluginFile(const kxf::FSPath& path) override;
+			size_t ParsePluginFiles(std::span<const kxf::FSPath> paths, const PluginFileVisitor& visitor) override;
+
+			ConsoleCommandDispatcher& GetConsoleCommandDispatcher() override;
+			std::unique_ptr<IScaleformBackend> CreateScaleformBackend(GFxMovieView& movie) const override;
+
+			std::pmr::memory_resource& GetFrameMemoryResource() override;
+			std::pmr::memory_resource& GetPoolMemoryResource() override;
+
+			MetricsRegistry& GetMetrics() override;
+			bool EnableMetricsReporting(std::chrono::milliseconds interval) override;
+			bool EnableMemoryReporting(std::chrono::milliseconds interval) override;
+			bool ExportProfilerTrace() override;
+			TelemetryChannel& GetTelemetry() override;
+			bool EnableTelemetry(size_t capacity, std::chrono::milliseconds metricsInterval) override;
+
+			TimerService& GetTimers() override;
+			CoroutineScheduler& GetCoroutines() override;
+			EventBus& GetEvents() override;
+			FormCache& GetFormCache() override;
+			LocalizationService& GetLocalization() override;
+
 			bool Initialize(std::shared_ptr<IExtenderPlugin> plugin) override;
 			void Terminate() override;
+			void ProcessFrame() override;
+			void ProcessFrame(std::chrono::microseconds gameTimeDelta) override;
 
 			void LogString(const kxf::String& category, kxf::String logString, size_t indent) override;
+			void LogSymbol(Symbol category, kxf::String logString, size_t indent) override;
 
 		public:
 			// CommonExtenderPlatform
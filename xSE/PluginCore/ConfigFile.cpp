@@ -0,0 +1,143 @@
+#include "pch.hpp"
+#include "ConfigFile.h"
+#include <kxf/IO/IStream.h>
+#include <charconv>
+
+namespace
+{
+	std::string_view Trim(std::string_view value) noexcept
+	{
+		constexpr std::string_view whitespace = " \t\r\n";
+
+		const size_t first = value.find_first_not_of(whitespace);
+		if (first == value.npos)
+		{
+			return {};
+		}
+		return value.substr(first, value.find_last_not_of(whitespace) - first + 1);
+	}
+}
+
+namespace xSE
+{
+	bool ConfigFile::Load(kxf::IInputStream& stream)
+	{
+		std::string content;
+		char buffer[4096];
+		while (stream.Read(buffer, sizeof(buffer)).LastRead().ToBytes() != 0)
+		{
+			content.append(buffer, stream.LastRead().ToBytes<size_t>());
+		}
+		return Load(content);
+	}
+	bool ConfigFile::Load(std::string_view content)
+	{
+		m_Values.clear();
+
+		// Skip UTF-8 BOM
+		if (content.starts_with("\xEF\xBB\xBF"))
+		{
+			content.remove_prefix(3);
+		}
+
+		auto& symbolTable = SymbolTable::GetInstance();
+		Symbol section;
+		while (!content.empty())
+		{
+			const size_t lineEnd = content.find('\n');
+			auto line = Trim(content.substr(0, lineEnd));
+			content.remove_prefix(lineEnd != content.npos ? lineEnd + 1 : content.size());
+
+			if (line.empty() || line.front() == ';' || line.front() == '#')
+			{
+				continue;
+			}
+			else if (line.front() == '[' && line.back() == ']')
+			{
+				section = symbolTable.Intern(Trim(line.substr(1, line.size() - 2)));
+			}
+			else if (size_t separator = line.find('='); separator != line.npos)
+			{
+				auto name = Trim(line.substr(0, separator));
+				auto value = Trim(line.substr(separator + 1));
+				if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+				{
+					value = value.substr(1, value.size() - 2);
+				}
+
+				if (!name.empty())
+				{
+					m_Values.insert_or_assign(Key{section, symbolTable.Intern(name)}, std::string(value));
+				}
+			}
+		}
+		return !m_Values.empty();
+	}
+
+	std::optional<std::string_view> ConfigFile::GetValue(Symbol section, Symbol key) const
+	{
+		if (auto it = m_Values.find(Key{section, key}); it != m_Values.end())
+		{
+			return it->second;
+		}
+		return {};
+	}
+	std::optional<std::string_view> ConfigFile::GetValue(std::string_view section, std::string_view key) const
+	{
+		// Anything not interned yet can't be in the file either
+		auto& symbolTable = SymbolTable::GetInstance();
+		Symbol sectionSymbol = symbolTable.Find(section);
+		Symbol keySymbol = symbolTable.Find(key);
+		if ((sectionSymbol || section.empty()) && keySymbol)
+		{
+			return GetValue(sectionSymbol, keySymbol);
+		}
+		return {};
+	}
+
+	bool ConfigFile::GetBool(std::string_view section, std::string_view key, bool defaultValue) const
+	{
+		if (auto value = GetValue(section, key))
+		{
+			if (*value == "1" || *value == "true" || *value == "True" || *value == "TRUE")
+			{
+				return true;
+			}
+			else if (*value == "0" || *value == "false" || *value == "False" || *value == "FALSE")
+			{
+				return false;
+			}
+		}
+		return defaultValue;
+	}
+	int64_t ConfigFile::GetInt(std::string_view section, std::string_view key, int64_t defaultValue) const
+	{
+		if (auto value = GetValue(section, key))
+		{
+			int64_t result = 0;
+			auto [ptr, ec] = std::from_chars(value->data(), value->data() + value->size(), result);
+			if (ec == std::errc())
+			{
+				return result;
+			}
+		}
+		return defaultValue;
+	}
+	double ConfigFile::GetFloat(std::string_view section, std::string_view key, double defaultValue) const
+	{
+		if (auto value = GetValue(section, key))
+		{
+			double result = 0;
+			auto [ptr, ec] = std::from_chars(value->data(), value->data() + value->size(), result);
+			if (ec == std::errc())
+			{
+				return result;
+			}
+		}
+		return defaultValue;
+	}
+	std::string_view ConfigFile::GetString(std::string_view section, std::string_view key, std::string_view defaultValue) const
+	{
+		return GetValue(section, key).value_or(defaultValue);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "Framework.hpp"
+#include "SymbolTable.h"
+#include <string>
+#include <optional>
+#include <unordered_map>
+
+namespace kxf
+{
+	class IInputStream;
+}
+
+namespace xSE
+{
+	// Read-only INI-style configuration. Sections and keys are case-sensitive and interned, so lookups
+	// by a cached symbol pair don't involve any string comparisons.
+	class xSE_API ConfigFile final
+	{
+		private:
+			struct Key final
+			{
+				Symbol Section;
+				Symbol Name;
+
+				bool operator==(const Key&) const noexcept = default;
+			};
+			struct KeyHash final
+			{
+				size_t operator()(const Key& key) const noexcept
+				{
+					return std::hash<uint64_t>()((static_cast<uint64_t>(key.Section.GetValue()) << 32)|key.Name.GetValue());
+				}
+			};
+
+		private:
+			std::unordered_map<Key, std::string, KeyHash> m_Values;
+
+		public:
+			ConfigFile() = default;
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				return m_Values.empty();
+			}
+			bool Load(kxf::IInputStream& stream);
+			bool Load(std::string_view content);
+
+			std::optional<std::string_view> GetValue(Symbol section, Symbol key) const;
+			std::optional<std::string_view> GetValue(std::string_view section, std::string_view key) const;
+
+			bool GetBool(std::string_view section, std::string_view key, bool defaultValue = false) const;
+			int64_t GetInt(std::string_view section, std::string_view key, int64_t defaultValue = 0) const;
+			double GetFloat(std::string_view section, std::string_view key, double defaultValue = 0) const;
+			std::string_view GetString(std::string_view section, std::string_view key, std::string_view defaultValue = {}) const;
+	};
+}
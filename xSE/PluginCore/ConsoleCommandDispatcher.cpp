@@ -0,0 +1,448 @@
+#include "pch.hpp"
+#include "ConsoleCommandDispatcher.h"
+#include "ScriptExtenderDefinesBase.h"
+#include "ScriptExtenderDefinesExtra.h"
+#include "ScriptExtenderInterfaceIncludes.h"
+#include <charconv>
+#include <algorithm>
+
+namespace
+{
+	constexpr size_t g_KeysPerBucket = 4;
+	constexpr uint32_t g_MaxSeed = 1 << 20;
+
+	constexpr char ToLowerASCII(char c) noexcept
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+	constexpr bool IsSpace(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	constexpr uint32_t HashKey(std::string_view key, uint32_t seed) noexcept
+	{
+		// FNV-1a over the lower-cased key, console commands are case-insensitive
+		uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+		for (char c: key)
+		{
+			hash ^= static_cast<uint8_t>(ToLowerASCII(c));
+			hash *= 16777619u;
+		}
+
+		// Final avalanche so that nearby seeds produce unrelated slots
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+	constexpr bool IsEqualNoCase(std::string_view left, std::string_view right) noexcept
+	{
+		if (left.size() == right.size())
+		{
+			for (size_t i = 0; i < left.size(); i++)
+			{
+				if (ToLowerASCII(left[i]) != ToLowerASCII(right[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		return false;
+	}
+	constexpr bool IsLessNoCase(std::string_view left, std::string_view right) noexcept
+	{
+		return std::ranges::lexicographical_compare(left, right, [](char a, char b)
+		{
+			return ToLowerASCII(a) < ToLowerASCII(b);
+		});
+	}
+
+	std::string_view TrimSpace(std::string_view value) noexcept
+	{
+		while (!value.empty() && IsSpace(value.front()))
+		{
+			value.remove_prefix(1);
+		}
+		while (!value.empty() && IsSpace(value.back()))
+		{
+			value.remove_suffix(1);
+		}
+		return value;
+	}
+	// Returns false when there are no tokens left, a quoted token can be empty
+	bool NextToken(std::string_view& value, std::string_view& token) noexcept
+	{
+		value = TrimSpace(value);
+		if (value.empty())
+		{
+			token = {};
+			return false;
+		}
+
+		if (value.front() == '"')
+		{
+			value.remove_prefix(1);
+
+			size_t end = value.find('"');
+			token = value.substr(0, end);
+			value.remove_prefix(end != value.npos ? end + 1 : value.size());
+		}
+		else
+		{
+			size_t end = std::distance(value.begin(), std::ranges::find_if(value, IsSpace));
+			token = value.substr(0, end);
+			value.remove_prefix(end);
+		}
+		return true;
+	}
+}
+
+namespace xSE
+{
+	std::optional<int64_t> ConsoleCommandArgs::GetInt(size_t index, int base) const noexcept
+	{
+		auto value = GetString(index);
+		if (base == 16 && value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X'))
+		{
+			value.remove_prefix(2);
+		}
+
+		int64_t result = 0;
+		auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result, base);
+		if (ec == std::errc() && ptr == value.data() + value.size() && !value.empty())
+		{
+			return result;
+		}
+		return {};
+	}
+	std::optional<uint32_t> ConsoleCommandArgs::GetFormID(size_t index) const noexcept
+	{
+		// Form IDs are always typed in hex in the console
+		if (auto value = GetInt(index, 16); value && *value >= 0 && *value <= std::numeric_limits<uint32_t>::max())
+		{
+			return static_cast<uint32_t>(*value);
+		}
+		return {};
+	}
+	std::optional<double> ConsoleCommandArgs::GetFloat(size_t index) const noexcept
+	{
+		auto value = GetString(index);
+
+		double result = 0;
+		auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+		if (ec == std::errc() && ptr == value.data() + value.size() && !value.empty())
+		{
+			return result;
+		}
+		return {};
+	}
+	std::optional<bool> ConsoleCommandArgs::GetBool(size_t index) const noexcept
+	{
+		auto value = GetString(index);
+		if (IsEqualNoCase(value, "1") || IsEqualNoCase(value, "true") || IsEqualNoCase(value, "on"))
+		{
+			return true;
+		}
+		else if (IsEqualNoCase(value, "0") || IsEqualNoCase(value, "false") || IsEqualNoCase(value, "off"))
+		{
+			return false;
+		}
+		return {};
+	}
+}
+
+namespace xSE
+{
+	bool ConsoleCommandDispatcher::PerfectHashIndex::Build(std::span<const std::string_view> keys)
+	{
+		Clear();
+		if (keys.empty())
+		{
+			return true;
+		}
+
+		// Duplicate keys can't be placed into distinct slots, reject them before searching for seeds
+		{
+			std::vector<std::string_view> sorted(keys.begin(), keys.end());
+			std::ranges::sort(sorted, IsLessNoCase);
+			if (std::ranges::adjacent_find(sorted, IsEqualNoCase) != sorted.end())
+			{
+				return false;
+			}
+		}
+
+		const size_t keyCount = keys.size();
+		const size_t bucketCount = (keyCount + g_KeysPerBucket - 1) / g_KeysPerBucket;
+
+		std::vector<std::vector<uint32_t>> buckets(bucketCount);
+		for (size_t i = 0; i < keyCount; i++)
+		{
+			buckets[HashKey(keys[i], 0) % bucketCount].push_back(static_cast<uint32_t>(i));
+		}
+
+		// Place the largest buckets first while the table is still mostly empty
+		std::vector<uint32_t> bucketOrder(bucketCount);
+		for (size_t i = 0; i < bucketCount; i++)
+		{
+			bucketOrder[i] = static_cast<uint32_t>(i);
+		}
+		std::ranges::stable_sort(bucketOrder, [&](uint32_t left, uint32_t right)
+		{
+			return buckets[left].size() > buckets[right].size();
+		});
+
+		m_Seeds.resize(bucketCount, 0);
+		m_Slots.resize(keyCount, npos);
+
+		std::vector<uint32_t> placement;
+		for (uint32_t bucketIndex: bucketOrder)
+		{
+			const auto& bucket = buckets[bucketIndex];
+			if (bucket.empty())
+			{
+				continue;
+			}
+
+			bool placed = false;
+			for (uint32_t seed = 1; seed < g_MaxSeed && !placed; seed++)
+			{
+				placement.clear();
+				placed = true;
+
+				for (uint32_t keyIndex: bucket)
+				{
+					uint32_t slot = HashKey(keys[keyIndex], seed) % keyCount;
+					if (m_Slots[slot] != npos || std::ranges::find(placement, slot) != placement.end())
+					{
+						placed = false;
+						break;
+					}
+					placement.push_back(slot);
+				}
+
+				if (placed)
+				{
+					m_Seeds[bucketIndex] = seed;
+					for (size_t i = 0; i < bucket.size(); i++)
+					{
+						m_Slots[placement[i]] = bucket[i];
+					}
+				}
+			}
+
+			if (!placed)
+			{
+				Clear();
+				return false;
+			}
+		}
+		return true;
+	}
+	uint32_t ConsoleCommandDispatcher::PerfectHashIndex::Find(std::string_view key) const noexcept
+	{
+		if (!m_Slots.empty())
+		{
+			uint32_t seed = m_Seeds[HashKey(key, 0) % m_Seeds.size()];
+			return m_Slots[HashKey(key, seed) % m_Slots.size()];
+		}
+		return npos;
+	}
+	void ConsoleCommandDispatcher::PerfectHashIndex::Clear() noexcept
+	{
+		m_Seeds.clear();
+		m_Slots.clear();
+	}
+}
+
+namespace xSE
+{
+	bool ConsoleCommandDispatcher::RebuildIndex()
+	{
+		m_Keys.clear();
+		m_KeyToCommand.clear();
+
+		for (size_t i = 0; i < m_Commands.size(); i++)
+		{
+			const ConsoleCommand& command = m_Commands[i];
+
+			m_Keys.emplace_back(command.Name);
+			m_KeyToCommand.emplace_back(static_cast<uint32_t>(i));
+
+			if (!command.Alias.empty() && !IsEqualNoCase(command.Alias, command.Name))
+			{
+				m_Keys.emplace_back(command.Alias);
+				m_KeyToCommand.emplace_back(static_cast<uint32_t>(i));
+			}
+		}
+		return m_Index.Build(m_Keys);
+	}
+	bool ConsoleCommandDispatcher::BuildGameIndex()
+	{
+		#if xSE_HAS_CONSOLE_COMMAND_INFO
+		m_GameCommands = xSE_CONSOLE_COMMAND_TABLE();
+		if (m_GameCommands)
+		{
+			m_GameKeys.clear();
+			m_GameKeyToCommand.clear();
+
+			auto AddKey = [&](const char* key, size_t index)
+			{
+				if (key && *key)
+				{
+					m_GameKeys.emplace_back(key);
+					m_GameKeyToCommand.emplace_back(static_cast<uint32_t>(index));
+				}
+			};
+			for (size_t i = 0; i < xSE_CONSOLE_COMMAND_COUNT; i++)
+			{
+				AddKey(m_GameCommands[i].longName, i);
+				AddKey(m_GameCommands[i].shortName, i);
+			}
+
+			// The game table has a few commands sharing a short name, the first one wins as it does in the game itself
+			std::vector<uint32_t> order(m_GameKeys.size());
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				order[i] = static_cast<uint32_t>(i);
+			}
+			std::ranges::stable_sort(order, [&](uint32_t left, uint32_t right)
+			{
+				return IsLessNoCase(m_GameKeys[left], m_GameKeys[right]);
+			});
+			auto duplicates = std::ranges::unique(order, [&](uint32_t left, uint32_t right)
+			{
+				return IsEqualNoCase(m_GameKeys[left], m_GameKeys[right]);
+			});
+			order.erase(duplicates.begin(), duplicates.end());
+
+			std::vector<std::string_view> uniqueKeys;
+			std::vector<uint32_t> uniqueKeyToCommand;
+			uniqueKeys.reserve(order.size());
+			uniqueKeyToCommand.reserve(order.size());
+			for (uint32_t index: order)
+			{
+				uniqueKeys.emplace_back(m_GameKeys[index]);
+				uniqueKeyToCommand.emplace_back(m_GameKeyToCommand[index]);
+			}
+			m_GameKeys = std::move(uniqueKeys);
+			m_GameKeyToCommand = std::move(uniqueKeyToCommand);
+
+			return m_GameIndex.Build(m_GameKeys);
+		}
+		#endif
+		return false;
+	}
+
+	bool ConsoleCommandDispatcher::Register(std::span<const ConsoleCommand> commands)
+	{
+		const size_t oldCount = m_Commands.size();
+		for (const ConsoleCommand& command: commands)
+		{
+			if (!command.Name.empty() && command.Handler)
+			{
+				m_Commands.emplace_back(command);
+			}
+		}
+
+		if (!RebuildIndex())
+		{
+			m_Commands.resize(oldCount);
+			RebuildIndex();
+
+			return false;
+		}
+		return true;
+	}
+	bool ConsoleCommandDispatcher::Register(Symbol name, TConsoleCommandHandler handler, void* context, Symbol alias, std::string_view help)
+	{
+		ConsoleCommand command;
+		command.Name = name.GetString();
+		command.Alias = alias.GetString();
+		command.Help = !help.empty() ? SymbolTable::GetInstance().Intern(help).GetString() : std::string_view();
+		command.Handler = handler;
+		command.Context = context;
+
+		return Register({&command, 1});
+	}
+	void ConsoleCommandDispatcher::Clear() noexcept
+	{
+		m_Commands.clear();
+		m_Keys.clear();
+		m_KeyToCommand.clear();
+		m_Index.Clear();
+	}
+
+	const ConsoleCommand* ConsoleCommandDispatcher::Find(std::string_view nameOrAlias) const noexcept
+	{
+		uint32_t index = m_Index.Find(nameOrAlias);
+		if (index != npos && IsEqualNoCase(m_Keys[index], nameOrAlias))
+		{
+			return &m_Commands[m_KeyToCommand[index]];
+		}
+		return nullptr;
+	}
+	ConsoleCommandResult ConsoleCommandDispatcher::Dispatch(std::string_view commandLine) const
+	{
+		std::string_view name;
+		NextToken(commandLine, name);
+		if (const ConsoleCommand* command = Find(name))
+		{
+			return Dispatch(*command, commandLine);
+		}
+		return ConsoleCommandResult::NotFound;
+	}
+	ConsoleCommandResult ConsoleCommandDispatcher::Dispatch(Symbol nameOrAlias, std::string_view arguments) const
+	{
+		if (const ConsoleCommand* command = Find(nameOrAlias))
+		{
+			return Dispatch(*command, arguments);
+		}
+		return ConsoleCommandResult::NotFound;
+	}
+	ConsoleCommandResult ConsoleCommandDispatcher::Dispatch(const ConsoleCommand& command, std::string_view arguments) const
+	{
+		ConsoleCommandArgs args;
+		args.m_Command = &command;
+
+		std::string_view token;
+		while (NextToken(arguments, token))
+		{
+			if (args.m_Count == ConsoleCommandArgs::MaxCount)
+			{
+				return ConsoleCommandResult::TooManyArguments;
+			}
+			args.m_Args[args.m_Count++] = token;
+		}
+		return command.Handler(args, command.Context) ? ConsoleCommandResult::Handled : ConsoleCommandResult::Failed;
+	}
+
+	ObScriptCommand* ConsoleCommandDispatcher::FindGameCommand(std::string_view nameOrAlias)
+	{
+		// The table doesn't change once the game is running, a failed build isn't retried
+		if (!m_GameIndexBuilt)
+		{
+			m_GameIndexBuilt = true;
+			if (!BuildGameIndex())
+			{
+				m_GameIndex.Clear();
+			}
+		}
+		if (m_GameIndex.IsEmpty())
+		{
+			return nullptr;
+		}
+
+		#if xSE_HAS_CONSOLE_COMMAND_INFO
+		uint32_t index = m_GameIndex.Find(nameOrAlias);
+		if (index != npos && IsEqualNoCase(m_GameKeys[index], nameOrAlias))
+		{
+			return &m_GameCommands[m_GameKeyToCommand[index]];
+		}
+		#endif
+		return nullptr;
+	}
+}
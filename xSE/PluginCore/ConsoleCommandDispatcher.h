@@ -0,0 +1,177 @@
+#pragma once
+#include "Framework.hpp"
+#include "SymbolTable.h"
+#include <span>
+#include <array>
+#include <vector>
+#include <optional>
+#include <string_view>
+
+struct ObScriptCommand;
+
+namespace xSE
+{
+	class ConsoleCommandArgs;
+
+	enum class ConsoleCommandResult
+	{
+		Handled,
+		Failed,
+		NotFound,
+		TooManyArguments
+	};
+
+	using TConsoleCommandHandler = bool(*)(const ConsoleCommandArgs& args, void* context);
+
+	struct ConsoleCommand final
+	{
+		std::string_view Name;
+		std::string_view Alias;
+		std::string_view Help;
+		TConsoleCommandHandler Handler = nullptr;
+		void* Context = nullptr;
+	};
+}
+
+namespace xSE
+{
+	class xSE_API ConsoleCommandArgs final
+	{
+		friend class ConsoleCommandDispatcher;
+
+		public:
+			static constexpr size_t MaxCount = 16;
+
+		private:
+			const ConsoleCommand* m_Command = nullptr;
+			std::array<std::string_view, MaxCount> m_Args;
+			size_t m_Count = 0;
+
+		public:
+			ConsoleCommandArgs() noexcept = default;
+
+		public:
+			const ConsoleCommand& GetCommand() const noexcept
+			{
+				return *m_Command;
+			}
+			size_t GetCount() const noexcept
+			{
+				return m_Count;
+			}
+			bool IsEmpty() const noexcept
+			{
+				return m_Count == 0;
+			}
+
+			std::string_view GetString(size_t index) const noexcept
+			{
+				return index < m_Count ? m_Args[index] : std::string_view();
+			}
+			std::optional<int64_t> GetInt(size_t index, int base = 10) const noexcept;
+			std::optional<uint32_t> GetFormID(size_t index) const noexcept;
+			std::optional<double> GetFloat(size_t index) const noexcept;
+			std::optional<bool> GetBool(size_t index) const noexcept;
+
+		public:
+			std::string_view operator[](size_t index) const noexcept
+			{
+				return GetString(index);
+			}
+	};
+}
+
+namespace xSE
+{
+	// Plugin console commands behind a perfect hash index. The dispatcher doesn't hook the game console by itself,
+	// the plugin forwards the command lines it receives to 'Dispatch'. The usual way to receive them is to take over
+	// an unused entry of the game's console command table: look it up with 'FindGameCommand', replace its name and
+	// 'execute' callback (and write the change with the script extender's safe write functions), and pass the text
+	// the console hands to the callback on to 'Dispatch'.
+	class xSE_API ConsoleCommandDispatcher final
+	{
+		private:
+			// Minimal perfect hash built with the hash-and-displace scheme: every key is first assigned
+			// to a bucket and each bucket gets a seed which places all of its keys into distinct free slots.
+			// Lookup is always two hash evaluations and one key comparison regardless of the table size.
+			class PerfectHashIndex final
+			{
+				private:
+					std::vector<uint32_t> m_Seeds;
+					std::vector<uint32_t> m_Slots;
+
+				public:
+					bool IsEmpty() const noexcept
+					{
+						return m_Slots.empty();
+					}
+					bool Build(std::span<const std::string_view> keys);
+					uint32_t Find(std::string_view key) const noexcept;
+					void Clear() noexcept;
+			};
+
+		public:
+			static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+		private:
+			std::vector<ConsoleCommand> m_Commands;
+			std::vector<std::string_view> m_Keys;
+			std::vector<uint32_t> m_KeyToCommand;
+			PerfectHashIndex m_Index;
+
+			ObScriptCommand* m_GameCommands = nullptr;
+			std::vector<std::string_view> m_GameKeys;
+			std::vector<uint32_t> m_GameKeyToCommand;
+			PerfectHashIndex m_GameIndex;
+			bool m_GameIndexBuilt = false;
+
+		private:
+			bool RebuildIndex();
+			bool BuildGameIndex();
+
+		public:
+			ConsoleCommandDispatcher() = default;
+			ConsoleCommandDispatcher(const ConsoleCommandDispatcher&) = delete;
+
+		public:
+			// Adds the commands from a (usually 'constexpr') table and rebuilds the index. Returns false if any
+			// of the names or aliases collides with an already registered one, in which case nothing is added.
+			bool Register(std::span<const ConsoleCommand> commands);
+
+			// Interned strings live as long as the module does, so symbols can be used as names without any storage. The
+			// help text is interned as well, it can be a temporary.
+			bool Register(Symbol name, TConsoleCommandHandler handler, void* context = nullptr, Symbol alias = {}, std::string_view help = {});
+			void Clear() noexcept;
+
+			size_t GetCount() const noexcept
+			{
+				return m_Commands.size();
+			}
+			std::span<const ConsoleCommand> GetCommands() const noexcept
+			{
+				return m_Commands;
+			}
+
+			// The pointer is invalidated by the next 'Register' or 'Clear', don't keep it around
+			const ConsoleCommand* Find(std::string_view nameOrAlias) const noexcept;
+			const ConsoleCommand* Find(Symbol nameOrAlias) const noexcept
+			{
+				return Find(nameOrAlias.GetString());
+			}
+
+			ConsoleCommandResult Dispatch(std::string_view commandLine) const;
+			ConsoleCommandResult Dispatch(const ConsoleCommand& command, std::string_view arguments) const;
+			ConsoleCommandResult Dispatch(Symbol nameOrAlias, std::string_view arguments) const;
+
+			// Looks up a command in the game's own console command table. The index over the table is built on first use.
+			// Always returns null if the current platform doesn't expose the console command table.
+			ObScriptCommand* FindGameCommand(std::string_view nameOrAlias);
+			ObScriptCommand* FindGameCommand(Symbol nameOrAlias)
+			{
+				return FindGameCommand(nameOrAlias.GetString());
+			}
+
+		public:
+			ConsoleCommandDispatcher& operator=(const ConsoleCommandDispatcher&) = delete;
+	};
+}
@@ -0,0 +1,98 @@
+#include "pch.hpp"
+#include "Coroutine.h"
+#include "WorkerPool.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace xSE
+{
+	void CoroutineScheduler::WorkerAwaiter::await_suspend(std::coroutine_handle<> handle)
+	{
+		m_WorkerPool.Post([handle]()
+		{
+			handle.resume();
+		});
+	}
+	void CoroutineScheduler::ReadFileAwaiter::await_suspend(std::coroutine_handle<> handle)
+	{
+		// The awaiter lives in the suspended coroutine's frame, so the worker can write the result straight into it
+		m_Scheduler.m_WorkerPool.Post([this, handle]()
+		{
+			MappedFile file;
+			if (file.Open(m_Path))
+			{
+				auto view = file.GetView();
+				m_Result.emplace(view.begin(), view.end());
+			}
+			m_Scheduler.Post(handle);
+		});
+	}
+	void CoroutineScheduler::MessageAwaiter::await_suspend(std::coroutine_handle<> handle)
+	{
+		std::lock_guard lock(m_Scheduler.m_Lock);
+		m_Scheduler.m_MessageWaiters.push_back({handle, &m_Message});
+	}
+}
+
+namespace xSE
+{
+	void CoroutineScheduler::Post(std::coroutine_handle<> handle)
+	{
+		std::lock_guard lock(m_Lock);
+		m_Pending.push_back(handle);
+	}
+	size_t CoroutineScheduler::GetPendingCount() const noexcept
+	{
+		std::lock_guard lock(m_Lock);
+		return m_Pending.size() + m_MessageWaiters.size();
+	}
+	void CoroutineScheduler::Clear() noexcept
+	{
+		std::lock_guard lock(m_Lock);
+		m_Pending.clear();
+		m_MessageWaiters.clear();
+	}
+
+	void CoroutineScheduler::ResumePending()
+	{
+		xSE_PROFILE_FUNCTION();
+
+		// Whatever the resumed coroutines post goes to the next frame. Both vectors keep their capacity so a steady
+		// number of coroutines per frame doesn't allocate.
+		{
+			std::lock_guard lock(m_Lock);
+			if (m_Pending.empty())
+			{
+				return;
+			}
+			m_Resuming.swap(m_Pending);
+		}
+
+		for (std::coroutine_handle<> handle: m_Resuming)
+		{
+			handle.resume();
+		}
+		m_Resuming.clear();
+	}
+	void CoroutineScheduler::NotifyMessage(const PlatformMessage& message)
+	{
+		// Resumed outside the lock, a coroutine waiting for the same message type again gets the next one instead
+		std::vector<MessageWaiter> waiters;
+		{
+			std::lock_guard lock(m_Lock);
+			auto it = std::stable_partition(m_MessageWaiters.begin(), m_MessageWaiters.end(), [&](const MessageWaiter& waiter)
+			{
+				return waiter.Message->Type != message.Type;
+			});
+			waiters.assign(it, m_MessageWaiters.end());
+			m_MessageWaiters.erase(it, m_MessageWaiters.end());
+		}
+
+		for (const MessageWaiter& waiter: waiters)
+		{
+			*waiter.Message = message;
+			waiter.Handle.resume();
+		}
+	}
+}
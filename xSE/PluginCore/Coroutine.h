@@ -0,0 +1,434 @@
+#pragma once
+#include "Framework.hpp"
+#include "MemoryResources.h"
+#include "TimerService.h"
+#include <kxf/FileSystem/FSPath.h>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+
+namespace xSE
+{
+	class WorkerPool;
+
+	template<class T = void>
+	class Task;
+}
+
+namespace xSE::Private
+{
+	// Coroutine frames are allocated from the small object pools, through the promise's 'operator new'
+	class TaskPromiseBase: public PooledObject<TaskPromiseBase>
+	{
+		public:
+			struct FinalAwaiter final
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				template<class TPromise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) noexcept
+				{
+					TaskPromiseBase& promise = handle.promise();
+					if (promise.m_IsDetached)
+					{
+						handle.destroy();
+						return std::noop_coroutine();
+					}
+					return promise.m_Continuation ? promise.m_Continuation : std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+		public:
+			std::coroutine_handle<> m_Continuation;
+			bool m_IsDetached = false;
+
+		public:
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+			FinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			// Nothing in the framework throws and there's nobody to report to for a detached task
+			void unhandled_exception() const noexcept
+			{
+				std::terminate();
+			}
+	};
+
+	template<class T>
+	class TaskPromise final: public TaskPromiseBase
+	{
+		public:
+			std::optional<T> m_Value;
+
+		public:
+			Task<T> get_return_object() noexcept;
+
+			template<class TValue = T>
+			void return_value(TValue&& value)
+			{
+				m_Value.emplace(std::forward<TValue>(value));
+			}
+			T TakeResult()
+			{
+				return std::move(*m_Value);
+			}
+	};
+
+	template<>
+	class TaskPromise<void> final: public TaskPromiseBase
+	{
+		public:
+			Task<void> get_return_object() noexcept;
+
+			void return_void() const noexcept
+			{
+			}
+			void TakeResult() const noexcept
+			{
+			}
+	};
+}
+
+namespace xSE
+{
+	// Lazily started coroutine. A task runs when it's awaited by another task, resuming the awaiting one when done,
+	// or when 'Start' is called, in which case it runs on its own and frees its frame on completion. Control is
+	// transferred between tasks directly so long chains of awaits don't grow the stack.
+	template<class T>
+	class Task final
+	{
+		public:
+			using promise_type = Private::TaskPromise<T>;
+
+		private:
+			std::coroutine_handle<promise_type> m_Handle;
+
+		public:
+			Task() noexcept = default;
+			explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+				:m_Handle(handle)
+			{
+			}
+			Task(Task&& other) noexcept
+				:m_Handle(std::exchange(other.m_Handle, nullptr))
+			{
+			}
+			Task(const Task&) = delete;
+			~Task()
+			{
+				if (m_Handle)
+				{
+					m_Handle.destroy();
+				}
+			}
+
+		public:
+			bool IsNull() const noexcept
+			{
+				return !m_Handle;
+			}
+			bool IsDone() const noexcept
+			{
+				return m_Handle && m_Handle.done();
+			}
+
+			// Runs the task until its first suspension point, after that it's owned by whatever resumes it
+			void Start() noexcept
+			{
+				if (m_Handle)
+				{
+					auto handle = std::exchange(m_Handle, nullptr);
+					handle.promise().m_IsDetached = true;
+					handle.resume();
+				}
+			}
+
+		public:
+			// A null task (default constructed, moved from or already started) has no result to wait for, awaiting it
+			// is a programming error.
+			auto operator co_await() noexcept
+			{
+				if (!m_Handle)
+				{
+					std::terminate();
+				}
+
+				struct Awaiter final
+				{
+					std::coroutine_handle<promise_type> Handle;
+
+					bool await_ready() const noexcept
+					{
+						return Handle.done();
+					}
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+					{
+						Handle.promise().m_Continuation = continuation;
+						return Handle;
+					}
+					T await_resume()
+					{
+						return Handle.promise().TakeResult();
+					}
+				};
+				return Awaiter{m_Handle};
+			}
+
+			Task& operator=(Task&& other) noexcept
+			{
+				if (this != &other)
+				{
+					if (m_Handle)
+					{
+						m_Handle.destroy();
+					}
+					m_Handle = std::exchange(other.m_Handle, nullptr);
+				}
+				return *this;
+			}
+			Task& operator=(const Task&) = delete;
+	};
+}
+
+namespace xSE::Private
+{
+	template<class T>
+	Task<T> TaskPromise<T>::get_return_object() noexcept
+	{
+		return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+	}
+
+	inline Task<void> TaskPromise<void>::get_return_object() noexcept
+	{
+		return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+	}
+}
+
+namespace xSE
+{
+	// Message from the script extender's messaging interface. The data is only valid until the awaiting coroutine
+	// suspends again or returns.
+	struct PlatformMessage final
+	{
+		uint32_t Type = 0;
+		const void* Data = nullptr;
+		uint32_t DataLength = 0;
+	};
+
+	// Resumes suspended coroutines on the main thread. Coroutines waiting for the next frame, for a worker thread
+	// to finish reading a file or posted from other threads are resumed in one batch by 'ResumePending', which the
+	// platform calls from 'ProcessFrame' after the timers have been advanced. Coroutines waiting for a message are
+	// resumed directly from the message callback, before it returns to the script extender.
+	class xSE_API CoroutineScheduler final
+	{
+		public:
+			class NextFrameAwaiter final
+			{
+				private:
+					CoroutineScheduler& m_Scheduler;
+
+				public:
+					NextFrameAwaiter(CoroutineScheduler& scheduler) noexcept
+						:m_Scheduler(scheduler)
+					{
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+					void await_suspend(std::coroutine_handle<> handle)
+					{
+						m_Scheduler.Post(handle);
+					}
+					void await_resume() const noexcept
+					{
+					}
+			};
+			class WorkerAwaiter final
+			{
+				private:
+					WorkerPool& m_WorkerPool;
+
+				public:
+					WorkerAwaiter(WorkerPool& workerPool) noexcept
+						:m_WorkerPool(workerPool)
+					{
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+					void await_suspend(std::coroutine_handle<> handle);
+					void await_resume() const noexcept
+					{
+					}
+			};
+			class DelayAwaiter final
+			{
+				private:
+					TimerService& m_Timers;
+					std::chrono::milliseconds m_Delay;
+					TimerClock m_Clock;
+
+				public:
+					DelayAwaiter(TimerService& timers, std::chrono::milliseconds delay, TimerClock clock) noexcept
+						:m_Timers(timers), m_Delay(delay), m_Clock(clock)
+					{
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+					void await_suspend(std::coroutine_handle<> handle)
+					{
+						m_Timers.Schedule(m_Clock, m_Delay, [handle]()
+						{
+							handle.resume();
+						});
+					}
+					void await_resume() const noexcept
+					{
+					}
+			};
+			class ReadFileAwaiter final
+			{
+				private:
+					CoroutineScheduler& m_Scheduler;
+					kxf::FSPath m_Path;
+					std::optional<std::vector<std::byte>> m_Result;
+
+				public:
+					ReadFileAwaiter(CoroutineScheduler& scheduler, kxf::FSPath path)
+						:m_Scheduler(scheduler), m_Path(std::move(path))
+					{
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+					void await_suspend(std::coroutine_handle<> handle);
+					std::optional<std::vector<std::byte>> await_resume() noexcept
+					{
+						return std::move(m_Result);
+					}
+			};
+			class MessageAwaiter final
+			{
+				private:
+					CoroutineScheduler& m_Scheduler;
+					PlatformMessage m_Message;
+
+				public:
+					MessageAwaiter(CoroutineScheduler& scheduler, uint32_t type) noexcept
+						:m_Scheduler(scheduler)
+					{
+						m_Message.Type = type;
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+					void await_suspend(std::coroutine_handle<> handle);
+					const PlatformMessage& await_resume() const noexcept
+					{
+						return m_Message;
+					}
+			};
+
+		private:
+			struct MessageWaiter final
+			{
+				std::coroutine_handle<> Handle;
+				PlatformMessage* Message = nullptr;
+			};
+
+		private:
+			WorkerPool& m_WorkerPool;
+			TimerService& m_Timers;
+
+			mutable std::mutex m_Lock;
+			std::vector<std::coroutine_handle<>> m_Pending;
+			std::vector<std::coroutine_handle<>> m_Resuming;
+			std::vector<MessageWaiter> m_MessageWaiters;
+
+		public:
+			CoroutineScheduler(WorkerPool& workerPool, TimerService& timers) noexcept
+				:m_WorkerPool(workerPool), m_Timers(timers)
+			{
+			}
+			CoroutineScheduler(const CoroutineScheduler&) = delete;
+
+		public:
+			// Resumes the coroutine on the main thread during the next frame, can be called from any thread
+			void Post(std::coroutine_handle<> handle);
+			size_t GetPendingCount() const noexcept;
+
+			// Drops everything still waiting without resuming it. The frames are leaked rather than destroyed since
+			// their owners may still be holding the tasks.
+			void Clear() noexcept;
+
+			void ResumePending();
+			void NotifyMessage(const PlatformMessage& message);
+
+		public:
+			// Suspends until the next 'ProcessFrame', coming back to the main thread if the coroutine is on a worker
+			NextFrameAwaiter NextFrame() noexcept
+			{
+				return {*this};
+			}
+
+			// Continues on one of the shared worker threads
+			WorkerAwaiter ResumeOnWorker() noexcept
+			{
+				return {m_WorkerPool};
+			}
+
+			// Continues on the main thread once the timer expires. Timers are main-thread only and so is this one.
+			DelayAwaiter Delay(std::chrono::milliseconds delay, TimerClock clock = TimerClock::RealTime) noexcept
+			{
+				return {m_Timers, delay, clock};
+			}
+
+			// Reads the whole file on a worker thread and continues on the main thread during the next frame,
+			// yields nothing if the file can't be read
+			ReadFileAwaiter ReadFile(kxf::FSPath path)
+			{
+				return {*this, std::move(path)};
+			}
+
+			// Continues when the script extender sends the message, for example 'kMessage_DataLoaded'
+			MessageAwaiter WaitForMessage(uint32_t type) noexcept
+			{
+				return {*this, type};
+			}
+
+		public:
+			CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+	};
+}
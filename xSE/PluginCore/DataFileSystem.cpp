@@ -0,0 +1,440 @@
+#include "pch.hpp"
+#include "DataFileSystem.h"
+#include "DataPath.h"
+#include "UTF8.h"
+#include <kxf/FileSystem/NativeFileSystem.h>
+#include <filesystem>
+#include <algorithm>
+
+namespace
+{
+	using namespace xSE::DataPath;
+
+	template<class TSet>
+	void AddDirectories(TSet& directories, std::string_view directory)
+	{
+		// Parents are always added together with their children so the first known one ends the walk
+		while (!directory.empty() && directories.emplace(directory).second)
+		{
+			directory = GetParent(directory);
+		}
+	}
+
+	std::string ToNormalizedPath(const kxf::FSPath& path)
+	{
+		std::string result = xSE::UTF8::ToString(path.GetFullPath());
+		NormalizeInPlace(result);
+		return result;
+	}
+	std::filesystem::path ToNativePath(const kxf::FSPath& path)
+	{
+		return path.GetFullPath().wc_str();
+	}
+	std::filesystem::path ToNativePath(std::string_view utf8)
+	{
+		return std::u8string(utf8.begin(), utf8.end());
+	}
+}
+
+namespace xSE
+{
+	void DataFileSystem::Resolve() const
+	{
+		TFileMap files;
+		TDirectorySet directories;
+
+		size_t entryCount = 0;
+		for (const auto& archive: m_Archives)
+		{
+			entryCount += archive->GetEntries().size();
+		}
+		files.reserve(entryCount);
+
+		// Archives in load order, later ones replace whatever the earlier ones provided
+		for (const auto& archive: m_Archives)
+		{
+			for (const ArchiveEntry& entry: archive->GetEntries())
+			{
+				std::string path = Normalize(entry.GetPath());
+				AddDirectories(directories, GetParent(path));
+				files.insert_or_assign(std::move(path), DataFileOrigin{archive.get(), &entry});
+			}
+		}
+
+		// Loose files win over everything
+		const std::filesystem::path root = ToNativePath(m_Root);
+		std::error_code error;
+		for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			const auto relativePath = it->path().lexically_relative(root).u8string();
+			std::string path = Normalize({reinterpret_cast<const char*>(relativePath.data()), relativePath.size()});
+
+			std::error_code statusError;
+			if (it->is_directory(statusError))
+			{
+				AddDirectories(directories, path);
+			}
+			else if (it->is_regular_file(statusError))
+			{
+				AddDirectories(directories, GetParent(path));
+				files.insert_or_assign(std::move(path), DataFileOrigin{});
+			}
+		}
+
+		m_Files = std::move(files);
+		m_Directories = std::move(directories);
+	}
+	void DataFileSystem::EnsureResolved() const
+	{
+		if (!m_IsResolved.load(std::memory_order_acquire))
+		{
+			std::unique_lock lock(m_Lock);
+			if (!m_IsResolved.load(std::memory_order_relaxed))
+			{
+				Resolve();
+				m_IsResolved.store(true, std::memory_order_release);
+			}
+		}
+	}
+	std::optional<DataFileOrigin> DataFileSystem::ResolveSingle(std::string_view normalizedPath) const
+	{
+		std::error_code error;
+		if (std::filesystem::is_regular_file(ToNativePath(m_Root) / ToNativePath(normalizedPath), error))
+		{
+			return DataFileOrigin{};
+		}
+
+		std::shared_lock lock(m_Lock);
+		for (auto it = m_Archives.rbegin(); it != m_Archives.rend(); ++it)
+		{
+			if (const ArchiveEntry* entry = (*it)->FindEntry(normalizedPath))
+			{
+				return DataFileOrigin{it->get(), entry};
+			}
+		}
+		return {};
+	}
+
+	std::optional<DataFileOrigin> DataFileSystem::FindOrigin(std::string_view normalizedPath) const
+	{
+		EnsureResolved();
+
+		std::shared_lock lock(m_Lock);
+		if (auto it = m_Files.find(normalizedPath); it != m_Files.end())
+		{
+			return it->second;
+		}
+		return {};
+	}
+	bool DataFileSystem::HasDirectory(std::string_view normalizedPath) const
+	{
+		if (normalizedPath.empty())
+		{
+			return true;
+		}
+		EnsureResolved();
+
+		std::shared_lock lock(m_Lock);
+		return m_Directories.find(normalizedPath) != m_Directories.end();
+	}
+
+	DataFileSystem::DataFileSystem(const kxf::FSPath& root)
+		:m_Root(root), m_LooseFiles(std::make_shared<kxf::ScopedNativeFileSystem>(root))
+	{
+	}
+
+	void DataFileSystem::AddArchive(std::shared_ptr<ArchiveFileSystem> archive)
+	{
+		if (archive && archive->IsOpen())
+		{
+			std::unique_lock lock(m_Lock);
+			m_Archives.emplace_back(std::move(archive));
+			m_IsResolved.store(false, std::memory_order_release);
+		}
+	}
+
+	void DataFileSystem::Invalidate() noexcept
+	{
+		std::unique_lock lock(m_Lock);
+		m_IsResolved.store(false, std::memory_order_release);
+	}
+	void DataFileSystem::Invalidate(const kxf::FSPath& path)
+	{
+		// Nothing to patch if the table is going to be rebuilt anyway
+		if (!m_IsResolved.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		const std::string normalizedPath = ToNormalizedPath(path);
+		auto origin = ResolveSingle(normalizedPath);
+
+		// Directories are only ever added here, removing them needs a full invalidation
+		std::unique_lock lock(m_Lock);
+		if (origin)
+		{
+			AddDirectories(m_Directories, GetParent(normalizedPath));
+			m_Files.insert_or_assign(normalizedPath, *origin);
+		}
+		else
+		{
+			if (auto it = m_Files.find(normalizedPath); it != m_Files.end())
+			{
+				m_Files.erase(it);
+			}
+
+			std::error_code error;
+			if (std::filesystem::is_directory(ToNativePath(m_Root) / ToNativePath(normalizedPath), error))
+			{
+				AddDirectories(m_Directories, normalizedPath);
+			}
+		}
+	}
+
+	std::optional<DataFileOrigin> DataFileSystem::GetOrigin(const kxf::FSPath& path) const
+	{
+		return FindOrigin(ToNormalizedPath(path));
+	}
+	size_t DataFileSystem::GetFileCount() const
+	{
+		EnsureResolved();
+
+		std::shared_lock lock(m_Lock);
+		return m_Files.size();
+	}
+
+	// IFileSystem
+	kxf::FSPath DataFileSystem::ResolvePath(const kxf::FSPath& relativePath) const
+	{
+		if (auto origin = GetOrigin(relativePath); origin && !origin->IsLoose())
+		{
+			return origin->Archive->ResolvePath(relativePath);
+		}
+		return m_LooseFiles->ResolvePath(relativePath);
+	}
+
+	bool DataFileSystem::ItemExist(const kxf::FSPath& path) const
+	{
+		const std::string normalizedPath = ToNormalizedPath(path);
+		return FindOrigin(normalizedPath) || HasDirectory(normalizedPath);
+	}
+	bool DataFileSystem::FileExist(const kxf::FSPath& path) const
+	{
+		return GetOrigin(path).has_value();
+	}
+	bool DataFileSystem::DirectoryExist(const kxf::FSPath& path) const
+	{
+		return HasDirectory(ToNormalizedPath(path));
+	}
+
+	kxf::FileItem DataFileSystem::GetItem(const kxf::FSPath& path) const
+	{
+		const std::string normalizedPath = ToNormalizedPath(path);
+		if (auto origin = FindOrigin(normalizedPath))
+		{
+			return origin->IsLoose() ? m_LooseFiles->GetItem(path) : origin->Archive->GetItem(path);
+		}
+		else if (HasDirectory(normalizedPath))
+		{
+			kxf::FileItem item(path);
+			item.SetAttributes(kxf::FileAttribute::Directory);
+			return item;
+		}
+		return {};
+	}
+	kxf::Enumerator<kxf::FileItem> DataFileSystem::EnumItems(const kxf::FSPath& directory, const kxf::FSPath& query, kxf::FlagSet<kxf::FSActionFlag> flags) const
+	{
+		const std::string normalizedDirectory = ToNormalizedPath(directory);
+		const std::string pattern = query ? xSE::UTF8::ToString(query.GetFullPath()) : std::string("*");
+		const bool recursive = flags.Contains(kxf::FSActionFlag::Recursive);
+
+		// Only collect the matches under the lock, building the items may have to touch the disk
+		std::vector<std::string> directories;
+		std::vector<std::pair<std::string, DataFileOrigin>> files;
+
+		EnsureResolved();
+		{
+			std::shared_lock lock(m_Lock);
+			if (!flags.Contains(kxf::FSActionFlag::LimitToFiles))
+			{
+				for (const std::string& path: m_Directories)
+				{
+					if (IsInDirectory(GetParent(path), normalizedDirectory, recursive) && MatchesWildcard(GetName(path), pattern))
+					{
+						directories.emplace_back(path);
+					}
+				}
+			}
+			if (!flags.Contains(kxf::FSActionFlag::LimitToDirectories))
+			{
+				for (const auto& [path, origin]: m_Files)
+				{
+					if (IsInDirectory(GetParent(path), normalizedDirectory, recursive) && MatchesWildcard(GetName(path), pattern))
+					{
+						files.emplace_back(path, origin);
+					}
+				}
+			}
+		}
+		std::ranges::sort(directories);
+		std::ranges::sort(files, {}, &std::pair<std::string, DataFileOrigin>::first);
+
+		std::vector<kxf::FileItem> items;
+		items.reserve(directories.size() + files.size());
+		for (const std::string& path: directories)
+		{
+			kxf::FileItem& item = items.emplace_back(kxf::FSPath(kxf::String::FromUTF8(path)));
+			item.SetAttributes(kxf::FileAttribute::Directory);
+		}
+		for (const auto& [path, origin]: files)
+		{
+			const kxf::FSPath itemPath(kxf::String::FromUTF8(path));
+			items.emplace_back(origin.IsLoose() ? m_LooseFiles->GetItem(itemPath) : origin.Archive->GetItem(itemPath));
+		}
+
+		const size_t count = items.size();
+		return kxf::Enumerator<kxf::FileItem>([items = std::move(items)](kxf::IEnumerator& enumerator) mutable -> std::optional<kxf::FileItem>
+		{
+			const size_t index = enumerator.GetCurrentStep();
+			if (index < items.size())
+			{
+				return std::move(items[index]);
+			}
+
+			enumerator.TerminateEnumeration();
+			return {};
+		}, count);
+	}
+	bool DataFileSystem::IsDirectoryEmpty(const kxf::FSPath& directory) const
+	{
+		const std::string normalizedDirectory = ToNormalizedPath(directory);
+		if (!HasDirectory(normalizedDirectory))
+		{
+			return true;
+		}
+
+		// The root is known without resolving anything, its contents aren't
+		EnsureResolved();
+		std::shared_lock lock(m_Lock);
+		return std::ranges::none_of(m_Files, [&](const auto& item)
+		{
+			return IsInDirectory(GetParent(item.first), normalizedDirectory, false);
+		}) && std::ranges::none_of(m_Directories, [&](const std::string& path)
+		{
+			return IsInDirectory(GetParent(path), normalizedDirectory, false);
+		});
+	}
+
+	bool DataFileSystem::CreateDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags)
+	{
+		if (m_LooseFiles->CreateDirectory(path, flags))
+		{
+			Invalidate(path);
+			return true;
+		}
+		return false;
+	}
+	bool DataFileSystem::ChangeAttributes(const kxf::FSPath& path, kxf::FlagSet<kxf::FileAttribute> attributes)
+	{
+		return m_LooseFiles->ChangeAttributes(path, attributes);
+	}
+	bool DataFileSystem::ChangeTimestamp(const kxf::FSPath& path, kxf::DateTime creationTime, kxf::DateTime modificationTime, kxf::DateTime lastAccessTime)
+	{
+		return m_LooseFiles->ChangeTimestamp(path, creationTime, modificationTime, lastAccessTime);
+	}
+
+	bool DataFileSystem::CopyItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func, kxf::FlagSet<kxf::FSActionFlag> flags)
+	{
+		if (m_LooseFiles->CopyItem(source, destination, std::move(func), flags))
+		{
+			Invalidate(destination);
+			return true;
+		}
+		return false;
+	}
+	bool DataFileSystem::MoveItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func, kxf::FlagSet<kxf::FSActionFlag> flags)
+	{
+		// Moving a directory changes everything below it
+		const bool isDirectory = DirectoryExist(source);
+		if (m_LooseFiles->MoveItem(source, destination, std::move(func), flags))
+		{
+			if (isDirectory)
+			{
+				Invalidate();
+			}
+			else
+			{
+				Invalidate(source);
+				Invalidate(destination);
+			}
+			return true;
+		}
+		return false;
+	}
+	bool DataFileSystem::RenameItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::FlagSet<kxf::FSActionFlag> flags)
+	{
+		const bool isDirectory = DirectoryExist(source);
+		if (m_LooseFiles->RenameItem(source, destination, flags))
+		{
+			if (isDirectory)
+			{
+				Invalidate();
+			}
+			else
+			{
+				Invalidate(source);
+				Invalidate(destination);
+			}
+			return true;
+		}
+		return false;
+	}
+	bool DataFileSystem::RemoveItem(const kxf::FSPath& path)
+	{
+		if (m_LooseFiles->RemoveItem(path))
+		{
+			Invalidate(path);
+			return true;
+		}
+		return false;
+	}
+	bool DataFileSystem::RemoveDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags)
+	{
+		if (m_LooseFiles->RemoveDirectory(path, flags))
+		{
+			Invalidate();
+			return true;
+		}
+		return false;
+	}
+
+	std::unique_ptr<kxf::IStream> DataFileSystem::GetStream(const kxf::FSPath& path,
+															kxf::FlagSet<kxf::IOStreamAccess> access,
+															kxf::IOStreamDisposition disposition,
+															kxf::FlagSet<kxf::IOStreamShare> share,
+															kxf::FlagSet<kxf::IOStreamFlag> streamFlags,
+															kxf::FlagSet<kxf::FSActionFlag> flags
+	)
+	{
+		// Anything that may create or modify a file goes to the loose files
+		if (access.Contains(kxf::IOStreamAccess::Write) || disposition != kxf::IOStreamDisposition::OpenExisting)
+		{
+			auto stream = m_LooseFiles->GetStream(path, access, disposition, share, streamFlags, flags);
+			if (stream)
+			{
+				Invalidate(path);
+			}
+			return stream;
+		}
+
+		if (auto origin = GetOrigin(path))
+		{
+			if (origin->IsLoose())
+			{
+				return m_LooseFiles->GetStream(path, access, disposition, share, streamFlags, flags);
+			}
+			return origin->Archive->GetStream(path, access, disposition, share, streamFlags, flags);
+		}
+		return nullptr;
+	}
+}
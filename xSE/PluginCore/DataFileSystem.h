@@ -0,0 +1,141 @@
+#pragma once
+#include "Framework.hpp"
+#include "ArchiveFileSystem.h"
+#include <kxf/FileSystem/IFileSystem.h>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <optional>
+
+namespace xSE
+{
+	// Where the copy of a file the game will use comes from
+	struct DataFileOrigin final
+	{
+		// Both are null for loose files
+		ArchiveFileSystem* Archive = nullptr;
+		const ArchiveEntry* Entry = nullptr;
+
+		bool IsLoose() const noexcept
+		{
+			return Archive == nullptr;
+		}
+	};
+}
+
+namespace xSE
+{
+	// Merged view of the game's Data directory: loose files on top of the archives, archives added later override the
+	// earlier ones, same as the game resolves them. The winner for every path is resolved once into a flat table so
+	// lookups are a single hash probe. Changes on disk aren't tracked, call 'Invalidate' after files are added or removed.
+	// Writes go to the loose files and invalidate the affected path.
+	class xSE_API DataFileSystem final: public kxf::RTTI::Implementation<DataFileSystem, kxf::IFileSystem>
+	{
+		private:
+			struct PathHash final
+			{
+				using is_transparent = void;
+
+				size_t operator()(std::string_view path) const noexcept
+				{
+					return std::hash<std::string_view>()(path);
+				}
+			};
+			using TFileMap = std::unordered_map<std::string, DataFileOrigin, PathHash, std::equal_to<>>;
+			using TDirectorySet = std::unordered_set<std::string, PathHash, std::equal_to<>>;
+
+		private:
+			kxf::FSPath m_Root;
+			std::shared_ptr<kxf::IFileSystem> m_LooseFiles;
+			std::vector<std::shared_ptr<ArchiveFileSystem>> m_Archives;
+
+			mutable std::shared_mutex m_Lock;
+			mutable std::atomic<bool> m_IsResolved = false;
+			mutable TFileMap m_Files;
+			mutable TDirectorySet m_Directories;
+
+		private:
+			void Resolve() const;
+			void EnsureResolved() const;
+			std::optional<DataFileOrigin> ResolveSingle(std::string_view normalizedPath) const;
+
+			std::optional<DataFileOrigin> FindOrigin(std::string_view normalizedPath) const;
+			bool HasDirectory(std::string_view normalizedPath) const;
+
+		public:
+			DataFileSystem(const kxf::FSPath& root);
+			DataFileSystem(const DataFileSystem&) = delete;
+
+		public:
+			// Archives are expected in load order, later ones override earlier ones
+			void AddArchive(std::shared_ptr<ArchiveFileSystem> archive);
+			std::span<const std::shared_ptr<ArchiveFileSystem>> GetArchives() const noexcept
+			{
+				return m_Archives;
+			}
+
+			// Drops the whole table, it's rebuilt on the next lookup
+			void Invalidate() noexcept;
+
+			// Re-resolves a single path after a loose file was added, replaced or removed
+			void Invalidate(const kxf::FSPath& path);
+
+			std::optional<DataFileOrigin> GetOrigin(const kxf::FSPath& path) const;
+			size_t GetFileCount() const;
+
+		public:
+			// IFileSystem
+			bool IsNull() const override
+			{
+				return !m_LooseFiles || m_LooseFiles->IsNull();
+			}
+			bool IsValidPathName(const kxf::FSPath& path) const override
+			{
+				return m_LooseFiles->IsValidPathName(path);
+			}
+			kxf::String GetForbiddenPathNameCharacters(const kxf::String& except = {}) const override
+			{
+				return m_LooseFiles->GetForbiddenPathNameCharacters(except);
+			}
+
+			bool IsLookupScoped() const override
+			{
+				return true;
+			}
+			kxf::FSPath ResolvePath(const kxf::FSPath& relativePath) const override;
+			kxf::FSPath GetLookupDirectory() const override
+			{
+				return m_Root;
+			}
+
+			bool ItemExist(const kxf::FSPath& path) const override;
+			bool FileExist(const kxf::FSPath& path) const override;
+			bool DirectoryExist(const kxf::FSPath& path) const override;
+
+			kxf::FileItem GetItem(const kxf::FSPath& path) const override;
+			kxf::Enumerator<kxf::FileItem> EnumItems(const kxf::FSPath& directory, const kxf::FSPath& query = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) const override;
+			bool IsDirectoryEmpty(const kxf::FSPath& directory) const override;
+
+			bool CreateDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override;
+			bool ChangeAttributes(const kxf::FSPath& path, kxf::FlagSet<kxf::FileAttribute> attributes) override;
+			bool ChangeTimestamp(const kxf::FSPath& path, kxf::DateTime creationTime, kxf::DateTime modificationTime, kxf::DateTime lastAccessTime) override;
+
+			bool CopyItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override;
+			bool MoveItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::IFileSystem::TCopyItemFunc func = {}, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override;
+			bool RenameItem(const kxf::FSPath& source, const kxf::FSPath& destination, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override;
+			bool RemoveItem(const kxf::FSPath& path) override;
+			bool RemoveDirectory(const kxf::FSPath& path, kxf::FlagSet<kxf::FSActionFlag> flags = {}) override;
+
+			std::unique_ptr<kxf::IStream> GetStream(const kxf::FSPath& path,
+													kxf::FlagSet<kxf::IOStreamAccess> access,
+													kxf::IOStreamDisposition disposition,
+													kxf::FlagSet<kxf::IOStreamShare> share = kxf::IOStreamShare::Read,
+													kxf::FlagSet<kxf::IOStreamFlag> streamFlags = kxf::IOStreamFlag::None,
+													kxf::FlagSet<kxf::FSActionFlag> flags = {}
+			) override;
+
+		public:
+			DataFileSystem& operator=(const DataFileSystem&) = delete;
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Path handling shared by the Data file systems. Game paths are case-insensitive ASCII with either separator,
+// the canonical form is lowercase with backslashes and without leading or trailing separators.
+namespace xSE::DataPath
+{
+	constexpr char NormalizeChar(char c) noexcept
+	{
+		if (c == '/')
+		{
+			return '\\';
+		}
+		else if (c >= 'A' && c <= 'Z')
+		{
+			return c - 'A' + 'a';
+		}
+		return c;
+	}
+	inline bool IsNormalized(std::string_view path) noexcept
+	{
+		for (char c: path)
+		{
+			if (NormalizeChar(c) != c)
+			{
+				return false;
+			}
+		}
+		return !path.starts_with('\\') && !path.ends_with('\\');
+	}
+	inline std::string Normalize(std::string_view path)
+	{
+		while (!path.empty() && (path.front() == '\\' || path.front() == '/'))
+		{
+			path.remove_prefix(1);
+		}
+		while (!path.empty() && (path.back() == '\\' || path.back() == '/'))
+		{
+			path.remove_suffix(1);
+		}
+
+		std::string result;
+		result.reserve(path.size());
+		for (char c: path)
+		{
+			result += NormalizeChar(c);
+		}
+		return result;
+	}
+
+	// Same as 'Normalize' but for a buffer the caller owns anyway, saves the copy
+	inline void NormalizeInPlace(std::string& path)
+	{
+		size_t begin = 0;
+		size_t end = path.size();
+		while (begin < end && (path[begin] == '\\' || path[begin] == '/'))
+		{
+			begin++;
+		}
+		while (end > begin && (path[end - 1] == '\\' || path[end - 1] == '/'))
+		{
+			end--;
+		}
+		path.erase(end);
+		path.erase(0, begin);
+
+		for (char& c: path)
+		{
+			c = NormalizeChar(c);
+		}
+	}
+
+	// Compares an arbitrary path against one in canonical form
+	inline bool EqualsNormalized(std::string_view value, std::string_view normalized) noexcept
+	{
+		if (value.size() != normalized.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < value.size(); i++)
+		{
+			if (NormalizeChar(value[i]) != normalized[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Supports '*' and '?', case-insensitive
+	inline bool MatchesWildcard(std::string_view value, std::string_view pattern) noexcept
+	{
+		size_t v = 0;
+		size_t p = 0;
+		size_t starPattern = std::string_view::npos;
+		size_t starValue = 0;
+
+		while (v < value.size())
+		{
+			if (p < pattern.size() && (pattern[p] == '?' || NormalizeChar(pattern[p]) == NormalizeChar(value[v])))
+			{
+				v++;
+				p++;
+			}
+			else if (p < pattern.size() && pattern[p] == '*')
+			{
+				starPattern = p++;
+				starValue = v;
+			}
+			else if (starPattern != std::string_view::npos)
+			{
+				p = starPattern + 1;
+				v = ++starValue;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		while (p < pattern.size() && pattern[p] == '*')
+		{
+			p++;
+		}
+		return p == pattern.size();
+	}
+
+	// Checks whether 'directory' is 'normalizedParent' itself or, if recursive, anything below it
+	inline bool IsInDirectory(std::string_view directory, std::string_view normalizedParent, bool recursive) noexcept
+	{
+		if (normalizedParent.empty())
+		{
+			return recursive || directory.empty();
+		}
+		else if (EqualsNormalized(directory, normalizedParent))
+		{
+			return true;
+		}
+		else if (recursive && directory.size() > normalizedParent.size() && NormalizeChar(directory[normalizedParent.size()]) == '\\')
+		{
+			return EqualsNormalized(directory.substr(0, normalizedParent.size()), normalizedParent);
+		}
+		return false;
+	}
+
+	inline std::string_view GetParent(std::string_view path) noexcept
+	{
+		if (size_t pos = path.find_last_of("\\/"); pos != path.npos)
+		{
+			return path.substr(0, pos);
+		}
+		return {};
+	}
+	inline std::string_view GetName(std::string_view path) noexcept
+	{
+		if (size_t pos = path.find_last_of("\\/"); pos != path.npos)
+		{
+			return path.substr(pos + 1);
+		}
+		return path;
+	}
+}
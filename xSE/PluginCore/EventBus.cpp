@@ -0,0 +1,89 @@
+#include "pch.hpp"
+#include "EventBus.h"
+#include "Profiler.h"
+
+namespace xSE::Private
+{
+	uint32_t AllocateEventType() noexcept
+	{
+		static std::atomic<uint32_t> g_NextType = 0;
+
+		// Event types are a compile-time set, running out of them is a build configuration problem
+		const uint32_t type = g_NextType.fetch_add(1, std::memory_order_relaxed);
+		if (type >= EventBus::MaxEventTypes)
+		{
+			std::terminate();
+		}
+		return type;
+	}
+}
+
+namespace xSE
+{
+	Private::EventChannelBase* EventBus::CreateChannel(uint32_t type, std::unique_ptr<Private::EventChannelBase> channel)
+	{
+		std::lock_guard lock(m_Lock);
+
+		// Another thread may have queued the first event of this type in the meantime
+		if (auto existing = m_Channels[type].load(std::memory_order_acquire))
+		{
+			return existing;
+		}
+
+		auto result = m_ChannelStorage.emplace_back(std::move(channel)).get();
+		m_Channels[type].store(result, std::memory_order_release);
+		return result;
+	}
+
+	bool EventBus::Unsubscribe(EventSubscription subscription) noexcept
+	{
+		if (!subscription.IsNull() && subscription.Type < MaxEventTypes)
+		{
+			if (auto channel = m_Channels[subscription.Type].load(std::memory_order_acquire))
+			{
+				return channel->Unsubscribe(subscription.ID);
+			}
+		}
+		return false;
+	}
+
+	void EventBus::Flush()
+	{
+		xSE_PROFILE_FUNCTION();
+
+		// A handler flushing again would change the list being iterated, its events wait for the next frame instead
+		if (m_IsFlushing)
+		{
+			return;
+		}
+		m_IsFlushing = true;
+
+		// Whatever the handlers queue goes to the next frame. The channels keep their queue capacity, as does the
+		// list of channels to flush.
+		{
+			std::lock_guard lock(m_Lock);
+			for (const auto& channel: m_ChannelStorage)
+			{
+				if (channel->BeginFlush())
+				{
+					m_Flushing.push_back(channel.get());
+				}
+			}
+		}
+
+		for (Private::EventChannelBase* channel: m_Flushing)
+		{
+			channel->Flush();
+		}
+		m_Flushing.clear();
+		m_IsFlushing = false;
+	}
+	void EventBus::Clear() noexcept
+	{
+		std::lock_guard lock(m_Lock);
+		for (const auto& channel: m_ChannelStorage)
+		{
+			channel->Clear();
+		}
+	}
+}
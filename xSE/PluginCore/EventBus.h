@@ -0,0 +1,320 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+namespace xSE
+{
+	struct EventSubscription final
+	{
+		uint32_t Type = 0;
+		uint32_t ID = 0;
+
+		bool IsNull() const noexcept
+		{
+			return ID == 0;
+		}
+		bool operator==(const EventSubscription&) const noexcept = default;
+	};
+}
+
+namespace xSE::Private
+{
+	class EventChannelBase
+	{
+		public:
+			virtual ~EventChannelBase() = default;
+
+		public:
+			// Moves the queued events aside under the bus lock, returns false if there are none
+			virtual bool BeginFlush() = 0;
+			virtual void Flush() = 0;
+
+			virtual bool Unsubscribe(uint32_t id) noexcept = 0;
+			virtual void Clear() noexcept = 0;
+	};
+
+	template<class TEvent>
+	class EventChannel final: public EventChannelBase
+	{
+		public:
+			using TInvoke = void(*)(void* context, const TEvent& event);
+
+		private:
+			struct Subscriber final
+			{
+				TInvoke Invoke = nullptr;
+				void* Context = nullptr;
+				uint32_t ID = 0;
+			};
+
+		private:
+			std::vector<Subscriber> m_Subscribers;
+			std::vector<TEvent> m_Queued;
+			std::vector<TEvent> m_Flushing;
+			size_t m_DispatchDepth = 0;
+			bool m_HasRemoved = false;
+			bool m_IsFlushing = false;
+
+		private:
+			void Compact() noexcept
+			{
+				std::erase_if(m_Subscribers, [](const Subscriber& subscriber)
+				{
+					return subscriber.Invoke == nullptr;
+				});
+				m_HasRemoved = false;
+			}
+
+		public:
+			void Subscribe(TInvoke invoke, void* context, uint32_t id)
+			{
+				m_Subscribers.push_back({invoke, context, id});
+			}
+			size_t GetSubscriberCount() const noexcept
+			{
+				return m_Subscribers.size();
+			}
+
+			void Publish(const TEvent& event)
+			{
+				// Subscribers added by a handler only see the next event and the removed ones are skipped, so the
+				// array is indexed rather than iterated and compacted once the outermost dispatch is done.
+				m_DispatchDepth++;
+				const size_t count = m_Subscribers.size();
+				for (size_t i = 0; i < count; i++)
+				{
+					const Subscriber subscriber = m_Subscribers[i];
+					if (subscriber.Invoke)
+					{
+						subscriber.Invoke(subscriber.Context, event);
+					}
+				}
+
+				if (--m_DispatchDepth == 0 && m_HasRemoved)
+				{
+					Compact();
+				}
+			}
+			template<class... Args>
+			void Enqueue(Args&&... args)
+			{
+				m_Queued.emplace_back(std::forward<Args>(args)...);
+			}
+
+		public:
+			// EventChannelBase
+			bool BeginFlush() override
+			{
+				// The batch being delivered mustn't be swapped out from under it
+				if (m_IsFlushing || m_Queued.empty())
+				{
+					return false;
+				}
+				m_Flushing.swap(m_Queued);
+				return true;
+			}
+			void Flush() override
+			{
+				if (!m_IsFlushing)
+				{
+					m_IsFlushing = true;
+					for (const TEvent& event: m_Flushing)
+					{
+						Publish(event);
+					}
+					m_Flushing.clear();
+					m_IsFlushing = false;
+				}
+			}
+
+			bool Unsubscribe(uint32_t id) noexcept override
+			{
+				for (Subscriber& subscriber: m_Subscribers)
+				{
+					if (subscriber.ID == id && subscriber.Invoke)
+					{
+						subscriber.Invoke = nullptr;
+						m_HasRemoved = true;
+						if (m_DispatchDepth == 0)
+						{
+							Compact();
+						}
+						return true;
+					}
+				}
+				return false;
+			}
+			void Clear() noexcept override
+			{
+				for (Subscriber& subscriber: m_Subscribers)
+				{
+					subscriber.Invoke = nullptr;
+				}
+				m_HasRemoved = true;
+				if (m_DispatchDepth == 0)
+				{
+					Compact();
+				}
+				m_Queued.clear();
+			}
+	};
+
+	template<class T>
+	struct MemberFunctionTraits;
+
+	template<class TObject, class TEvent>
+	struct MemberFunctionTraits<void(TObject::*)(const TEvent&)> final
+	{
+		using TClass = TObject;
+		using TEventType = TEvent;
+	};
+
+	template<class TObject, class TEvent>
+	struct MemberFunctionTraits<void(TObject::*)(const TEvent&) noexcept> final
+	{
+		using TClass = TObject;
+		using TEventType = TEvent;
+	};
+
+	template<class TObject, class TEvent>
+	struct MemberFunctionTraits<void(TObject::*)(const TEvent&) const> final
+	{
+		using TClass = const TObject;
+		using TEventType = TEvent;
+	};
+
+	template<class TObject, class TEvent>
+	struct MemberFunctionTraits<void(TObject::*)(const TEvent&) const noexcept> final
+	{
+		using TClass = const TObject;
+		using TEventType = TEvent;
+	};
+
+	xSE_API uint32_t AllocateEventType() noexcept;
+
+	template<class TEvent>
+	uint32_t GetEventType() noexcept
+	{
+		static const uint32_t type = AllocateEventType();
+		return type;
+	}
+}
+
+namespace xSE
+{
+	// Typed publish/subscribe for high-frequency gameplay events such as hits, equips or cell changes. Any copyable
+	// struct is an event type, each type has its own channel with a contiguous array of subscribers which are plain
+	// function pointers with a context, the member function ones are bound at compile time through a thunk. Events
+	// are either published immediately or queued and delivered in one batch per type by 'Flush', which the platform
+	// calls from 'ProcessFrame' after the coroutines have been resumed. Queued events are stored by value in arrays
+	// reused from frame to frame, so a steady event rate doesn't allocate.
+	// Subscribing, publishing and flushing are main-thread only, queueing can be done from any thread. Lifecycle
+	// events still go through the plugin's 'IEvtHandler'.
+	class xSE_API EventBus final
+	{
+		public:
+			static constexpr size_t MaxEventTypes = 256;
+
+		private:
+			std::array<std::atomic<Private::EventChannelBase*>, MaxEventTypes> m_Channels = {};
+			std::vector<std::unique_ptr<Private::EventChannelBase>> m_ChannelStorage;
+			std::vector<Private::EventChannelBase*> m_Flushing;
+			std::mutex m_Lock;
+			uint32_t m_NextSubscriptionID = 1;
+			bool m_IsFlushing = false;
+
+		private:
+			Private::EventChannelBase* CreateChannel(uint32_t type, std::unique_ptr<Private::EventChannelBase> channel);
+
+			template<class TEvent>
+			Private::EventChannel<TEvent>& GetChannel()
+			{
+				const uint32_t type = Private::GetEventType<TEvent>();
+				if (auto channel = m_Channels[type].load(std::memory_order_acquire))
+				{
+					return static_cast<Private::EventChannel<TEvent>&>(*channel);
+				}
+				return static_cast<Private::EventChannel<TEvent>&>(*CreateChannel(type, std::make_unique<Private::EventChannel<TEvent>>()));
+			}
+
+			template<class TEvent>
+			EventSubscription SubscribeThunk(typename Private::EventChannel<TEvent>::TInvoke invoke, void* context)
+			{
+				EventSubscription subscription;
+				subscription.Type = Private::GetEventType<TEvent>();
+				subscription.ID = m_NextSubscriptionID++;
+
+				GetChannel<TEvent>().Subscribe(invoke, context, subscription.ID);
+				return subscription;
+			}
+
+		public:
+			EventBus() = default;
+			EventBus(const EventBus&) = delete;
+
+		public:
+			template<class TEvent>
+			EventSubscription Subscribe(void(*function)(const TEvent&))
+			{
+				return SubscribeThunk<TEvent>([](void* context, const TEvent& event)
+				{
+					reinterpret_cast<void(*)(const TEvent&)>(context)(event);
+				}, reinterpret_cast<void*>(function));
+			}
+
+			// The object isn't owned and has to be unsubscribed before it's destroyed, for example:
+			// 'bus.Subscribe<&MyPlugin::OnHit>(*this)'
+			template<auto method, class TObject = typename Private::MemberFunctionTraits<decltype(method)>::TClass>
+			EventSubscription Subscribe(TObject& object)
+			{
+				using TEvent = typename Private::MemberFunctionTraits<decltype(method)>::TEventType;
+
+				return SubscribeThunk<TEvent>([](void* context, const TEvent& event)
+				{
+					(static_cast<TObject*>(context)->*method)(event);
+				}, const_cast<std::remove_const_t<TObject>*>(&object));
+			}
+
+			// Safe to call from a handler, including the one being removed
+			bool Unsubscribe(EventSubscription subscription) noexcept;
+
+			template<class TEvent>
+			size_t GetSubscriberCount()
+			{
+				return GetChannel<TEvent>().GetSubscriberCount();
+			}
+
+			// Delivers the event to the current subscribers before returning
+			template<class TEvent>
+			void Publish(const TEvent& event)
+			{
+				GetChannel<TEvent>().Publish(event);
+			}
+
+			// Delivers the event during the next 'Flush', can be called from any thread
+			template<class TEvent>
+			void Enqueue(TEvent&& event)
+			{
+				using T = std::remove_cvref_t<TEvent>;
+
+				auto& channel = GetChannel<T>();
+				std::lock_guard lock(m_Lock);
+				channel.Enqueue(std::forward<TEvent>(event));
+			}
+
+			// Events queued by the handlers are delivered by the next call. Calling it from a handler does nothing.
+			void Flush();
+
+			// Removes all subscribers and drops the queued events
+			void Clear() noexcept;
+
+		public:
+			EventBus& operator=(const EventBus&) = delete;
+	};
+}
@@ -0,0 +1,127 @@
+#include "pch.hpp"
+#include "FormCache.h"
+#include <bit>
+
+namespace
+{
+	constexpr size_t MinCapacity = 256;
+
+	constexpr size_t HashFormID(uint32_t formID) noexcept
+	{
+		// Form IDs of one file are mostly sequential, the multiplication spreads them over the table
+		const uint32_t hash = formID * 0x9E3779B1u;
+		return hash ^ (hash >> 15);
+	}
+}
+
+namespace xSE
+{
+	void* FormCache::Find(uint32_t formID, uint32_t generation) const noexcept
+	{
+		const size_t start = HashFormID(formID);
+		for (size_t i = 0; i < ProbeCount; i++)
+		{
+			const Entry& entry = m_Entries[(start + i) & m_Mask];
+
+			// Odd sequence means a writer is in the middle of updating the entry
+			const uint32_t sequence = entry.Sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+			{
+				continue;
+			}
+
+			const uint32_t entryGeneration = entry.Generation.load(std::memory_order_relaxed);
+			const uint32_t entryFormID = entry.FormID.load(std::memory_order_relaxed);
+			void* object = entry.Object.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (entry.Sequence.load(std::memory_order_relaxed) == sequence && entryGeneration == generation && entryFormID == formID)
+			{
+				return object;
+			}
+		}
+		return nullptr;
+	}
+	void FormCache::Store(uint32_t formID, uint32_t generation, void* object) noexcept
+	{
+		// Reuse the slot of the same form or a stale one, otherwise evict one picked by the upper hash bits
+		const size_t start = HashFormID(formID);
+		size_t victim = (start + ((start >> 24) % ProbeCount)) & m_Mask;
+		for (size_t i = 0; i < ProbeCount; i++)
+		{
+			const size_t index = (start + i) & m_Mask;
+			const Entry& entry = m_Entries[index];
+			if (entry.Generation.load(std::memory_order_relaxed) != generation || entry.FormID.load(std::memory_order_relaxed) == formID)
+			{
+				victim = index;
+				break;
+			}
+		}
+
+		// Another thread writing the same entry wins, caching is only an optimization so nothing is lost by giving up
+		Entry& entry = m_Entries[victim];
+		uint32_t sequence = entry.Sequence.load(std::memory_order_relaxed);
+		if ((sequence & 1) || !entry.Sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			return;
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+
+		entry.Generation.store(generation, std::memory_order_relaxed);
+		entry.FormID.store(formID, std::memory_order_relaxed);
+		entry.Object.store(object, std::memory_order_relaxed);
+		entry.Sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	FormCache::FormCache(size_t capacity)
+	{
+		const size_t size = std::bit_ceil(std::max(capacity, MinCapacity));
+		m_Entries = std::make_unique<Entry[]>(size);
+		m_Mask = size - 1;
+	}
+
+	void FormCache::SetResolver(TResolver resolver) noexcept
+	{
+		// Objects from a different resolver aren't interchangeable with the cached ones
+		m_Resolver.store(resolver, std::memory_order_release);
+		Invalidate();
+	}
+	void FormCache::Invalidate() noexcept
+	{
+		// Zero is the generation of empty entries and is skipped on wrap around
+		if (m_Generation.fetch_add(1, std::memory_order_acq_rel) + 1 == 0)
+		{
+			m_Generation.fetch_add(1, std::memory_order_acq_rel);
+		}
+	}
+
+	void* FormCache::Resolve(uint32_t formID) noexcept
+	{
+		if (formID == 0)
+		{
+			return nullptr;
+		}
+
+		const uint32_t generation = GetGeneration();
+		if (!FormID::IsDynamic(formID))
+		{
+			if (void* object = Find(formID, generation))
+			{
+				return object;
+			}
+		}
+
+		if (TResolver resolver = GetResolver())
+		{
+			void* object = resolver(formID);
+
+			// Stamped with the generation read before resolving, a bump in the meantime leaves the entry stale
+			if (object && !FormID::IsDynamic(formID))
+			{
+				Store(formID, generation, object);
+			}
+			return object;
+		}
+		return nullptr;
+	}
+}
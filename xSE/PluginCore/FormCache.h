@@ -0,0 +1,113 @@
+#pragma once
+#include "Framework.hpp"
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace xSE
+{
+	// Form IDs carry the load order slot of the file which owns the form in the upper bits. Regular files take the top
+	// byte, light files share the 0xFE slot and take twelve more bits for their own index. IDs in the 0xFF slot are
+	// created at runtime and aren't tied to any file.
+	namespace FormID
+	{
+		inline constexpr uint32_t LightSlot = 0xFE;
+		inline constexpr uint32_t DynamicSlot = 0xFF;
+
+		constexpr uint32_t MakeRegular(uint8_t fileIndex, uint32_t localID) noexcept
+		{
+			return (static_cast<uint32_t>(fileIndex) << 24)|(localID & 0x00FFFFFF);
+		}
+		constexpr uint32_t MakeLight(uint16_t lightIndex, uint32_t localID) noexcept
+		{
+			return (LightSlot << 24)|((static_cast<uint32_t>(lightIndex) & 0xFFF) << 12)|(localID & 0xFFF);
+		}
+
+		constexpr bool IsLight(uint32_t formID) noexcept
+		{
+			return (formID >> 24) == LightSlot;
+		}
+		constexpr bool IsDynamic(uint32_t formID) noexcept
+		{
+			return (formID >> 24) == DynamicSlot;
+		}
+		constexpr uint32_t GetLocalID(uint32_t formID) noexcept
+		{
+			return IsLight(formID) ? formID & 0xFFF : formID & 0x00FFFFFF;
+		}
+	}
+}
+
+namespace xSE
+{
+	// Maps form IDs to the objects the game resolved them to. Lookups never take a lock: every entry is stamped with the
+	// generation it was resolved in and guarded by its own sequence counter, so a reader either sees a consistent entry
+	// of the current generation or falls back to the resolver. Bumping the generation with 'Invalidate' drops every entry
+	// at once, the platform does it whenever a game is loaded or a new one is started.
+	//
+	// The table has a fixed size and doesn't grow, colliding entries evict each other. Failed lookups aren't cached and
+	// neither are dynamic forms, those can be deleted at any time without the cache knowing about it.
+	class xSE_API FormCache final
+	{
+		public:
+			using TResolver = void*(*)(uint32_t formID);
+
+		private:
+			static constexpr size_t ProbeCount = 4;
+
+			struct alignas(32) Entry final
+			{
+				std::atomic<uint32_t> Sequence = 0;
+				std::atomic<uint32_t> Generation = 0;
+				std::atomic<uint32_t> FormID = 0;
+				std::atomic<void*> Object = nullptr;
+			};
+
+		private:
+			std::unique_ptr<Entry[]> m_Entries;
+			size_t m_Mask = 0;
+			std::atomic<TResolver> m_Resolver = nullptr;
+			std::atomic<uint32_t> m_Generation = 1;
+
+		private:
+			void* Find(uint32_t formID, uint32_t generation) const noexcept;
+			void Store(uint32_t formID, uint32_t generation, void* object) noexcept;
+
+		public:
+			// Capacity is rounded up to a power of two
+			FormCache(size_t capacity = 16384);
+			FormCache(const FormCache&) = delete;
+
+		public:
+			TResolver GetResolver() const noexcept
+			{
+				return m_Resolver.load(std::memory_order_acquire);
+			}
+			void SetResolver(TResolver resolver) noexcept;
+
+			uint32_t GetGeneration() const noexcept
+			{
+				return m_Generation.load(std::memory_order_acquire);
+			}
+			void Invalidate() noexcept;
+
+			void* Resolve(uint32_t formID) noexcept;
+			void* Resolve(uint8_t fileIndex, uint32_t localID) noexcept
+			{
+				return Resolve(FormID::MakeRegular(fileIndex, localID));
+			}
+			void* ResolveLight(uint16_t lightIndex, uint32_t localID) noexcept
+			{
+				return Resolve(FormID::MakeLight(lightIndex, localID));
+			}
+
+			template<class T>
+			T* Resolve(uint32_t formID) noexcept
+			{
+				return static_cast<T*>(Resolve(formID));
+			}
+
+		public:
+			FormCache& operator=(const FormCache&) = delete;
+	};
+}
@@ -1,10 +1,11 @@
 #pragma once
 #include "Framework.hpp"
+#include "MemoryResources.h"
 #include "kxf/EventSystem/Event.h"
 
 namespace xSE
 {
-	class InitializationEvent: public kxf::BasicEvent
+	class InitializationEvent: public kxf::BasicEvent, public PooledObject<InitializationEvent>
 	{
 		public:
 			KxEVENT_MEMBER(InitializationEvent, Query);
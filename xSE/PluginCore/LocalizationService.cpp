@@ -0,0 +1,264 @@
+#include "pch.hpp"
+#include "LocalizationService.h"
+#include "DataFileSystem.h"
+#include "DataPath.h"
+#include <optional>
+
+namespace
+{
+	std::string_view GetTableExtension(xSE::StringTableType type) noexcept
+	{
+		using xSE::StringTableType;
+
+		switch (type)
+		{
+			case StringTableType::Strings:
+			{
+				return ".strings";
+			}
+			case StringTableType::DLStrings:
+			{
+				return ".dlstrings";
+			}
+			case StringTableType::ILStrings:
+			{
+				return ".ilstrings";
+			}
+		};
+		return {};
+	}
+	std::string_view RemovePluginExtension(std::string_view pluginName) noexcept
+	{
+		const size_t dot = pluginName.rfind('.');
+		if (dot != std::string_view::npos)
+		{
+			const std::string_view extension = pluginName.substr(dot + 1);
+			if (xSE::DataPath::EqualsNormalized(extension, "esm") || xSE::DataPath::EqualsNormalized(extension, "esp") || xSE::DataPath::EqualsNormalized(extension, "esl"))
+			{
+				return pluginName.substr(0, dot);
+			}
+		}
+		return pluginName;
+	}
+	std::shared_ptr<const xSE::StringTable> OpenTable(const std::string& tableName, const kxf::FSPath* customPath, const kxf::FSPath& dataDirectory, const xSE::DataFileSystem* dataFileSystem)
+	{
+		auto table = std::make_shared<xSE::StringTable>();
+		if (customPath)
+		{
+			if (table->Open(*customPath))
+			{
+				return table;
+			}
+			return nullptr;
+		}
+
+		const kxf::FSPath relativePath = kxf::String::FromUTF8(tableName);
+		if (dataFileSystem)
+		{
+			if (auto origin = dataFileSystem->GetOrigin(relativePath); origin && !origin->IsLoose())
+			{
+				for (const auto& archive: dataFileSystem->GetArchives())
+				{
+					if (archive.get() == origin->Archive)
+					{
+						return table->Open(archive, *origin->Entry) ? std::move(table) : nullptr;
+					}
+				}
+				return nullptr;
+			}
+		}
+
+		if (!dataDirectory.IsNull() && table->Open(dataDirectory / relativePath))
+		{
+			return table;
+		}
+		return nullptr;
+	}
+}
+
+namespace xSE
+{
+	std::string LocalizationService::MakeTableName(std::string_view pluginName, std::string_view language, StringTableType type) const
+	{
+		const std::string_view extension = GetTableExtension(type);
+		pluginName = RemovePluginExtension(pluginName);
+
+		// Same form as 'DataPath::Normalize' produces, so it can be used as a Data path directly
+		std::string name;
+		name.reserve(8 + pluginName.size() + 1 + language.size() + extension.size());
+		name += "strings\\";
+		for (char c: pluginName)
+		{
+			name += DataPath::NormalizeChar(c);
+		}
+		name += '_';
+		name += language;
+		name += extension;
+		return name;
+	}
+	std::shared_ptr<const StringTable> LocalizationService::ResolveTable(std::string_view pluginName, StringTableType type) const
+	{
+		// Everything the tables are opened from is copied, so the files are mapped without holding the lock
+		std::array<std::string, 2> tableNames;
+		std::array<std::optional<kxf::FSPath>, 2> customPaths;
+		size_t tableCount = 0;
+		kxf::FSPath dataDirectory;
+		std::shared_ptr<DataFileSystem> dataFileSystem;
+		uint64_t generation = 0;
+		{
+			std::shared_lock lock(m_Lock);
+			tableNames[tableCount++] = MakeTableName(pluginName, m_Language, type);
+			if (m_FallbackLanguage != m_Language)
+			{
+				tableNames[tableCount++] = MakeTableName(pluginName, m_FallbackLanguage, type);
+			}
+			for (size_t i = 0; i < tableCount; i++)
+			{
+				if (auto it = m_CustomTables.find(tableNames[i]); it != m_CustomTables.end())
+				{
+					customPaths[i] = it->second;
+				}
+			}
+
+			dataDirectory = m_DataDirectory;
+			dataFileSystem = m_DataFileSystem;
+			generation = m_Generation;
+		}
+
+		std::shared_ptr<const StringTable> table;
+		for (size_t i = 0; i < tableCount && !table; i++)
+		{
+			table = OpenTable(tableNames[i], customPaths[i] ? &*customPaths[i] : nullptr, dataDirectory, dataFileSystem.get());
+		}
+
+		// A table opened for a language or directory which has changed in the meantime is used but not remembered
+		std::lock_guard lock(m_Lock);
+		if (generation != m_Generation)
+		{
+			return table;
+		}
+
+		pluginName = RemovePluginExtension(pluginName);
+		auto it = m_PluginTables.find(pluginName);
+		if (it == m_PluginTables.end())
+		{
+			std::string key;
+			key.reserve(pluginName.size());
+			for (char c: pluginName)
+			{
+				key += DataPath::NormalizeChar(c);
+			}
+			it = m_PluginTables.emplace(std::move(key), PluginTables()).first;
+		}
+
+		// Another thread may have resolved it first, everyone uses the same table then
+		const size_t index = static_cast<size_t>(type);
+		PluginTables& tables = it->second;
+		if (!tables.IsResolved[index])
+		{
+			tables.Tables[index] = std::move(table);
+			tables.IsResolved[index] = true;
+		}
+		return tables.Tables[index];
+	}
+	void LocalizationService::InvalidateTables() noexcept
+	{
+		// Tables still used by a lookup in progress are destroyed when it releases them
+		m_PluginTables.clear();
+		m_Generation++;
+	}
+
+	void LocalizationService::SetDataDirectory(const kxf::FSPath& directory)
+	{
+		std::lock_guard lock(m_Lock);
+		m_DataDirectory = directory;
+		InvalidateTables();
+	}
+	void LocalizationService::SetDataFileSystem(std::shared_ptr<DataFileSystem> fileSystem)
+	{
+		std::lock_guard lock(m_Lock);
+		m_DataFileSystem = std::move(fileSystem);
+		InvalidateTables();
+	}
+
+	std::string LocalizationService::GetLanguage() const
+	{
+		std::shared_lock lock(m_Lock);
+		return m_Language;
+	}
+	void LocalizationService::SetLanguage(std::string_view language)
+	{
+		std::lock_guard lock(m_Lock);
+		m_Language = DataPath::Normalize(language);
+		InvalidateTables();
+	}
+	void LocalizationService::SetFallbackLanguage(std::string_view language)
+	{
+		std::lock_guard lock(m_Lock);
+		m_FallbackLanguage = DataPath::Normalize(language);
+		InvalidateTables();
+	}
+
+	bool LocalizationService::AddTable(std::string_view pluginName, std::string_view language, const kxf::FSPath& path)
+	{
+		const StringTableType type = StringTable::GetTypeFromExtension(path.GetExtension().ToUTF8());
+		if (type != StringTableType::None)
+		{
+			std::string tableName = MakeTableName(pluginName, DataPath::Normalize(language), type);
+
+			std::lock_guard lock(m_Lock);
+			m_CustomTables.insert_or_assign(std::move(tableName), path);
+			InvalidateTables();
+			return true;
+		}
+		return false;
+	}
+	void LocalizationService::Unload()
+	{
+		std::lock_guard lock(m_Lock);
+		InvalidateTables();
+	}
+
+	std::wstring_view LocalizationService::GetString(std::string_view pluginName, uint32_t id, StringTableType type) const
+	{
+		// The table is held for the duration of the lookup, it may be unloaded by another thread meanwhile
+		if (type != StringTableType::None)
+		{
+			if (auto table = GetTable(pluginName, type))
+			{
+				return table->GetString(id);
+			}
+			return {};
+		}
+
+		// IDs are unique across the three tables of a plugin
+		for (StringTableType item: {StringTableType::Strings, StringTableType::DLStrings, StringTableType::ILStrings})
+		{
+			if (auto table = GetTable(pluginName, item); table && table->Contains(id))
+			{
+				return table->GetString(id);
+			}
+		}
+		return {};
+	}
+	std::shared_ptr<const StringTable> LocalizationService::GetTable(std::string_view pluginName, StringTableType type) const
+	{
+		if (type == StringTableType::None)
+		{
+			return nullptr;
+		}
+
+		{
+			std::shared_lock lock(m_Lock);
+			if (auto it = m_PluginTables.find(RemovePluginExtension(pluginName)); it != m_PluginTables.end())
+			{
+				const size_t index = static_cast<size_t>(type);
+				if (it->second.IsResolved[index])
+				{
+					return it->second.Tables[index];
+				}
+			}
+		}
+		return ResolveTable(pluginName, type);
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "Framework.hpp"
+#include "StringTable.h"
+#include "DataPath.h"
+#include <kxf/FileSystem/FSPath.h>
+#include <unordered_map>
+#include <shared_mutex>
+#include <string>
+#include <array>
+#include <algorithm>
+
+namespace xSE
+{
+	class DataFileSystem;
+}
+
+namespace xSE
+{
+	// Localized strings of the loaded plugins. Tables are looked up as 'Strings\<Plugin>_<Language>.<Type>' in the Data
+	// directory, or through a 'DataFileSystem' when one is attached so that tables packed in archives are found as well.
+	// Nothing is opened until a string from a table is requested and tables which don't exist are remembered as such.
+	// Plugins can register their own tables which then take precedence over the ones found in the Data directory.
+	//
+	// The table resolved for a plugin and type, after the fallback language, is remembered so a lookup is a single hash
+	// probe on the plugin name. Returned string views stay valid until the language is changed or the tables are
+	// unloaded, returned tables for as long as they're held.
+	class xSE_API LocalizationService final
+	{
+		private:
+			// Plugin names are compared case-insensitively without normalizing them first
+			struct PluginNameHash final
+			{
+				using is_transparent = void;
+
+				size_t operator()(std::string_view pluginName) const noexcept
+				{
+					size_t hash = 14695981039346656037ull;
+					for (char c: pluginName)
+					{
+						hash = (hash ^ static_cast<unsigned char>(DataPath::NormalizeChar(c))) * 1099511628211ull;
+					}
+					return hash;
+				}
+			};
+			struct PluginNameEqual final
+			{
+				using is_transparent = void;
+
+				bool operator()(std::string_view left, std::string_view right) const noexcept
+				{
+					return std::ranges::equal(left, right, {}, DataPath::NormalizeChar, DataPath::NormalizeChar);
+				}
+			};
+
+			// Missing tables are resolved as well so the file system isn't asked again
+			struct PluginTables final
+			{
+				std::array<std::shared_ptr<const StringTable>, 3> Tables;
+				std::array<bool, 3> IsResolved = {};
+			};
+			using TPluginMap = std::unordered_map<std::string, PluginTables, PluginNameHash, PluginNameEqual>;
+			using TPathMap = std::unordered_map<std::string, kxf::FSPath>;
+
+		private:
+			kxf::FSPath m_DataDirectory;
+			std::shared_ptr<DataFileSystem> m_DataFileSystem;
+			std::string m_Language = "english";
+			std::string m_FallbackLanguage = "english";
+
+			mutable std::shared_mutex m_Lock;
+			mutable TPluginMap m_PluginTables;
+			TPathMap m_CustomTables;
+			uint64_t m_Generation = 0;
+
+		private:
+			std::string MakeTableName(std::string_view pluginName, std::string_view language, StringTableType type) const;
+			std::shared_ptr<const StringTable> ResolveTable(std::string_view pluginName, StringTableType type) const;
+			void InvalidateTables() noexcept;
+
+		public:
+			LocalizationService() = default;
+			LocalizationService(const LocalizationService&) = delete;
+
+		public:
+			void SetDataDirectory(const kxf::FSPath& directory);
+			void SetDataFileSystem(std::shared_ptr<DataFileSystem> fileSystem);
+
+			// Language names as used in the table file names, for example 'English' or 'Russian'
+			std::string GetLanguage() const;
+			void SetLanguage(std::string_view language);
+			void SetFallbackLanguage(std::string_view language);
+
+			// Registers a table for the given plugin and language, the type is taken from the file extension
+			bool AddTable(std::string_view pluginName, std::string_view language, const kxf::FSPath& path);
+
+			// Closes all tables, they're reopened on the next request
+			void Unload();
+
+			// The plugin name may include its extension. With 'StringTableType::None' all three tables are searched.
+			std::wstring_view GetString(std::string_view pluginName, uint32_t id, StringTableType type = StringTableType::None) const;
+			std::shared_ptr<const StringTable> GetTable(std::string_view pluginName, StringTableType type) const;
+
+		public:
+			LocalizationService& operator=(const LocalizationService&) = delete;
+	};
+}
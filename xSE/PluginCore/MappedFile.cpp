@@ -0,0 +1,142 @@
+#include "pch.hpp"
+#include "MappedFile.h"
+#include <kxf/FileSystem/FSPath.h>
+#include <Windows.h>
+
+namespace xSE
+{
+	void MappedView::Reset() noexcept
+	{
+		if (m_Window)
+		{
+			::UnmapViewOfFile(m_Window);
+			m_Window = nullptr;
+		}
+		m_Data = {};
+	}
+	MappedView& MappedView::operator=(MappedView&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+
+			m_Window = std::exchange(other.m_Window, nullptr);
+			m_Data = std::exchange(other.m_Data, {});
+		}
+		return *this;
+	}
+
+	bool MappedFile::Open(const kxf::FSPath& path, bool isWindowed)
+	{
+		Close();
+
+		const auto fullPath = path.GetFullPathWithNS(kxf::FSPathNamespace::Win32File);
+		HANDLE fileHandle = ::CreateFileW(fullPath.wc_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL|FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size = {};
+		if (!::GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0 || static_cast<uint64_t>(size.QuadPart) > std::numeric_limits<size_t>::max())
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		HANDLE mappingHandle = ::CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		const void* data = nullptr;
+		if (!isWindowed)
+		{
+			data = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			if (!data)
+			{
+				::CloseHandle(mappingHandle);
+				::CloseHandle(fileHandle);
+				return false;
+			}
+		}
+
+		m_FileHandle = fileHandle;
+		m_MappingHandle = mappingHandle;
+		m_Data = static_cast<const std::byte*>(data);
+		m_Size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+	void MappedFile::Close() noexcept
+	{
+		if (m_Data)
+		{
+			::UnmapViewOfFile(m_Data);
+			m_Data = nullptr;
+		}
+		m_Size = 0;
+		if (m_MappingHandle)
+		{
+			::CloseHandle(m_MappingHandle);
+			m_MappingHandle = nullptr;
+		}
+		if (m_FileHandle)
+		{
+			::CloseHandle(m_FileHandle);
+			m_FileHandle = nullptr;
+		}
+	}
+
+	MappedView MappedFile::MapView(uint64_t offset, uint64_t size) const noexcept
+	{
+		if (!m_MappingHandle || offset > m_Size || size > m_Size - offset)
+		{
+			return {};
+		}
+		if (m_Data)
+		{
+			return std::span<const std::byte>(m_Data + offset, static_cast<size_t>(size));
+		}
+		if (size == 0)
+		{
+			return {};
+		}
+
+		// Windows have to start at a multiple of the allocation granularity
+		static const uint64_t g_Granularity = []()
+		{
+			SYSTEM_INFO info = {};
+			::GetSystemInfo(&info);
+			return static_cast<uint64_t>(info.dwAllocationGranularity);
+		}();
+		const uint64_t windowOffset = offset - offset % g_Granularity;
+		const uint64_t windowSize = size + (offset - windowOffset);
+		if (windowSize > std::numeric_limits<size_t>::max())
+		{
+			return {};
+		}
+
+		const void* window = ::MapViewOfFile(m_MappingHandle, FILE_MAP_READ, static_cast<DWORD>(windowOffset >> 32), static_cast<DWORD>(windowOffset), static_cast<size_t>(windowSize));
+		if (!window)
+		{
+			return {};
+		}
+		return {{static_cast<const std::byte*>(window) + (offset - windowOffset), static_cast<size_t>(size)}, window};
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			m_FileHandle = std::exchange(other.m_FileHandle, nullptr);
+			m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+			m_Data = std::exchange(other.m_Data, nullptr);
+			m_Size = std::exchange(other.m_Size, 0);
+		}
+		return *this;
+	}
+}
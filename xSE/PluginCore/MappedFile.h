@@ -0,0 +1,145 @@
+#pragma once
+#include "Framework.hpp"
+#include <span>
+#include <cstddef>
+
+namespace kxf
+{
+	class FSPath;
+}
+
+namespace xSE
+{
+	// A range of a 'MappedFile'. Either a part of the whole-file mapping, valid as long as the file is open, or a window
+	// mapped for this range alone which stays valid until the view is destroyed, even after the file is closed.
+	class xSE_API MappedView final
+	{
+		private:
+			const void* m_Window = nullptr;
+			std::span<const std::byte> m_Data;
+
+		public:
+			MappedView() noexcept = default;
+			MappedView(std::span<const std::byte> data, const void* window = nullptr) noexcept
+				:m_Window(window), m_Data(data)
+			{
+			}
+			MappedView(MappedView&& other) noexcept
+			{
+				*this = std::move(other);
+			}
+			MappedView(const MappedView&) = delete;
+			~MappedView()
+			{
+				Reset();
+			}
+
+		public:
+			void Reset() noexcept;
+
+			bool IsEmpty() const noexcept
+			{
+				return m_Data.empty();
+			}
+			const std::byte* GetData() const noexcept
+			{
+				return m_Data.data();
+			}
+			size_t GetSize() const noexcept
+			{
+				return m_Data.size();
+			}
+			std::span<const std::byte> GetView() const noexcept
+			{
+				return m_Data;
+			}
+
+		public:
+			MappedView& operator=(MappedView&& other) noexcept;
+			MappedView& operator=(const MappedView&) = delete;
+	};
+
+	// Read-only memory mapping of a file. Normally the whole file is mapped and the view stays valid for the lifetime of
+	// the object so parsers can keep pointers and string views into it instead of copying. A 32-bit process may not have
+	// contiguous address space left for large files such as the game's archives, those are opened with 'OpenWindowed'
+	// and only the ranges requested through 'MapView' are mapped.
+	class xSE_API MappedFile final
+	{
+		private:
+			void* m_FileHandle = nullptr;
+			void* m_MappingHandle = nullptr;
+			const std::byte* m_Data = nullptr;
+			size_t m_Size = 0;
+
+		private:
+			bool Open(const kxf::FSPath& path, bool isWindowed);
+
+		public:
+			MappedFile() noexcept = default;
+			MappedFile(const kxf::FSPath& path)
+			{
+				Open(path);
+			}
+			MappedFile(MappedFile&& other) noexcept
+			{
+				*this = std::move(other);
+			}
+			MappedFile(const MappedFile&) = delete;
+			~MappedFile()
+			{
+				Close();
+			}
+
+		public:
+			bool Open(const kxf::FSPath& path)
+			{
+				return Open(path, false);
+			}
+			bool OpenWindowed(const kxf::FSPath& path)
+			{
+				return Open(path, true);
+			}
+			void Close() noexcept;
+
+			bool IsOpen() const noexcept
+			{
+				return m_MappingHandle != nullptr;
+			}
+			bool IsWindowed() const noexcept
+			{
+				return m_MappingHandle != nullptr && m_Data == nullptr;
+			}
+
+			// The whole-file view is empty for windowed files
+			const std::byte* GetData() const noexcept
+			{
+				return m_Data;
+			}
+			size_t GetSize() const noexcept
+			{
+				return m_Size;
+			}
+			std::span<const std::byte> GetView() const noexcept
+			{
+				return {m_Data, m_Size};
+			}
+
+			// Returns an empty span if the range is outside of the file or the file is windowed
+			std::span<const std::byte> GetView(uint64_t offset, uint64_t size) const noexcept
+			{
+				if (m_Data && offset <= m_Size && size <= m_Size - offset)
+				{
+					return {m_Data + offset, static_cast<size_t>(size)};
+				}
+				return {};
+			}
+
+			// Part of the whole-file mapping or a window of its own for windowed files. Empty if the range is outside
+			// of the file or can't be mapped.
+			MappedView MapView(uint64_t offset, uint64_t size) const noexcept;
+
+		public:
+			MappedFile& operator=(MappedFile&& other) noexcept;
+			MappedFile& operator=(const MappedFile&) = delete;
+	};
+}
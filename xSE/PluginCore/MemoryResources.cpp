@@ -0,0 +1,339 @@
+#include "pch.hpp"
+#include "MemoryResources.h"
+#include <cassert>
+
+namespace
+{
+	constexpr size_t g_PoolAlignment = 16;
+	constexpr size_t g_SlabSize = 64 * 1024;
+	constexpr std::array<size_t, xSE::SmallObjectPoolResource::SizeClassCount> g_SizeClasses = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+	constexpr size_t GetSizeClass(size_t size) noexcept
+	{
+		for (size_t i = 0; i < g_SizeClasses.size(); i++)
+		{
+			if (size <= g_SizeClasses[i])
+			{
+				return i;
+			}
+		}
+		return g_SizeClasses.size();
+	}
+	std::byte* AlignPointer(std::byte* ptr, size_t alignment) noexcept
+	{
+		auto value = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<std::byte*>((value + alignment - 1) & ~(alignment - 1));
+	}
+
+	// Keyed by the arena's ID rather than its address, an arena created where a destroyed one was must not see its
+	// blocks. A few arenas can be used from the same thread in turn without giving up each other's blocks.
+	struct FrameArenaThreadCache final
+	{
+		uint64_t Owner = 0;
+		uint32_t Epoch = 0;
+		std::byte* Current = nullptr;
+		std::byte* End = nullptr;
+	};
+	thread_local std::array<FrameArenaThreadCache, 4> g_FrameArenaCaches;
+	thread_local size_t g_FrameArenaNextVictim = 0;
+
+	std::atomic<uint64_t> g_NextFrameArenaID = 1;
+
+	FrameArenaThreadCache& GetFrameArenaCache(uint64_t owner) noexcept
+	{
+		for (auto& cache: g_FrameArenaCaches)
+		{
+			if (cache.Owner == owner)
+			{
+				return cache;
+			}
+		}
+		for (auto& cache: g_FrameArenaCaches)
+		{
+			if (cache.Owner == 0)
+			{
+				return cache;
+			}
+		}
+		return g_FrameArenaCaches[g_FrameArenaNextVictim++ % g_FrameArenaCaches.size()];
+	}
+
+	#ifndef NDEBUG
+	class ActiveAllocationScope final
+	{
+		private:
+			std::atomic<size_t>& m_Count;
+
+		public:
+			ActiveAllocationScope(std::atomic<size_t>& count) noexcept
+				:m_Count(count)
+			{
+				m_Count.fetch_add(1, std::memory_order_seq_cst);
+			}
+			~ActiveAllocationScope()
+			{
+				m_Count.fetch_sub(1, std::memory_order_seq_cst);
+			}
+	};
+	#endif
+}
+
+namespace xSE
+{
+	FrameArenaResource::Block FrameArenaResource::AcquireBlock(size_t minSize)
+	{
+		std::lock_guard lock(m_BlocksLock);
+
+		// Oversized requests get a dedicated block which is released on the next reset
+		if (minSize > m_BlockSize)
+		{
+			Block block = {static_cast<std::byte*>(m_Upstream->allocate(minSize, alignof(std::max_align_t))), minSize};
+			m_LargeBlocks.emplace_back(block);
+
+			return block;
+		}
+
+		if (m_NextFreeBlock == m_Blocks.size())
+		{
+			m_Blocks.emplace_back(Block{static_cast<std::byte*>(m_Upstream->allocate(m_BlockSize, alignof(std::max_align_t))), m_BlockSize});
+		}
+		return m_Blocks[m_NextFreeBlock++];
+	}
+
+	void* FrameArenaResource::do_allocate(size_t size, size_t alignment)
+	{
+		#ifndef NDEBUG
+		ActiveAllocationScope activeScope(m_ActiveAllocations);
+		#endif
+
+		auto& cache = GetFrameArenaCache(m_ID);
+		const uint32_t epoch = m_Epoch.load(std::memory_order_acquire);
+
+		if (cache.Owner == m_ID && cache.Epoch == epoch)
+		{
+			std::byte* ptr = AlignPointer(cache.Current, alignment);
+			if (ptr + size <= cache.End)
+			{
+				cache.Current = ptr + size;
+				m_BytesAllocated.fetch_add(size, std::memory_order_relaxed);
+
+				return ptr;
+			}
+		}
+
+		// Requests taking a significant part of a block would waste the rest of the current one, serve them separately
+		const size_t required = size + alignment;
+		if (required > m_BlockSize / 4)
+		{
+			m_BytesAllocated.fetch_add(size, std::memory_order_relaxed);
+			return AlignPointer(AcquireBlock(std::max(required, m_BlockSize + 1)).Data, alignment);
+		}
+
+		Block block = AcquireBlock(required);
+		cache.Owner = m_ID;
+		cache.Epoch = epoch;
+		cache.Current = AlignPointer(block.Data, alignment) + size;
+		cache.End = block.Data + block.Size;
+		m_BytesAllocated.fetch_add(size, std::memory_order_relaxed);
+
+		return cache.Current - size;
+	}
+	void FrameArenaResource::do_deallocate(void* ptr, size_t size, size_t alignment)
+	{
+		// Memory is reclaimed all at once on reset
+	}
+
+	FrameArenaResource::FrameArenaResource(size_t blockSize, std::pmr::memory_resource* upstream)
+		:m_Upstream(upstream), m_BlockSize(blockSize), m_ID(g_NextFrameArenaID.fetch_add(1, std::memory_order_relaxed))
+	{
+	}
+	FrameArenaResource::~FrameArenaResource()
+	{
+		Reset();
+
+		for (const Block& block: m_Blocks)
+		{
+			m_Upstream->deallocate(block.Data, block.Size, alignof(std::max_align_t));
+		}
+		m_Blocks.clear();
+	}
+
+	void FrameArenaResource::Reset() noexcept
+	{
+		std::lock_guard lock(m_BlocksLock);
+
+		// Invalidates every thread-local block, threads will pick up a fresh one on their next allocation. An allocation
+		// running concurrently could have seen the old epoch and keep using a block which is about to be handed out again.
+		m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+		assert(m_ActiveAllocations.load(std::memory_order_seq_cst) == 0 && "FrameArenaResource reset while allocating");
+		m_BytesAllocated.store(0, std::memory_order_relaxed);
+		m_NextFreeBlock = 0;
+
+		for (const Block& block: m_LargeBlocks)
+		{
+			m_Upstream->deallocate(block.Data, block.Size, alignof(std::max_align_t));
+		}
+		m_LargeBlocks.clear();
+	}
+}
+
+namespace
+{
+	struct PoolThreadCache final
+	{
+		std::shared_ptr<xSE::SmallObjectPoolResource::SharedState> Owner;
+		std::array<void*, xSE::SmallObjectPoolResource::SizeClassCount> Heads = {};
+		std::array<size_t, xSE::SmallObjectPoolResource::SizeClassCount> Counts = {};
+
+		~PoolThreadCache();
+	};
+	thread_local PoolThreadCache g_PoolCache;
+
+	void*& NextOf(void* block) noexcept
+	{
+		return *static_cast<void**>(block);
+	}
+}
+
+namespace xSE
+{
+	SmallObjectPoolResource::SharedState::~SharedState()
+	{
+		for (auto& [data, size]: Slabs)
+		{
+			Upstream->deallocate(data, size, g_PoolAlignment);
+		}
+	}
+
+	void* SmallObjectPoolResource::AllocateFromShared(size_t sizeClass)
+	{
+		std::lock_guard lock(m_State->Lock);
+
+		void*& head = m_State->FreeLists[sizeClass];
+		if (!head)
+		{
+			// Carve a new slab into blocks of this class
+			void* slab = m_State->Upstream->allocate(g_SlabSize, g_PoolAlignment);
+			m_State->Slabs.emplace_back(slab, g_SlabSize);
+
+			const size_t blockSize = g_SizeClasses[sizeClass];
+			const size_t blockCount = g_SlabSize / blockSize;
+			auto data = static_cast<std::byte*>(slab);
+			for (size_t i = 0; i < blockCount; i++)
+			{
+				void* block = data + (blockCount - i - 1) * blockSize;
+				NextOf(block) = head;
+				head = block;
+			}
+		}
+
+		void* block = head;
+		head = NextOf(block);
+		return block;
+	}
+	void SmallObjectPoolResource::ReleaseToShared(size_t sizeClass, void* first, void* last)
+	{
+		std::lock_guard lock(m_State->Lock);
+
+		void*& head = m_State->FreeLists[sizeClass];
+		NextOf(last) = head;
+		head = first;
+	}
+
+	void* SmallObjectPoolResource::do_allocate(size_t size, size_t alignment)
+	{
+		const size_t sizeClass = GetSizeClass(size);
+		if (sizeClass == SizeClassCount || alignment > g_PoolAlignment)
+		{
+			return m_State->Upstream->allocate(size, alignment);
+		}
+
+		auto& cache = g_PoolCache;
+		if (!cache.Owner)
+		{
+			cache.Owner = m_State;
+		}
+		if (cache.Owner == m_State)
+		{
+			if (void* block = cache.Heads[sizeClass])
+			{
+				cache.Heads[sizeClass] = NextOf(block);
+				cache.Counts[sizeClass]--;
+
+				return block;
+			}
+		}
+		return AllocateFromShared(sizeClass);
+	}
+	void SmallObjectPoolResource::do_deallocate(void* ptr, size_t size, size_t alignment)
+	{
+		const size_t sizeClass = GetSizeClass(size);
+		if (sizeClass == SizeClassCount || alignment > g_PoolAlignment)
+		{
+			m_State->Upstream->deallocate(ptr, size, alignment);
+			return;
+		}
+
+		auto& cache = g_PoolCache;
+		if (cache.Owner == m_State)
+		{
+			NextOf(ptr) = cache.Heads[sizeClass];
+			cache.Heads[sizeClass] = ptr;
+
+			// Hand half of an overflowing cache back to the shared list so memory freed on one thread can be reused by others
+			if (++cache.Counts[sizeClass] >= ThreadCacheCapacity)
+			{
+				void* first = cache.Heads[sizeClass];
+				void* last = first;
+				for (size_t i = 1; i < ThreadCacheCapacity / 2; i++)
+				{
+					last = NextOf(last);
+				}
+
+				cache.Heads[sizeClass] = NextOf(last);
+				cache.Counts[sizeClass] -= ThreadCacheCapacity / 2;
+				ReleaseToShared(sizeClass, first, last);
+			}
+		}
+		else
+		{
+			ReleaseToShared(sizeClass, ptr, ptr);
+		}
+	}
+
+	SmallObjectPoolResource::SmallObjectPoolResource(std::pmr::memory_resource* upstream)
+		:m_State(std::make_shared<SharedState>())
+	{
+		m_State->Upstream = upstream;
+	}
+}
+
+namespace
+{
+	PoolThreadCache::~PoolThreadCache()
+	{
+		// Return everything cached by the exiting thread, the shared state is kept alive by our reference
+		if (Owner)
+		{
+			std::lock_guard lock(Owner->Lock);
+			for (size_t i = 0; i < Heads.size(); i++)
+			{
+				while (void* block = Heads[i])
+				{
+					Heads[i] = NextOf(block);
+					NextOf(block) = Owner->FreeLists[i];
+					Owner->FreeLists[i] = block;
+				}
+			}
+		}
+	}
+}
+
+namespace xSE
+{
+	std::pmr::memory_resource& GetPooledObjectResource() noexcept
+	{
+		static SmallObjectPoolResource g_Resource;
+		return g_Resource;
+	}
+}
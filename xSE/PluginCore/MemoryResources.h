@@ -0,0 +1,152 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory_resource>
+
+namespace xSE
+{
+	// Linear allocator for data which lives no longer than the current frame. Every thread carves its allocations
+	// out of a thread-local block so the common path is a pointer bump without any synchronization. 'Reset' is called
+	// by the platform from the main-thread frame drain and makes all the memory handed out since the previous reset
+	// available again, blocks are kept and reused rather than returned to the upstream resource.
+	// Since the fast path isn't synchronized with 'Reset', no thread may be allocating from the arena while it's being
+	// reset: workers must be done with their frame allocations before the frame ends. Debug builds assert this.
+	class xSE_API FrameArenaResource final: public std::pmr::memory_resource
+	{
+		public:
+			static constexpr size_t DefaultBlockSize = 256 * 1024;
+
+		private:
+			struct Block final
+			{
+				std::byte* Data = nullptr;
+				size_t Size = 0;
+			};
+
+		private:
+			std::pmr::memory_resource* m_Upstream = nullptr;
+			const size_t m_BlockSize = DefaultBlockSize;
+
+			std::mutex m_BlocksLock;
+			std::vector<Block> m_Blocks;
+			std::vector<Block> m_LargeBlocks;
+			size_t m_NextFreeBlock = 0;
+
+			const uint64_t m_ID = 0;
+			std::atomic<uint32_t> m_Epoch = 1;
+			std::atomic<size_t> m_BytesAllocated = 0;
+			std::atomic<size_t> m_ActiveAllocations = 0;
+
+		private:
+			Block AcquireBlock(size_t minSize);
+
+		protected:
+			// std::pmr::memory_resource
+			void* do_allocate(size_t size, size_t alignment) override;
+			void do_deallocate(void* ptr, size_t size, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+			{
+				return this == &other;
+			}
+
+		public:
+			FrameArenaResource(size_t blockSize = DefaultBlockSize, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+			FrameArenaResource(const FrameArenaResource&) = delete;
+			~FrameArenaResource();
+
+		public:
+			void Reset() noexcept;
+
+			uint32_t GetEpoch() const noexcept
+			{
+				return m_Epoch.load(std::memory_order_acquire);
+			}
+			size_t GetBytesAllocated() const noexcept
+			{
+				return m_BytesAllocated.load(std::memory_order_relaxed);
+			}
+
+		public:
+			FrameArenaResource& operator=(const FrameArenaResource&) = delete;
+	};
+}
+
+namespace xSE
+{
+	// Fixed-size pools for small objects such as events and short strings. Blocks are grouped into size classes,
+	// each thread keeps a small cache of free blocks per class and only goes to the shared free lists when the cache
+	// runs dry or overflows. Requests bigger than the largest class are forwarded to the upstream resource.
+	class xSE_API SmallObjectPoolResource final: public std::pmr::memory_resource
+	{
+		public:
+			static constexpr size_t MaxPooledSize = 1024;
+			static constexpr size_t SizeClassCount = 12;
+			static constexpr size_t ThreadCacheCapacity = 64;
+
+		public:
+			// Free blocks are linked through their first pointer-sized bytes
+			struct SharedState final
+			{
+				std::pmr::memory_resource* Upstream = nullptr;
+
+				std::mutex Lock;
+				std::array<void*, SizeClassCount> FreeLists = {};
+				std::vector<std::pair<void*, size_t>> Slabs;
+
+				~SharedState();
+			};
+
+		private:
+			std::shared_ptr<SharedState> m_State;
+
+		private:
+			void* AllocateFromShared(size_t sizeClass);
+			void ReleaseToShared(size_t sizeClass, void* first, void* last);
+
+		protected:
+			// std::pmr::memory_resource
+			void* do_allocate(size_t size, size_t alignment) override;
+			void do_deallocate(void* ptr, size_t size, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+			{
+				return this == &other;
+			}
+
+		public:
+			SmallObjectPoolResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+			SmallObjectPoolResource(const SmallObjectPoolResource&) = delete;
+
+		public:
+			SmallObjectPoolResource& operator=(const SmallObjectPoolResource&) = delete;
+	};
+}
+
+namespace xSE
+{
+	// Base for small, frequently allocated objects like events which can't go through a 'polymorphic_allocator'
+	// because they're owned by 'std::unique_ptr' with the default deleter.
+	template<class TDerived>
+	class PooledObject
+	{
+		public:
+			static void* operator new(size_t size);
+			static void operator delete(void* ptr, size_t size) noexcept;
+	};
+
+	xSE_API std::pmr::memory_resource& GetPooledObjectResource() noexcept;
+
+	template<class TDerived>
+	void* PooledObject<TDerived>::operator new(size_t size)
+	{
+		return GetPooledObjectResource().allocate(size, alignof(std::max_align_t));
+	}
+
+	template<class TDerived>
+	void PooledObject<TDerived>::operator delete(void* ptr, size_t size) noexcept
+	{
+		GetPooledObjectResource().deallocate(ptr, size, alignof(std::max_align_t));
+	}
+}
@@ -0,0 +1,779 @@
+#include "pch.hpp"
+#include "MemoryTracker.h"
+#include <kxf/IO/IStream.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <format>
+#include <new>
+#include <utility>
+#include <Windows.h>
+
+#if xSE_MEMORY_TRACKING
+#include <DbgHelp.h>
+#endif
+
+namespace
+{
+	using xSE::MemoryTracker;
+
+	// Everything used by the allocation functions is constant-initialized and never destroyed, allocations can happen
+	// before any static constructor of the module has run and frees after all static destructors have.
+	constexpr uint64_t HeaderCookie = 0x4B5254'4D454D'5378;
+	constexpr uint16_t NoStack = std::numeric_limits<uint16_t>::max();
+	constexpr size_t StackTableSize = 1024;
+
+	struct alignas(16) AllocationHeader final
+	{
+		uint64_t Cookie = 0;
+		uint64_t Size = 0;
+		uint32_t Offset = 0;
+		uint16_t Stack = NoStack;
+		uint8_t Subsystem = 0;
+		bool IsAligned = false;
+	};
+	static_assert(sizeof(AllocationHeader) == 32);
+
+	struct SubsystemCounters final
+	{
+		std::atomic<uint64_t> AllocatedBytes = 0;
+		std::atomic<uint64_t> FreedBytes = 0;
+		std::atomic<uint64_t> Allocations = 0;
+		std::atomic<uint64_t> Frees = 0;
+	};
+
+	// Counters are only written by the owning thread, plain load and store is enough and avoids locked instructions.
+	// States of exited threads are reused by new ones and keep their counters, the totals stay correct either way.
+	struct ThreadState final
+	{
+		std::array<SubsystemCounters, MemoryTracker::MaxSubsystems> Counters;
+		std::atomic<int64_t> LiveBytes = 0;
+		std::atomic<int64_t> PeakBytes = 0;
+		std::atomic<uint64_t> Allocations = 0;
+		std::atomic<uint32_t> ThreadID = 0;
+		std::atomic<bool> IsInUse = true;
+		ThreadState* Next = nullptr;
+
+		int64_t SampleCountdown = 0;
+		bool IsSampling = false;
+	};
+
+	struct StackEntry final
+	{
+		std::atomic<uint32_t> Hash = 0;
+		uint32_t Depth = 0;
+		uint8_t Subsystem = 0;
+		std::array<void*, MemoryTracker::MaxStackDepth> Frames = {};
+
+		std::atomic<int64_t> LiveBytes = 0;
+		std::atomic<uint64_t> Samples = 0;
+	};
+
+	std::atomic<ThreadState*> g_ThreadStates = nullptr;
+	std::atomic<size_t> g_SampleInterval = 0;
+
+	std::mutex g_SubsystemsLock;
+	std::array<std::atomic<const char*>, MemoryTracker::MaxSubsystems> g_SubsystemNames = {};
+	std::atomic<size_t> g_SubsystemCount = 1;
+
+	std::atomic_flag g_StacksLock;
+	std::array<StackEntry, StackTableSize> g_Stacks;
+
+	thread_local ThreadState* g_ThreadState = nullptr;
+	thread_local uint8_t g_Subsystem = 0;
+	thread_local bool g_IsThreadExiting = false;
+
+	template<class T>
+	void AddRelaxed(std::atomic<T>& value, T delta) noexcept
+	{
+		value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
+	uint64_t MakeCookie(const void* data) noexcept
+	{
+		return HeaderCookie ^ reinterpret_cast<uintptr_t>(data);
+	}
+	AllocationHeader& GetHeader(void* data) noexcept
+	{
+		return *(static_cast<AllocationHeader*>(data) - 1);
+	}
+	bool IsHeaderReadable(const void* data) noexcept
+	{
+		// The block itself is readable, so is the rest of its page. Only when the header would start on the previous page,
+		// which for a foreign block may be unmapped or a guard page, it has to be checked.
+		constexpr uintptr_t PageSize = 4096;
+		const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+		if ((address & (PageSize - 1)) >= sizeof(AllocationHeader))
+		{
+			return true;
+		}
+		if (address < sizeof(AllocationHeader))
+		{
+			return false;
+		}
+
+		MEMORY_BASIC_INFORMATION info = {};
+		if (::VirtualQuery(reinterpret_cast<const void*>(address - sizeof(AllocationHeader)), &info, sizeof(info)) == 0)
+		{
+			return false;
+		}
+
+		constexpr DWORD readable = PAGE_READONLY|PAGE_READWRITE|PAGE_WRITECOPY|PAGE_EXECUTE_READ|PAGE_EXECUTE_READWRITE|PAGE_EXECUTE_WRITECOPY;
+		return info.State == MEM_COMMIT && (info.Protect & readable) != 0 && (info.Protect & PAGE_GUARD) == 0;
+	}
+
+	ThreadState* AcquireThreadState() noexcept
+	{
+		struct Release final
+		{
+			ThreadState* State = nullptr;
+
+			~Release()
+			{
+				if (State)
+				{
+					State->IsInUse.store(false, std::memory_order_release);
+					g_ThreadState = nullptr;
+					g_IsThreadExiting = true;
+				}
+			}
+		};
+		thread_local Release g_Release;
+
+		// Reuse the state of an exited thread if there's one
+		ThreadState* state = nullptr;
+		for (ThreadState* item = g_ThreadStates.load(std::memory_order_acquire); item; item = item->Next)
+		{
+			bool isInUse = false;
+			if (item->IsInUse.compare_exchange_strong(isInUse, true, std::memory_order_acq_rel))
+			{
+				state = item;
+				break;
+			}
+		}
+
+		// Allocated straight from the CRT, going through 'operator new' would end up here again
+		if (!state)
+		{
+			void* buffer = std::malloc(sizeof(ThreadState));
+			if (!buffer)
+			{
+				return nullptr;
+			}
+			state = new(buffer) ThreadState();
+			state->Next = g_ThreadStates.load(std::memory_order_relaxed);
+			while (!g_ThreadStates.compare_exchange_weak(state->Next, state, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		state->ThreadID.store(::GetCurrentThreadId(), std::memory_order_relaxed);
+		state->SampleCountdown = static_cast<int64_t>(g_SampleInterval.load(std::memory_order_relaxed));
+		g_ThreadState = state;
+
+		// Allocations made by the remaining thread-local destructors take a state which is never given back
+		if (!g_IsThreadExiting)
+		{
+			g_Release.State = state;
+		}
+		return state;
+	}
+	ThreadState* GetThreadState() noexcept
+	{
+		return g_ThreadState ? g_ThreadState : AcquireThreadState();
+	}
+
+	uint16_t RecordStack(uint8_t subsystem, size_t size) noexcept
+	{
+		std::array<void*, MemoryTracker::MaxStackDepth> frames;
+		ULONG hash = 0;
+		const uint32_t depth = ::RtlCaptureStackBackTrace(2, static_cast<ULONG>(frames.size()), frames.data(), &hash);
+		if (depth == 0)
+		{
+			return NoStack;
+		}
+		hash = hash != 0 ? hash : 1;
+
+		// Sampling is rare enough for a spin lock, entries are never removed so the index can be kept in the header
+		while (g_StacksLock.test_and_set(std::memory_order_acquire))
+		{
+		}
+
+		uint16_t result = NoStack;
+		for (size_t i = 0; i < StackTableSize; i++)
+		{
+			const size_t index = (hash + i) & (StackTableSize - 1);
+			StackEntry& entry = g_Stacks[index];
+
+			const uint32_t entryHash = entry.Hash.load(std::memory_order_relaxed);
+			if (entryHash == 0)
+			{
+				entry.Depth = depth;
+				entry.Subsystem = subsystem;
+				std::copy_n(frames.begin(), depth, entry.Frames.begin());
+				entry.Hash.store(hash, std::memory_order_release);
+				result = static_cast<uint16_t>(index);
+				break;
+			}
+			else if (entryHash == hash && entry.Depth == depth && entry.Subsystem == subsystem && std::equal(frames.begin(), frames.begin() + depth, entry.Frames.begin()))
+			{
+				result = static_cast<uint16_t>(index);
+				break;
+			}
+		}
+		g_StacksLock.clear(std::memory_order_release);
+
+		if (result != NoStack)
+		{
+			g_Stacks[result].LiveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+			g_Stacks[result].Samples.fetch_add(1, std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+	#if xSE_MEMORY_TRACKING
+	// DbgHelp is resolved at run time instead of being linked, 'InitializeModules' has already loaded it. Other modules of
+	// the process may have their own session on the process handle, so this one is opened on a duplicate which nobody
+	// else knows about, and the process-wide options are left as they are. Unless someone else has enabled line loading
+	// the sites are reported without line numbers.
+	class Symbolizer final
+	{
+		private:
+			decltype(&::SymInitializeW) m_SymInitialize = nullptr;
+			decltype(&::SymCleanup) m_SymCleanup = nullptr;
+			decltype(&::SymFromAddr) m_SymFromAddr = nullptr;
+			decltype(&::SymGetLineFromAddr64) m_SymGetLineFromAddr = nullptr;
+
+			HANDLE m_Process = nullptr;
+			bool m_IsInitialized = false;
+
+		private:
+			template<class T>
+			static bool GetFunction(HMODULE module, const char* name, T& function) noexcept
+			{
+				function = reinterpret_cast<T>(::GetProcAddress(module, name));
+				return function != nullptr;
+			}
+
+		public:
+			Symbolizer() noexcept
+			{
+				HMODULE module = ::GetModuleHandleW(L"DbgHelp.dll");
+				if (module && GetFunction(module, "SymInitializeW", m_SymInitialize) && GetFunction(module, "SymCleanup", m_SymCleanup) && GetFunction(module, "SymFromAddr", m_SymFromAddr) && GetFunction(module, "SymGetLineFromAddr64", m_SymGetLineFromAddr))
+				{
+					const HANDLE process = ::GetCurrentProcess();
+					if (::DuplicateHandle(process, process, process, &m_Process, 0, FALSE, DUPLICATE_SAME_ACCESS))
+					{
+						m_IsInitialized = m_SymInitialize(m_Process, nullptr, TRUE) != FALSE;
+					}
+				}
+			}
+			~Symbolizer()
+			{
+				if (m_IsInitialized)
+				{
+					m_SymCleanup(m_Process);
+				}
+				if (m_Process)
+				{
+					::CloseHandle(m_Process);
+				}
+			}
+
+		public:
+			void Format(std::string& buffer, void* address) const
+			{
+				const DWORD64 value = reinterpret_cast<DWORD64>(address);
+				if (m_IsInitialized)
+				{
+					alignas(SYMBOL_INFO) char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
+					auto symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+					symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+					symbol->MaxNameLen = MAX_SYM_NAME;
+
+					DWORD64 displacement = 0;
+					if (m_SymFromAddr(m_Process, value, &displacement, symbol))
+					{
+						std::format_to(std::back_inserter(buffer), "{}+0x{:X}", std::string_view(symbol->Name, symbol->NameLen), displacement);
+
+						IMAGEHLP_LINE64 line = {};
+						line.SizeOfStruct = sizeof(line);
+						DWORD lineDisplacement = 0;
+						if (m_SymGetLineFromAddr(m_Process, value, &lineDisplacement, &line))
+						{
+							std::format_to(std::back_inserter(buffer), " ({}:{})", line.FileName, line.LineNumber);
+						}
+						return;
+					}
+				}
+
+				// No symbols, module and offset still tell which plugin it is
+				HMODULE module = nullptr;
+				char modulePath[MAX_PATH] = {};
+				if (::GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS|GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, static_cast<LPCSTR>(address), &module) && ::GetModuleFileNameA(module, modulePath, MAX_PATH) != 0)
+				{
+					std::string_view moduleName = modulePath;
+					moduleName = moduleName.substr(moduleName.find_last_of("\\/") + 1);
+					std::format_to(std::back_inserter(buffer), "{}+0x{:X}", moduleName, value - reinterpret_cast<DWORD64>(module));
+				}
+				else
+				{
+					std::format_to(std::back_inserter(buffer), "0x{:X}", value);
+				}
+			}
+	};
+	#endif
+}
+
+namespace xSE
+{
+	MemoryTracker& MemoryTracker::GetInstance() noexcept
+	{
+		static MemoryTracker g_Instance;
+		return g_Instance;
+	}
+
+	void* MemoryTracker::Allocate(size_t size, size_t alignment) noexcept
+	{
+		// The header sits right before the returned block, over-aligned blocks are shifted by a whole alignment unit
+		const bool isAligned = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+		const size_t offset = std::max(alignment, sizeof(AllocationHeader));
+		if (size > std::numeric_limits<size_t>::max() - offset)
+		{
+			return nullptr;
+		}
+
+		auto base = static_cast<std::byte*>(isAligned ? ::_aligned_malloc(size + offset, alignment) : std::malloc(size + offset));
+		if (!base)
+		{
+			return nullptr;
+		}
+		std::byte* data = base + offset;
+
+		AllocationHeader& header = GetHeader(data);
+		header.Cookie = MakeCookie(data);
+		header.Size = size;
+		header.Offset = static_cast<uint32_t>(offset);
+		header.Stack = NoStack;
+		header.Subsystem = g_Subsystem;
+		header.IsAligned = isAligned;
+
+		if (ThreadState* state = GetThreadState())
+		{
+			SubsystemCounters& counters = state->Counters[header.Subsystem];
+			AddRelaxed<uint64_t>(counters.AllocatedBytes, size);
+			AddRelaxed<uint64_t>(counters.Allocations, 1);
+			AddRelaxed<uint64_t>(state->Allocations, 1);
+
+			const int64_t live = state->LiveBytes.load(std::memory_order_relaxed) + static_cast<int64_t>(size);
+			state->LiveBytes.store(live, std::memory_order_relaxed);
+			if (live > state->PeakBytes.load(std::memory_order_relaxed))
+			{
+				state->PeakBytes.store(live, std::memory_order_relaxed);
+			}
+
+			// Sampled by bytes rather than by count so the sampled sites are weighted by what they allocate
+			if (const size_t interval = g_SampleInterval.load(std::memory_order_relaxed); interval != 0 && !state->IsSampling)
+			{
+				state->SampleCountdown -= static_cast<int64_t>(size);
+				if (state->SampleCountdown <= 0)
+				{
+					state->SampleCountdown = static_cast<int64_t>(interval);
+					state->IsSampling = true;
+					header.Stack = RecordStack(header.Subsystem, size);
+					state->IsSampling = false;
+				}
+			}
+		}
+		return data;
+	}
+	void MemoryTracker::Deallocate(void* ptr, bool isAligned) noexcept
+	{
+		if (!ptr)
+		{
+			return;
+		}
+
+		// Blocks allocated by another module and freed here have no header, their cookie won't match. The bytes before
+		// them are only read when they're known to be mapped.
+		if (!IsHeaderReadable(ptr))
+		{
+			isAligned ? ::_aligned_free(ptr) : std::free(ptr);
+			return;
+		}
+
+		AllocationHeader& header = GetHeader(ptr);
+		if (header.Cookie != MakeCookie(ptr))
+		{
+			isAligned ? ::_aligned_free(ptr) : std::free(ptr);
+			return;
+		}
+
+		if (ThreadState* state = GetThreadState())
+		{
+			SubsystemCounters& counters = state->Counters[header.Subsystem];
+			AddRelaxed<uint64_t>(counters.FreedBytes, header.Size);
+			AddRelaxed<uint64_t>(counters.Frees, 1);
+			AddRelaxed<int64_t>(state->LiveBytes, -static_cast<int64_t>(header.Size));
+		}
+		if (header.Stack != NoStack)
+		{
+			g_Stacks[header.Stack].LiveBytes.fetch_sub(static_cast<int64_t>(header.Size), std::memory_order_relaxed);
+		}
+
+		// A stale header left in freed memory mustn't match again
+		std::byte* base = static_cast<std::byte*>(ptr) - header.Offset;
+		const bool isBaseAligned = header.IsAligned;
+		header.Cookie = 0;
+		isBaseAligned ? ::_aligned_free(base) : std::free(base);
+	}
+	uint8_t MemoryTracker::ExchangeSubsystem(uint8_t subsystem) noexcept
+	{
+		return std::exchange(g_Subsystem, subsystem);
+	}
+
+	void MemoryTracker::WriteReport(std::chrono::system_clock::time_point timeStamp)
+	{
+		using namespace std::chrono;
+
+		const auto timeStampMS = duration_cast<milliseconds>(timeStamp.time_since_epoch()).count();
+		const auto now = steady_clock::now();
+		const double seconds = m_LastReportTime != steady_clock::time_point() ? duration<double>(now - m_LastReportTime).count() : 0.0;
+		m_LastReportTime = now;
+
+		std::string buffer;
+		const auto stats = GetStats();
+		for (size_t i = 0; i < stats.size(); i++)
+		{
+			const MemorySubsystemStats& item = stats[i];
+			if (item.Allocations != 0)
+			{
+				const double rate = seconds > 0.0 ? (item.Allocations - m_LastAllocations[i]) / seconds : 0.0;
+				m_LastAllocations[i] = item.Allocations;
+
+				std::format_to(std::back_inserter(buffer), "{},{},{},{},{},{},{},{},{},{:.1f}\n",
+							   timeStampMS,
+							   m_OwnerName,
+							   item.Name,
+							   item.LiveBytes,
+							   item.PeakBytes,
+							   item.AllocatedBytes,
+							   item.FreedBytes,
+							   item.Allocations,
+							   item.Frees,
+							   rate
+				);
+			}
+		}
+		for (const MemoryThreadStats& item: GetThreadStats())
+		{
+			std::format_to(std::back_inserter(buffer), "{},{},thread:{},{},{},,,{},,\n", timeStampMS, m_OwnerName, item.ThreadID, item.LiveBytes, item.PeakBytes, item.Allocations);
+		}
+
+		if (!buffer.empty())
+		{
+			m_ReportingStream->Write(buffer.data(), buffer.size());
+			m_ReportingStream->Flush();
+		}
+		if (m_StackStream)
+		{
+			WriteStackReport(*m_StackStream, timeStamp);
+		}
+	}
+	void MemoryTracker::WriteStackReport(kxf::IOutputStream& stream, std::chrono::system_clock::time_point timeStamp)
+	{
+		using namespace std::chrono;
+
+		// Only the reporting thread symbolizes, DbgHelp isn't thread-safe
+		#if xSE_MEMORY_TRACKING
+		static const Symbolizer g_Symbolizer;
+		#endif
+
+		std::vector<const StackEntry*> entries;
+		for (const StackEntry& entry: g_Stacks)
+		{
+			if (entry.Hash.load(std::memory_order_acquire) != 0 && entry.LiveBytes.load(std::memory_order_relaxed) > 0)
+			{
+				entries.push_back(&entry);
+			}
+		}
+
+		const size_t count = std::min(entries.size(), ReportedStackCount);
+		std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), [](const StackEntry* left, const StackEntry* right)
+		{
+			return left->LiveBytes.load(std::memory_order_relaxed) > right->LiveBytes.load(std::memory_order_relaxed);
+		});
+
+		const auto names = GetStats();
+		std::string buffer;
+		std::format_to(std::back_inserter(buffer), "[{}] {}: {} sampled allocation sites with live bytes, sampled every {} bytes\n",
+					   duration_cast<milliseconds>(timeStamp.time_since_epoch()).count(),
+					   m_OwnerName,
+					   entries.size(),
+					   GetStackSampleInterval()
+		);
+		for (size_t i = 0; i < count; i++)
+		{
+			const StackEntry& entry = *entries[i];
+			std::format_to(std::back_inserter(buffer), "#{} live: {}, samples: {}, subsystem: {}\n",
+						   i + 1,
+						   entry.LiveBytes.load(std::memory_order_relaxed),
+						   entry.Samples.load(std::memory_order_relaxed),
+						   entry.Subsystem < names.size() ? names[entry.Subsystem].Name : "?"
+			);
+			for (uint32_t frame = 0; frame < entry.Depth; frame++)
+			{
+				buffer.append(4, ' ');
+				#if xSE_MEMORY_TRACKING
+				g_Symbolizer.Format(buffer, entry.Frames[frame]);
+				#else
+				std::format_to(std::back_inserter(buffer), "0x{:X}", reinterpret_cast<uintptr_t>(entry.Frames[frame]));
+				#endif
+				buffer += '\n';
+			}
+		}
+		buffer += '\n';
+
+		stream.Write(buffer.data(), buffer.size());
+		stream.Flush();
+	}
+
+	MemoryTracker::~MemoryTracker()
+	{
+		StopReporting();
+	}
+
+	uint8_t MemoryTracker::RegisterSubsystem(const char* name) noexcept
+	{
+		std::lock_guard lock(g_SubsystemsLock);
+
+		const size_t count = g_SubsystemCount.load(std::memory_order_relaxed);
+		for (size_t i = 1; i < count; i++)
+		{
+			if (std::strcmp(g_SubsystemNames[i].load(std::memory_order_relaxed), name) == 0)
+			{
+				return static_cast<uint8_t>(i);
+			}
+		}
+
+		if (count < MaxSubsystems)
+		{
+			g_SubsystemNames[count].store(name, std::memory_order_relaxed);
+			g_SubsystemCount.store(count + 1, std::memory_order_release);
+			return static_cast<uint8_t>(count);
+		}
+		return 0;
+	}
+	void MemoryTracker::SetOwnerName(std::string name)
+	{
+		std::lock_guard lock(m_ReportingLock);
+		m_OwnerName = std::move(name);
+	}
+
+	void MemoryTracker::SetStackSampleInterval(size_t bytes) noexcept
+	{
+		g_SampleInterval.store(bytes, std::memory_order_relaxed);
+	}
+	size_t MemoryTracker::GetStackSampleInterval() const noexcept
+	{
+		return g_SampleInterval.load(std::memory_order_relaxed);
+	}
+
+	std::vector<MemorySubsystemStats> MemoryTracker::GetStats() const
+	{
+		const size_t count = g_SubsystemCount.load(std::memory_order_acquire);
+
+		std::vector<MemorySubsystemStats> stats(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const char* name = g_SubsystemNames[i].load(std::memory_order_relaxed);
+			stats[i].Name = name ? name : "General";
+		}
+		for (const ThreadState* state = g_ThreadStates.load(std::memory_order_acquire); state; state = state->Next)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const SubsystemCounters& counters = state->Counters[i];
+				stats[i].AllocatedBytes += counters.AllocatedBytes.load(std::memory_order_relaxed);
+				stats[i].FreedBytes += counters.FreedBytes.load(std::memory_order_relaxed);
+				stats[i].Allocations += counters.Allocations.load(std::memory_order_relaxed);
+				stats[i].Frees += counters.Frees.load(std::memory_order_relaxed);
+			}
+		}
+
+		std::lock_guard lock(m_StatsLock);
+		for (size_t i = 0; i < count; i++)
+		{
+			MemorySubsystemStats& item = stats[i];
+			item.LiveBytes = static_cast<int64_t>(item.AllocatedBytes - item.FreedBytes);
+			m_SubsystemPeaks[i] = std::max(m_SubsystemPeaks[i], item.LiveBytes);
+			item.PeakBytes = m_SubsystemPeaks[i];
+		}
+		return stats;
+	}
+	std::vector<MemoryThreadStats> MemoryTracker::GetThreadStats() const
+	{
+		std::vector<MemoryThreadStats> stats;
+		for (const ThreadState* state = g_ThreadStates.load(std::memory_order_acquire); state; state = state->Next)
+		{
+			MemoryThreadStats& item = stats.emplace_back();
+			item.ThreadID = state->ThreadID.load(std::memory_order_relaxed);
+			item.LiveBytes = state->LiveBytes.load(std::memory_order_relaxed);
+			item.PeakBytes = state->PeakBytes.load(std::memory_order_relaxed);
+			item.Allocations = state->Allocations.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+
+	bool MemoryTracker::StartReporting(std::unique_ptr<kxf::IOutputStream> stream, std::unique_ptr<kxf::IOutputStream> stackStream, std::chrono::milliseconds interval)
+	{
+		if (!stream || IsReporting())
+		{
+			return false;
+		}
+
+		constexpr std::string_view header = "timestamp,plugin,scope,live,peak,allocated,freed,allocations,frees,rate\n";
+		stream->Write(header.data(), header.size());
+
+		m_ReportingStream = std::move(stream);
+		m_StackStream = std::move(stackStream);
+		m_StopReporting = false;
+		m_ReportingThread = std::thread([this, interval]()
+		{
+			// Whatever the reports themselves allocate is kept apart from the plugin's own subsystems
+			ExchangeSubsystem(RegisterSubsystem("MemoryTracker"));
+
+			std::unique_lock lock(m_ReportingLock);
+			while (!m_StopReporting)
+			{
+				m_ReportingCondition.wait_for(lock, interval, [&]()
+				{
+					return m_StopReporting;
+				});
+				WriteReport(std::chrono::system_clock::now());
+			}
+		});
+		return true;
+	}
+	void MemoryTracker::StopReporting()
+	{
+		if (m_ReportingThread.joinable())
+		{
+			{
+				std::lock_guard lock(m_ReportingLock);
+				m_StopReporting = true;
+			}
+			m_ReportingCondition.notify_all();
+			m_ReportingThread.join();
+
+			m_ReportingStream = nullptr;
+			m_StackStream = nullptr;
+		}
+	}
+}
+
+#if xSE_MEMORY_TRACKING
+namespace
+{
+	void* AllocateOrThrow(size_t size, size_t alignment)
+	{
+		for (;;)
+		{
+			if (void* ptr = MemoryTracker::Allocate(size, alignment))
+			{
+				return ptr;
+			}
+			if (auto handler = std::get_new_handler())
+			{
+				handler();
+			}
+			else
+			{
+				throw std::bad_alloc();
+			}
+		}
+	}
+}
+
+void* operator new(size_t size)
+{
+	return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size)
+{
+	return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete[](void* ptr) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete(void* ptr, size_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete[](void* ptr, size_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Deallocate(ptr, false);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Deallocate(ptr, true);
+}
+#endif
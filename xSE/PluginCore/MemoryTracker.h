@@ -0,0 +1,158 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <condition_variable>
+
+// Set to 1 to replace the global allocation functions of the plugin's module with the counting ones from 'MemoryTracker'
+#ifndef xSE_MEMORY_TRACKING
+#define xSE_MEMORY_TRACKING 0
+#endif
+
+namespace kxf
+{
+	class IOutputStream;
+}
+
+namespace xSE
+{
+	struct MemorySubsystemStats final
+	{
+		const char* Name = nullptr;
+		int64_t LiveBytes = 0;
+		int64_t PeakBytes = 0;
+		uint64_t AllocatedBytes = 0;
+		uint64_t FreedBytes = 0;
+		uint64_t Allocations = 0;
+		uint64_t Frees = 0;
+	};
+	struct MemoryThreadStats final
+	{
+		uint32_t ThreadID = 0;
+		int64_t LiveBytes = 0;
+		int64_t PeakBytes = 0;
+		uint64_t Allocations = 0;
+	};
+}
+
+namespace xSE
+{
+	// Heap accounting for the plugin. Every plugin links its own copy of PluginCore, so with 'xSE_MEMORY_TRACKING' the
+	// replaced 'operator new' and 'operator delete' see exactly the allocations of that plugin's module. Allocations are
+	// attributed to the subsystem of the innermost 'xSE_MEMORY_SCOPE' on the allocating thread and counted in per-thread
+	// counters which only the owning thread writes, frees are counted against the subsystem the block was allocated in.
+	// Optionally every 'N' allocated bytes the call stack is captured and the sampled allocation sites are reported by
+	// their live bytes, symbolized through DbgHelp. Subsystem peaks are sampled when the statistics are read, per-thread
+	// peaks are exact.
+	class xSE_API MemoryTracker final
+	{
+		public:
+			static constexpr size_t MaxSubsystems = 64;
+			static constexpr size_t MaxStackDepth = 24;
+			static constexpr size_t ReportedStackCount = 16;
+
+		public:
+			static MemoryTracker& GetInstance() noexcept;
+			static constexpr bool IsAvailable() noexcept
+			{
+				return xSE_MEMORY_TRACKING != 0;
+			}
+
+			// Used by the replaced allocation functions. 'Allocate' returns null on failure, 'Deallocate' also accepts
+			// blocks allocated by other modules from the shared CRT heap and frees them without counting. Those are told
+			// apart by a cookie in the header before the block, which is only read after checking that it's mapped.
+			static void* Allocate(size_t size, size_t alignment) noexcept;
+			static void Deallocate(void* ptr, bool isAligned) noexcept;
+
+			// Sets the subsystem of the calling thread and returns the previous one
+			static uint8_t ExchangeSubsystem(uint8_t subsystem) noexcept;
+
+		private:
+			std::string m_OwnerName;
+			mutable std::mutex m_StatsLock;
+			mutable std::array<int64_t, MaxSubsystems> m_SubsystemPeaks = {};
+
+			std::thread m_ReportingThread;
+			std::mutex m_ReportingLock;
+			std::condition_variable m_ReportingCondition;
+			std::unique_ptr<kxf::IOutputStream> m_ReportingStream;
+			std::unique_ptr<kxf::IOutputStream> m_StackStream;
+			std::array<uint64_t, MaxSubsystems> m_LastAllocations = {};
+			std::chrono::steady_clock::time_point m_LastReportTime;
+			bool m_StopReporting = false;
+
+		private:
+			void WriteReport(std::chrono::system_clock::time_point timeStamp);
+			void WriteStackReport(kxf::IOutputStream& stream, std::chrono::system_clock::time_point timeStamp);
+
+		public:
+			MemoryTracker() = default;
+			MemoryTracker(const MemoryTracker&) = delete;
+			~MemoryTracker();
+
+		public:
+			// Same name from several places maps to the same subsystem. Returns the general subsystem when the table is full.
+			uint8_t RegisterSubsystem(const char* name) noexcept;
+
+			// Name of the plugin in the reports
+			void SetOwnerName(std::string name);
+
+			// Zero disables stack sampling
+			void SetStackSampleInterval(size_t bytes) noexcept;
+			size_t GetStackSampleInterval() const noexcept;
+
+			std::vector<MemorySubsystemStats> GetStats() const;
+			std::vector<MemoryThreadStats> GetThreadStats() const;
+
+			// Appends a CSV snapshot of all subsystems and threads to 'stream' every 'interval' and, if the stack stream is
+			// given, the allocation sites with the most live sampled bytes to it
+			bool StartReporting(std::unique_ptr<kxf::IOutputStream> stream, std::unique_ptr<kxf::IOutputStream> stackStream, std::chrono::milliseconds interval);
+			void StopReporting();
+			bool IsReporting() const noexcept
+			{
+				return m_ReportingThread.joinable();
+			}
+
+		public:
+			MemoryTracker& operator=(const MemoryTracker&) = delete;
+	};
+
+	class MemoryScope final
+	{
+		private:
+			uint8_t m_Previous = 0;
+
+		public:
+			MemoryScope(uint8_t subsystem) noexcept
+				:m_Previous(MemoryTracker::ExchangeSubsystem(subsystem))
+			{
+			}
+			MemoryScope(const MemoryScope&) = delete;
+			~MemoryScope()
+			{
+				MemoryTracker::ExchangeSubsystem(m_Previous);
+			}
+
+		public:
+			MemoryScope& operator=(const MemoryScope&) = delete;
+	};
+}
+
+#define xSE_MEMORY_CONCAT_(a, b)	a##b
+#define xSE_MEMORY_CONCAT(a, b)		xSE_MEMORY_CONCAT_(a, b)
+
+#if xSE_MEMORY_TRACKING
+
+#define xSE_MEMORY_SCOPE(name)	\
+	static const uint8_t xSE_MEMORY_CONCAT(xSE_MemorySubsystem_, __LINE__) = ::xSE::MemoryTracker::GetInstance().RegisterSubsystem(name);	\
+	::xSE::MemoryScope xSE_MEMORY_CONCAT(xSE_MemoryScope_, __LINE__)(xSE_MEMORY_CONCAT(xSE_MemorySubsystem_, __LINE__))
+
+#else
+
+#define xSE_MEMORY_SCOPE(name)	static_cast<void>(0)
+
+#endif
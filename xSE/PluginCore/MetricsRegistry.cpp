@@ -0,0 +1,361 @@
+#include "pch.hpp"
+#include "MetricsRegistry.h"
+#include <kxf/IO/IStream.h>
+#include <format>
+#include <bit>
+#include <exception>
+
+namespace
+{
+	std::atomic<size_t> g_NextThreadShard = 0;
+
+	template<class T>
+	void StoreMin(std::atomic<T>& target, T value) noexcept
+	{
+		T current = target.load(std::memory_order_relaxed);
+		while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	template<class T>
+	void StoreMax(std::atomic<T>& target, T value) noexcept
+	{
+		T current = target.load(std::memory_order_relaxed);
+		while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	std::string_view GetTypeName(xSE::MetricType type) noexcept
+	{
+		switch (type)
+		{
+			case xSE::MetricType::Counter:
+			{
+				return "counter";
+			}
+			case xSE::MetricType::Gauge:
+			{
+				return "gauge";
+			}
+			case xSE::MetricType::Histogram:
+			{
+				return "histogram";
+			}
+		};
+		return {};
+	}
+}
+
+namespace xSE::Metrics
+{
+	size_t GetThreadShard() noexcept
+	{
+		thread_local const size_t shard = g_NextThreadShard.fetch_add(1, std::memory_order_relaxed) % ShardCount;
+		return shard;
+	}
+}
+
+namespace xSE
+{
+	uint64_t MetricCounter::GetValue() const noexcept
+	{
+		uint64_t value = 0;
+		for (const auto& shard: m_Shards)
+		{
+			value += shard.Value.load(std::memory_order_relaxed);
+		}
+		return value;
+	}
+}
+
+namespace xSE
+{
+	uint64_t MetricHistogram::Snapshot::GetPercentile(double percentile) const noexcept
+	{
+		if (Count == 0)
+		{
+			return 0;
+		}
+
+		const uint64_t target = static_cast<uint64_t>(std::ceil(Count * std::clamp(percentile, 0.0, 100.0) / 100.0));
+		uint64_t accumulated = 0;
+		for (size_t i = 0; i < Buckets.size(); i++)
+		{
+			accumulated += Buckets[i];
+			if (accumulated >= target && accumulated != 0)
+			{
+				// Report the upper edge of the bucket but never more than the largest recorded value
+				return std::min(i + 1 < Buckets.size() ? GetBucketValue(i + 1) - 1 : GetBucketValue(i), Max);
+			}
+		}
+		return Max;
+	}
+
+	size_t MetricHistogram::GetBucketIndex(uint64_t value) noexcept
+	{
+		if (value < SubBucketCount)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		const size_t exponent = std::bit_width(value) - 1;
+		if (exponent >= MaxValueBits)
+		{
+			return BucketCount - 1;
+		}
+
+		const size_t mantissa = static_cast<size_t>(value >> (exponent - SubBucketBits));
+		return (exponent - SubBucketBits + 1) * SubBucketCount + (mantissa - SubBucketCount);
+	}
+	uint64_t MetricHistogram::GetBucketValue(size_t index) noexcept
+	{
+		if (index < SubBucketCount)
+		{
+			return index;
+		}
+
+		const size_t exponent = index / SubBucketCount + SubBucketBits - 1;
+		const uint64_t mantissa = index % SubBucketCount + SubBucketCount;
+		return mantissa << (exponent - SubBucketBits);
+	}
+
+	void MetricHistogram::Record(uint64_t value) noexcept
+	{
+		Shard& shard = m_Shards[Metrics::GetThreadShard()];
+		shard.Count.fetch_add(1, std::memory_order_relaxed);
+		shard.Sum.fetch_add(value, std::memory_order_relaxed);
+		shard.Buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		StoreMin(shard.Min, value);
+		StoreMax(shard.Max, value);
+	}
+	auto MetricHistogram::GetSnapshot() const noexcept -> Snapshot
+	{
+		Snapshot snapshot;
+		snapshot.Min = std::numeric_limits<uint64_t>::max();
+
+		for (const Shard& shard: m_Shards)
+		{
+			snapshot.Count += shard.Count.load(std::memory_order_relaxed);
+			snapshot.Sum += shard.Sum.load(std::memory_order_relaxed);
+			snapshot.Min = std::min(snapshot.Min, shard.Min.load(std::memory_order_relaxed));
+			snapshot.Max = std::max(snapshot.Max, shard.Max.load(std::memory_order_relaxed));
+
+			for (size_t i = 0; i < BucketCount; i++)
+			{
+				snapshot.Buckets[i] += shard.Buckets[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		if (snapshot.Count == 0)
+		{
+			snapshot.Min = 0;
+		}
+		return snapshot;
+	}
+}
+
+namespace xSE
+{
+	auto MetricsRegistry::GetItem(Symbol name, MetricType type) -> Item&
+	{
+		std::lock_guard lock(m_ItemsLock);
+
+		auto [it, inserted] = m_Items.try_emplace(name);
+		Item& item = it->second;
+		if (inserted)
+		{
+			item.Name = name;
+			item.Type = type;
+			m_Order.emplace_back(name);
+		}
+
+		// A name has one type for good, asking for another one is a programming error. Handing out a second object which
+		// is never reported would only hide it.
+		if (item.Type != type)
+		{
+			std::terminate();
+		}
+
+		switch (type)
+		{
+			case MetricType::Counter:
+			{
+				if (!item.Counter)
+				{
+					item.Counter = std::make_unique<MetricCounter>();
+				}
+				break;
+			}
+			case MetricType::Gauge:
+			{
+				if (!item.Gauge)
+				{
+					item.Gauge = std::make_unique<MetricGauge>();
+				}
+				break;
+			}
+			case MetricType::Histogram:
+			{
+				if (!item.Histogram)
+				{
+					item.Histogram = std::make_unique<MetricHistogram>();
+				}
+				break;
+			}
+		};
+		return item;
+	}
+	void MetricsRegistry::WriteReport(kxf::IOutputStream& stream, std::chrono::system_clock::time_point timeStamp)
+	{
+		using namespace std::chrono;
+
+		const auto timeStampMS = duration_cast<milliseconds>(timeStamp.time_since_epoch()).count();
+
+		std::string buffer;
+		std::lock_guard lock(m_ItemsLock);
+		for (Symbol name: m_Order)
+		{
+			Item& item = m_Items.at(name);
+			switch (item.Type)
+			{
+				case MetricType::Counter:
+				{
+					const uint64_t value = item.Counter->GetValue();
+					std::format_to(std::back_inserter(buffer), "{},{},{},{},{},,,,,,,\n", timeStampMS, name.GetString(), GetTypeName(item.Type), value, value - item.LastCounterValue);
+					item.LastCounterValue = value;
+					break;
+				}
+				case MetricType::Gauge:
+				{
+					std::format_to(std::back_inserter(buffer), "{},{},{},{},,,,,,,,\n", timeStampMS, name.GetString(), GetTypeName(item.Type), item.Gauge->GetValue());
+					break;
+				}
+				case MetricType::Histogram:
+				{
+					auto snapshot = item.Histogram->GetSnapshot();
+					std::format_to(std::back_inserter(buffer), "{},{},{},,,{},{},{:.1f},{},{},{},{}\n",
+								   timeStampMS,
+								   name.GetString(),
+								   GetTypeName(item.Type),
+								   snapshot.Count,
+								   snapshot.Sum,
+								   snapshot.GetMean(),
+								   snapshot.GetPercentile(50),
+								   snapshot.GetPercentile(90),
+								   snapshot.GetPercentile(99),
+								   snapshot.Max
+					);
+					break;
+				}
+			};
+		}
+
+		if (!buffer.empty())
+		{
+			stream.Write(buffer.data(), buffer.size());
+			stream.Flush();
+		}
+	}
+
+	MetricsRegistry::~MetricsRegistry()
+	{
+		StopReporting();
+	}
+
+	MetricCounter& MetricsRegistry::GetCounter(Symbol name)
+	{
+		return *GetItem(name, MetricType::Counter).Counter;
+	}
+	MetricGauge& MetricsRegistry::GetGauge(Symbol name)
+	{
+		return *GetItem(name, MetricType::Gauge).Gauge;
+	}
+	MetricHistogram& MetricsRegistry::GetHistogram(Symbol name)
+	{
+		return *GetItem(name, MetricType::Histogram).Histogram;
+	}
+
+	std::vector<MetricValue> MetricsRegistry::GetValues() const
+	{
+		std::lock_guard lock(m_ItemsLock);
+
+		std::vector<MetricValue> values;
+		values.reserve(m_Order.size());
+		for (Symbol name: m_Order)
+		{
+			const Item& item = m_Items.at(name);
+
+			MetricValue& value = values.emplace_back();
+			value.Name = name;
+			value.Type = item.Type;
+			switch (item.Type)
+			{
+				case MetricType::Counter:
+				{
+					value.Value = static_cast<int64_t>(item.Counter->GetValue());
+					break;
+				}
+				case MetricType::Gauge:
+				{
+					value.Value = item.Gauge->GetValue();
+					break;
+				}
+				case MetricType::Histogram:
+				{
+					auto snapshot = item.Histogram->GetSnapshot();
+					value.Count = snapshot.Count;
+					value.Sum = snapshot.Sum;
+					value.P50 = snapshot.GetPercentile(50);
+					value.P90 = snapshot.GetPercentile(90);
+					value.P99 = snapshot.GetPercentile(99);
+					value.Max = snapshot.Max;
+					break;
+				}
+			};
+		}
+		return values;
+	}
+
+	bool MetricsRegistry::StartReporting(std::unique_ptr<kxf::IOutputStream> stream, std::chrono::milliseconds interval)
+	{
+		if (!stream || IsReporting())
+		{
+			return false;
+		}
+
+		constexpr std::string_view header = "timestamp,name,type,value,delta,count,sum,mean,p50,p90,p99,max\n";
+		stream->Write(header.data(), header.size());
+
+		m_ReportingStream = std::move(stream);
+		m_StopReporting = false;
+		m_ReportingThread = std::thread([this, interval]()
+		{
+			std::unique_lock lock(m_ReportingLock);
+			while (!m_StopReporting)
+			{
+				m_ReportingCondition.wait_for(lock, interval, [&]()
+				{
+					return m_StopReporting;
+				});
+				WriteReport(*m_ReportingStream, std::chrono::system_clock::now());
+			}
+		});
+		return true;
+	}
+	void MetricsRegistry::StopReporting()
+	{
+		if (m_ReportingThread.joinable())
+		{
+			{
+				std::lock_guard lock(m_ReportingLock);
+				m_StopReporting = true;
+			}
+			m_ReportingCondition.notify_all();
+			m_ReportingThread.join();
+
+			m_ReportingStream = nullptr;
+		}
+	}
+}
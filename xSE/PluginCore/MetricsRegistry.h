@@ -0,0 +1,235 @@
+#pragma once
+#include "Framework.hpp"
+#include "SymbolTable.h"
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace kxf
+{
+	class IOutputStream;
+}
+
+namespace xSE::Metrics
+{
+	inline constexpr size_t ShardCount = 8;
+
+	// Index of the shard used by the calling thread, threads are spread over the shards in the order they first touch a metric
+	xSE_API size_t GetThreadShard() noexcept;
+
+	template<class T>
+	struct alignas(64) PaddedAtomic final
+	{
+		std::atomic<T> Value = 0;
+	};
+}
+
+namespace xSE
+{
+	class xSE_API MetricCounter final
+	{
+		private:
+			std::array<Metrics::PaddedAtomic<uint64_t>, Metrics::ShardCount> m_Shards;
+
+		public:
+			void Add(uint64_t value = 1) noexcept
+			{
+				m_Shards[Metrics::GetThreadShard()].Value.fetch_add(value, std::memory_order_relaxed);
+			}
+			uint64_t GetValue() const noexcept;
+	};
+
+	class xSE_API MetricGauge final
+	{
+		private:
+			std::atomic<int64_t> m_Value = 0;
+
+		public:
+			void Set(int64_t value) noexcept
+			{
+				m_Value.store(value, std::memory_order_relaxed);
+			}
+			void Add(int64_t value) noexcept
+			{
+				m_Value.fetch_add(value, std::memory_order_relaxed);
+			}
+			int64_t GetValue() const noexcept
+			{
+				return m_Value.load(std::memory_order_relaxed);
+			}
+	};
+
+	// Log-linear histogram in the spirit of HdrHistogram: every power of two is split into 'SubBucketCount' linear buckets,
+	// which bounds the relative error of any reported value to 1/SubBucketCount. Values are expected in nanoseconds.
+	class xSE_API MetricHistogram final
+	{
+		public:
+			static constexpr size_t SubBucketBits = 3;
+			static constexpr size_t SubBucketCount = 1 << SubBucketBits;
+			static constexpr size_t MaxValueBits = 42;
+			static constexpr size_t BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+			struct Snapshot final
+			{
+				uint64_t Count = 0;
+				uint64_t Sum = 0;
+				uint64_t Min = 0;
+				uint64_t Max = 0;
+				std::array<uint64_t, BucketCount> Buckets = {};
+
+				uint64_t GetPercentile(double percentile) const noexcept;
+				double GetMean() const noexcept
+				{
+					return Count != 0 ? static_cast<double>(Sum) / Count : 0.0;
+				}
+			};
+
+		public:
+			static size_t GetBucketIndex(uint64_t value) noexcept;
+			static uint64_t GetBucketValue(size_t index) noexcept;
+
+		private:
+			struct alignas(64) Shard final
+			{
+				std::atomic<uint64_t> Count = 0;
+				std::atomic<uint64_t> Sum = 0;
+				std::atomic<uint64_t> Min = std::numeric_limits<uint64_t>::max();
+				std::atomic<uint64_t> Max = 0;
+				std::array<std::atomic<uint64_t>, BucketCount> Buckets = {};
+			};
+
+		private:
+			std::array<Shard, Metrics::ShardCount> m_Shards;
+
+		public:
+			void Record(uint64_t value) noexcept;
+			void Record(std::chrono::nanoseconds value) noexcept
+			{
+				Record(static_cast<uint64_t>(std::max<int64_t>(value.count(), 0)));
+			}
+			Snapshot GetSnapshot() const noexcept;
+	};
+
+	// Records the lifetime of the scope into a histogram
+	class MetricScopedTimer final
+	{
+		private:
+			MetricHistogram& m_Histogram;
+			std::chrono::steady_clock::time_point m_Start;
+
+		public:
+			MetricScopedTimer(MetricHistogram& histogram) noexcept
+				:m_Histogram(histogram), m_Start(std::chrono::steady_clock::now())
+			{
+			}
+			MetricScopedTimer(const MetricScopedTimer&) = delete;
+			~MetricScopedTimer()
+			{
+				m_Histogram.Record(std::chrono::steady_clock::now() - m_Start);
+			}
+
+		public:
+			MetricScopedTimer& operator=(const MetricScopedTimer&) = delete;
+	};
+}
+
+namespace xSE
+{
+	enum class MetricType
+	{
+		Counter,
+		Gauge,
+		Histogram
+	};
+
+	// Point-in-time value of a metric, histogram values are in nanoseconds
+	struct MetricValue final
+	{
+		Symbol Name;
+		MetricType Type = MetricType::Counter;
+		int64_t Value = 0;
+
+		uint64_t Count = 0;
+		uint64_t Sum = 0;
+		uint64_t P50 = 0;
+		uint64_t P90 = 0;
+		uint64_t P99 = 0;
+		uint64_t Max = 0;
+	};
+
+	// Owns all metrics of the plugin. Registration takes a lock and returns a reference which stays valid for the lifetime
+	// of the registry, so it should be done once and the reference kept around. Updates never lock.
+	class xSE_API MetricsRegistry final
+	{
+		private:
+			struct Item final
+			{
+				Symbol Name;
+				MetricType Type = MetricType::Counter;
+				std::unique_ptr<MetricCounter> Counter;
+				std::unique_ptr<MetricGauge> Gauge;
+				std::unique_ptr<MetricHistogram> Histogram;
+				uint64_t LastCounterValue = 0;
+			};
+
+		private:
+			mutable std::mutex m_ItemsLock;
+			std::unordered_map<Symbol, Item> m_Items;
+			std::vector<Symbol> m_Order;
+
+			std::thread m_ReportingThread;
+			std::mutex m_ReportingLock;
+			std::condition_variable m_ReportingCondition;
+			std::unique_ptr<kxf::IOutputStream> m_ReportingStream;
+			bool m_StopReporting = false;
+
+		private:
+			Item& GetItem(Symbol name, MetricType type);
+			void WriteReport(kxf::IOutputStream& stream, std::chrono::system_clock::time_point timeStamp);
+
+		public:
+			MetricsRegistry() = default;
+			MetricsRegistry(const MetricsRegistry&) = delete;
+			~MetricsRegistry();
+
+		public:
+			// Creates the metric on first use. A name belongs to the type it was first requested with, requesting it
+			// with another type terminates.
+			MetricCounter& GetCounter(Symbol name);
+			MetricCounter& GetCounter(std::string_view name)
+			{
+				return GetCounter(SymbolTable::GetInstance().Intern(name));
+			}
+
+			MetricGauge& GetGauge(Symbol name);
+			MetricGauge& GetGauge(std::string_view name)
+			{
+				return GetGauge(SymbolTable::GetInstance().Intern(name));
+			}
+
+			MetricHistogram& GetHistogram(Symbol name);
+			MetricHistogram& GetHistogram(std::string_view name)
+			{
+				return GetHistogram(SymbolTable::GetInstance().Intern(name));
+			}
+
+			// Current values of all metrics in registration order
+			std::vector<MetricValue> GetValues() const;
+
+			// Starts a background thread which aggregates all shards every 'interval' and appends a snapshot to the stream as CSV
+			bool StartReporting(std::unique_ptr<kxf::IOutputStream> stream, std::chrono::milliseconds interval);
+			void StopReporting();
+			bool IsReporting() const noexcept
+			{
+				return m_ReportingThread.joinable();
+			}
+
+		public:
+			MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+	};
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "ScaleformBridge.h"
+#include <string>
+#include <algorithm>
+#include <vector>
+
+namespace xSE
+{
+	// Backend which records every call instead of talking to a movie, for testing the bindings outside of the game.
+	// Values are only tracked by handle, released handles are reused like the GFx backend does.
+	class MockScaleformBackend final: public IScaleformBackend
+	{
+		public:
+			enum class CallType
+			{
+				CreateObject,
+				CreateArray,
+				ReleaseValue,
+				SetMember,
+				SetMemberHandle,
+				SetArraySize,
+				SetElement
+			};
+			struct Call final
+			{
+				CallType Type = CallType::CreateObject;
+				Handle Target = InvalidHandle;
+				std::string Name;
+				ScaleformValueType ValueType = ScaleformValueType::Undefined;
+				std::string Value;
+				Handle ValueHandle = InvalidHandle;
+				size_t Index = 0;
+			};
+
+		private:
+			std::vector<Call> m_Calls;
+			std::vector<bool> m_IsLive;
+			std::vector<Handle> m_FreeHandles;
+
+		private:
+			Handle AllocateHandle()
+			{
+				if (!m_FreeHandles.empty())
+				{
+					Handle handle = m_FreeHandles.back();
+					m_FreeHandles.pop_back();
+					m_IsLive[handle] = true;
+
+					return handle;
+				}
+				m_IsLive.push_back(true);
+				return static_cast<Handle>(m_IsLive.size() - 1);
+			}
+
+		public:
+			const std::vector<Call>& GetCalls() const noexcept
+			{
+				return m_Calls;
+			}
+			size_t CountCalls(CallType type) const noexcept
+			{
+				return std::ranges::count(m_Calls, type, &Call::Type);
+			}
+			size_t GetLiveCount() const noexcept
+			{
+				return std::ranges::count(m_IsLive, true);
+			}
+			bool IsLive(Handle handle) const noexcept
+			{
+				return handle < m_IsLive.size() && m_IsLive[handle];
+			}
+			void ClearCalls() noexcept
+			{
+				m_Calls.clear();
+			}
+
+		public:
+			// IScaleformBackend
+			Handle CreateObject() override
+			{
+				Handle handle = AllocateHandle();
+				m_Calls.push_back({.Type = CallType::CreateObject, .Target = handle});
+				return handle;
+			}
+			Handle CreateArray() override
+			{
+				Handle handle = AllocateHandle();
+				m_Calls.push_back({.Type = CallType::CreateArray, .Target = handle});
+				return handle;
+			}
+			void ReleaseValue(Handle handle) override
+			{
+				m_Calls.push_back({.Type = CallType::ReleaseValue, .Target = handle});
+				if (IsLive(handle))
+				{
+					m_IsLive[handle] = false;
+					m_FreeHandles.push_back(handle);
+				}
+			}
+
+			void SetMember(Handle object, const char* name, const ScaleformValue& value) override
+			{
+				Call call = {.Type = CallType::SetMember, .Target = object, .Name = name, .ValueType = value.Type};
+				switch (value.Type)
+				{
+					case ScaleformValueType::Bool:
+					{
+						call.Value = value.Bool ? "true" : "false";
+						break;
+					}
+					case ScaleformValueType::Number:
+					{
+						call.Value = std::to_string(value.Number);
+						break;
+					}
+					case ScaleformValueType::String:
+					{
+						call.Value = value.String;
+						break;
+					}
+				};
+				m_Calls.push_back(std::move(call));
+			}
+			void SetMember(Handle object, const char* name, Handle value) override
+			{
+				m_Calls.push_back({.Type = CallType::SetMemberHandle, .Target = object, .Name = name, .ValueHandle = value});
+			}
+
+			void SetArraySize(Handle array, size_t size) override
+			{
+				m_Calls.push_back({.Type = CallType::SetArraySize, .Target = array, .Index = size});
+			}
+			void SetElement(Handle array, size_t index, Handle value) override
+			{
+				m_Calls.push_back({.Type = CallType::SetElement, .Target = array, .ValueHandle = value, .Index = index});
+			}
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstdarg>
+#include <atomic>
+
+// Minimal stand-in for a script extender SDK. Selected with 'xSE_PLATFORM_MOCK' and used by the host-side tools which
+// drive PluginCore without a game. Only the parts PluginCore actually touches are mirrored here.
+
+#define MOCKSE_VERSION_INTEGER	0x01000000
+
+using PluginHandle = uint32_t;
+
+struct PluginInfo
+{
+	enum
+	{
+		kInfoVersion = 1
+	};
+
+	uint32_t infoVersion = 0;
+	const char* name = nullptr;
+	uint32_t version = 0;
+};
+
+struct MockSEInterface
+{
+	uint32_t mockseVersion = MOCKSE_VERSION_INTEGER;
+	uint32_t runtimeVersion = 0;
+	uint32_t editorVersion = 0;
+	uint32_t isEditor = 0;
+	PluginHandle(*GetPluginHandle)() = []() -> PluginHandle
+	{
+		return 0;
+	};
+};
+
+namespace xSE::Mock
+{
+	inline std::atomic<size_t> g_MessageCount = 0;
+}
+
+// The real SDK formats into its own log file, formatting is kept so the cost is comparable but nothing is written
+inline void _MESSAGE(const char* format, ...)
+{
+	char buffer[1024];
+
+	va_list args;
+	va_start(args, format);
+	std::vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	xSE::Mock::g_MessageCount.fetch_add(1, std::memory_order_relaxed);
+}
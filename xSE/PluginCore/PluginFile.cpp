@@ -0,0 +1,296 @@
+#include "pch.hpp"
+#include "PluginFile.h"
+#include "DataPath.h"
+#include <zlib.h>
+#include <algorithm>
+#include <optional>
+#include <cstring>
+
+namespace
+{
+	using xSE::RecordSignature;
+
+	constexpr RecordSignature g_FileHeaderType = "TES4";
+	constexpr RecordSignature g_GroupType = "GRUP";
+
+	// Larger sizes are treated as corrupted data rather than allocated
+	constexpr uint32_t MaxDecompressedSize = 256 * 1024 * 1024;
+
+	// The games only nest groups a few levels deep (world space children, blocks, sub-blocks, cell children and their
+	// temporary or persistent groups), anything deeper is treated as corrupted data rather than recursed into.
+	constexpr size_t MaxGroupDepth = 16;
+
+	struct RecordHeader final
+	{
+		uint32_t Type = 0;
+		uint32_t DataSize = 0;
+		uint32_t Flags = 0;
+		uint32_t FormID = 0;
+		uint32_t VersionControl = 0;
+		uint16_t Version = 0;
+		uint16_t Unknown = 0;
+	};
+	struct GroupHeader final
+	{
+		uint32_t Type = 0;
+		uint32_t GroupSize = 0;
+		uint32_t Label = 0;
+		int32_t GroupType = 0;
+		uint32_t VersionControl = 0;
+		uint32_t Unknown = 0;
+	};
+	static_assert(sizeof(RecordHeader) == 24 && sizeof(GroupHeader) == 24);
+
+	template<class T>
+	bool ReadHeader(std::span<const std::byte> data, size_t offset, T& header) noexcept
+	{
+		if (offset <= data.size() && sizeof(T) <= data.size() - offset)
+		{
+			std::memcpy(&header, data.data() + offset, sizeof(T));
+			return true;
+		}
+		return false;
+	}
+
+	bool HasExtension(std::string_view name, std::string_view extension) noexcept
+	{
+		return name.size() > extension.size() && xSE::DataPath::EqualsNormalized(name.substr(name.size() - extension.size()), extension);
+	}
+}
+
+namespace xSE
+{
+	void SubrecordIterator::ReadCurrent() noexcept
+	{
+		m_Current = {};
+
+		// 'XXXX' carries the size of the next subrecord when it doesn't fit into 16 bits
+		std::optional<uint32_t> sizeOverride;
+		while (m_Offset < m_Data.size())
+		{
+			uint32_t type = 0;
+			uint16_t size = 0;
+			if (m_Data.size() - m_Offset < sizeof(type) + sizeof(size))
+			{
+				break;
+			}
+			std::memcpy(&type, m_Data.data() + m_Offset, sizeof(type));
+			std::memcpy(&size, m_Data.data() + m_Offset + sizeof(type), sizeof(size));
+			m_Offset += sizeof(type) + sizeof(size);
+
+			const size_t dataSize = sizeOverride.value_or(size);
+			if (dataSize > m_Data.size() - m_Offset)
+			{
+				break;
+			}
+
+			if (type == RecordSignature("XXXX").Value && size == sizeof(uint32_t))
+			{
+				uint32_t value = 0;
+				std::memcpy(&value, m_Data.data() + m_Offset, sizeof(value));
+				sizeOverride = value;
+				m_Offset += sizeof(value);
+				continue;
+			}
+
+			m_Current = {type, m_Data.subspan(m_Offset, dataSize)};
+			m_Offset += dataSize;
+			return;
+		}
+
+		// Malformed tails end the iteration
+		m_Offset = m_Data.size();
+	}
+
+	SubrecordView RecordView::FindSubrecord(RecordSignature type) const noexcept
+	{
+		for (const SubrecordView& subrecord: *this)
+		{
+			if (subrecord.Type == type)
+			{
+				return subrecord;
+			}
+		}
+		return {};
+	}
+
+	bool PluginFileVisitor::IsTypeVisited(RecordSignature type) const noexcept
+	{
+		return Types.empty() || std::find(Types.begin(), Types.end(), type) != Types.end();
+	}
+}
+
+namespace xSE
+{
+	bool PluginFile::Parse()
+	{
+		const std::span<const std::byte> data = m_File.GetView();
+
+		RecordHeader header;
+		if (!ReadHeader(data, 0, header) || header.Type != g_FileHeaderType.Value || (header.Flags & static_cast<uint32_t>(RecordFlag::Compressed)))
+		{
+			return false;
+		}
+		if (header.DataSize > data.size() - sizeof(header))
+		{
+			return false;
+		}
+		m_Header = RecordView(header.Type, header.Flags, header.FormID, header.Version, data.subspan(sizeof(header), header.DataSize));
+
+		for (const SubrecordView& subrecord: m_Header)
+		{
+			if (subrecord.Type == RecordSignature("MAST"))
+			{
+				m_Masters.emplace_back(subrecord.GetString());
+			}
+		}
+		m_IsMaster = m_Header.HasFlag(RecordFlag::Master) || HasExtension(m_Name, ".esm") || HasExtension(m_Name, ".esl");
+		m_IsLight = m_Header.HasFlag(RecordFlag::Light) || HasExtension(m_Name, ".esl");
+
+		// Everything after the header is a sequence of top-level groups, only their headers are read here
+		size_t offset = sizeof(header) + header.DataSize;
+		while (offset < data.size())
+		{
+			GroupHeader group;
+			if (!ReadHeader(data, offset, group) || group.Type != g_GroupType.Value || group.GroupSize < sizeof(group) || group.GroupSize > data.size() - offset)
+			{
+				return false;
+			}
+
+			m_Groups.push_back({group.Label, static_cast<uint32_t>(offset), group.GroupSize});
+			offset += group.GroupSize;
+		}
+		return true;
+	}
+	bool PluginFile::VisitRange(std::span<const std::byte> data, const PluginFileVisitor& visitor, bool& isDecoded, size_t depth) const
+	{
+		// A compressed record which can't be inflated doesn't break the structure, the rest of the range is still
+		// visited but the file is reported as failed.
+		size_t offset = 0;
+		while (offset < data.size())
+		{
+			RecordHeader header;
+			if (!ReadHeader(data, offset, header))
+			{
+				return false;
+			}
+
+			if (header.Type == g_GroupType.Value)
+			{
+				// Nested groups, for example cell children or world space blocks
+				const uint32_t groupSize = header.DataSize;
+				if (groupSize < sizeof(GroupHeader) || groupSize > data.size() - offset || depth >= MaxGroupDepth)
+				{
+					return false;
+				}
+				if (!VisitRange(data.subspan(offset + sizeof(GroupHeader), groupSize - sizeof(GroupHeader)), visitor, isDecoded, depth + 1))
+				{
+					return false;
+				}
+				offset += groupSize;
+				continue;
+			}
+
+			if (header.DataSize > data.size() - offset - sizeof(header))
+			{
+				return false;
+			}
+			const std::span<const std::byte> recordData = data.subspan(offset + sizeof(header), header.DataSize);
+			offset += sizeof(header) + header.DataSize;
+
+			if (!visitor.IsTypeVisited(header.Type))
+			{
+				continue;
+			}
+
+			if (header.Flags & static_cast<uint32_t>(RecordFlag::Compressed))
+			{
+				// Decompressed size followed by a zlib stream. The buffer is reused by every record this thread visits.
+				thread_local std::vector<std::byte> buffer;
+
+				uint32_t size = 0;
+				if (recordData.size() < sizeof(size))
+				{
+					isDecoded = false;
+					continue;
+				}
+				std::memcpy(&size, recordData.data(), sizeof(size));
+				if (size > MaxDecompressedSize)
+				{
+					isDecoded = false;
+					continue;
+				}
+				if (buffer.size() < size)
+				{
+					buffer.resize(size);
+				}
+
+				uLongf destinationSize = size;
+				const auto source = recordData.subspan(sizeof(size));
+				if (::uncompress(reinterpret_cast<Bytef*>(buffer.data()), &destinationSize, reinterpret_cast<const Bytef*>(source.data()), static_cast<uLong>(source.size())) != Z_OK)
+				{
+					isDecoded = false;
+					continue;
+				}
+				visitor.OnRecord(*this, RecordView(header.Type, header.Flags, header.FormID, header.Version, {buffer.data(), static_cast<size_t>(destinationSize)}));
+			}
+			else
+			{
+				visitor.OnRecord(*this, RecordView(header.Type, header.Flags, header.FormID, header.Version, recordData));
+			}
+		}
+		return true;
+	}
+
+	bool PluginFile::Open(const kxf::FSPath& path)
+	{
+		if (!IsOpen() && m_File.Open(path))
+		{
+			m_Name = path.GetName().ToUTF8();
+			if (Parse())
+			{
+				return true;
+			}
+
+			m_File.Close();
+			m_Name.clear();
+			m_Header = {};
+			m_Masters.clear();
+			m_Groups.clear();
+		}
+		return false;
+	}
+
+	bool PluginFile::IsGroupVisited(const TopGroup& group, const PluginFileVisitor& visitor) const noexcept
+	{
+		// Groups which nest other record types (references, navmeshes, dialogue responses) are always walked
+		constexpr RecordSignature containers[] = {"CELL", "WRLD", "DIAL", "QUST"};
+		return visitor.IsTypeVisited(group.Label) || std::find(std::begin(containers), std::end(containers), group.Label) != std::end(containers);
+	}
+	bool PluginFile::VisitGroup(const TopGroup& group, const PluginFileVisitor& visitor) const
+	{
+		if (visitor.OnRecord)
+		{
+			bool isDecoded = true;
+			return VisitRange(m_File.GetView(group.Offset + sizeof(GroupHeader), group.Size - sizeof(GroupHeader)), visitor, isDecoded) && isDecoded;
+		}
+		return true;
+	}
+	bool PluginFile::Visit(const PluginFileVisitor& visitor) const
+	{
+		if (visitor.OnFile && !visitor.OnFile(*this))
+		{
+			return true;
+		}
+
+		bool result = true;
+		for (const TopGroup& group: m_Groups)
+		{
+			if (IsGroupVisited(group, visitor))
+			{
+				result = VisitGroup(group, visitor) && result;
+			}
+		}
+		return result;
+	}
+}
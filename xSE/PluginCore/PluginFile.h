@@ -0,0 +1,285 @@
+#pragma once
+#include "Framework.hpp"
+#include "MappedFile.h"
+#include <kxf/FileSystem/FSPath.h>
+#include <span>
+#include <string>
+#include <vector>
+#include <functional>
+#include <string_view>
+
+namespace xSE
+{
+	// Four character code of a record, group or subrecord type as stored in the file
+	struct RecordSignature final
+	{
+		uint32_t Value = 0;
+
+		constexpr RecordSignature() noexcept = default;
+		constexpr RecordSignature(uint32_t value) noexcept
+			:Value(value)
+		{
+		}
+		constexpr RecordSignature(const char (&name)[5]) noexcept
+			:Value(uint32_t(uint8_t(name[0]))|(uint32_t(uint8_t(name[1])) << 8)|(uint32_t(uint8_t(name[2])) << 16)|(uint32_t(uint8_t(name[3])) << 24))
+		{
+		}
+
+		std::string ToString() const
+		{
+			return {static_cast<char>(Value), static_cast<char>(Value >> 8), static_cast<char>(Value >> 16), static_cast<char>(Value >> 24)};
+		}
+		constexpr bool operator==(const RecordSignature&) const noexcept = default;
+	};
+
+	enum class RecordFlag: uint32_t
+	{
+		None = 0,
+
+		Master = 0x00000001,
+		Deleted = 0x00000020,
+		Localized = 0x00000080,
+		Light = 0x00000200,
+		Compressed = 0x00040000
+	};
+}
+
+namespace xSE
+{
+	struct SubrecordView final
+	{
+		RecordSignature Type;
+		std::span<const std::byte> Data;
+
+		// For string subrecords, up to the null terminator
+		std::string_view GetString() const noexcept
+		{
+			const std::string_view value(reinterpret_cast<const char*>(Data.data()), Data.size());
+			return value.substr(0, value.find('\0'));
+		}
+	};
+
+	class xSE_API SubrecordIterator final
+	{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = SubrecordView;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const SubrecordView*;
+			using reference = const SubrecordView&;
+
+		private:
+			std::span<const std::byte> m_Data;
+			size_t m_Offset = 0;
+			SubrecordView m_Current;
+
+		private:
+			void ReadCurrent() noexcept;
+
+		public:
+			SubrecordIterator() noexcept = default;
+			SubrecordIterator(std::span<const std::byte> data) noexcept
+				:m_Data(data)
+			{
+				ReadCurrent();
+			}
+
+		public:
+			const SubrecordView& operator*() const noexcept
+			{
+				return m_Current;
+			}
+			const SubrecordView* operator->() const noexcept
+			{
+				return &m_Current;
+			}
+			SubrecordIterator& operator++() noexcept
+			{
+				ReadCurrent();
+				return *this;
+			}
+			SubrecordIterator operator++(int) noexcept
+			{
+				SubrecordIterator copy = *this;
+				ReadCurrent();
+				return copy;
+			}
+
+			// Iterators compare equal once both have run off the end, which is all range-for needs
+			bool operator==(const SubrecordIterator& other) const noexcept
+			{
+				return m_Current.Type == other.m_Current.Type && m_Current.Data.data() == other.m_Current.Data.data();
+			}
+	};
+
+	// One record as seen by a visitor. Data of uncompressed records points straight into the mapped file and stays valid
+	// while the file is open. Data of compressed records is already decompressed into a thread_local buffer which the
+	// next compressed record overwrites, so the view is only valid during the 'OnRecord' call, copy whatever is needed.
+	class xSE_API RecordView final
+	{
+		private:
+			RecordSignature m_Type;
+			uint32_t m_Flags = 0;
+			uint32_t m_FormID = 0;
+			uint16_t m_Version = 0;
+			std::span<const std::byte> m_Data;
+
+		public:
+			RecordView() noexcept = default;
+			RecordView(RecordSignature type, uint32_t flags, uint32_t formID, uint16_t version, std::span<const std::byte> data) noexcept
+				:m_Type(type), m_Flags(flags), m_FormID(formID), m_Version(version), m_Data(data)
+			{
+			}
+
+		public:
+			RecordSignature GetType() const noexcept
+			{
+				return m_Type;
+			}
+			uint32_t GetFlags() const noexcept
+			{
+				return m_Flags;
+			}
+			bool HasFlag(RecordFlag flag) const noexcept
+			{
+				return (m_Flags & static_cast<uint32_t>(flag)) != 0;
+			}
+			uint32_t GetFormID() const noexcept
+			{
+				return m_FormID;
+			}
+			uint16_t GetVersion() const noexcept
+			{
+				return m_Version;
+			}
+			std::span<const std::byte> GetData() const noexcept
+			{
+				return m_Data;
+			}
+
+			SubrecordIterator begin() const noexcept
+			{
+				return SubrecordIterator(m_Data);
+			}
+			SubrecordIterator end() const noexcept
+			{
+				return {};
+			}
+
+			// First subrecord of the given type, an empty view if there's none
+			SubrecordView FindSubrecord(RecordSignature type) const noexcept;
+			std::string_view GetEditorID() const noexcept
+			{
+				return FindSubrecord("EDID").GetString();
+			}
+	};
+}
+
+namespace xSE
+{
+	class PluginFile;
+
+	struct xSE_API PluginFileVisitor final
+	{
+		// Record types to visit, all of them if empty
+		std::vector<RecordSignature> Types;
+
+		// Called before any records of the file, returning false skips the file. Always called on the calling thread.
+		std::function<bool(const PluginFile& file)> OnFile;
+
+		// Called for every matching record, possibly from several threads at once. The record view must not be kept
+		// past the call, see 'RecordView'.
+		std::function<void(const PluginFile& file, const RecordView& record)> OnRecord;
+
+		bool IsTypeVisited(RecordSignature type) const noexcept;
+	};
+
+	// A memory-mapped '.esp', '.esm' or '.esl' file in the 24 byte header format used by Fallout 3 and later games. Opening
+	// the file only reads the header record and the offsets of the top-level groups, records are walked in place when
+	// visited. Top-level groups are independent from each other so they can be visited in parallel.
+	class xSE_API PluginFile final
+	{
+		public:
+			struct TopGroup final
+			{
+				RecordSignature Label;
+				uint32_t Offset = 0;
+				uint32_t Size = 0;
+			};
+
+		private:
+			MappedFile m_File;
+			std::string m_Name;
+			RecordView m_Header;
+			std::vector<std::string_view> m_Masters;
+			std::vector<TopGroup> m_Groups;
+			bool m_IsMaster = false;
+			bool m_IsLight = false;
+
+		private:
+			bool Parse();
+			// Returns false only when the structure is broken, records which couldn't be decoded reset 'isDecoded' instead
+			bool VisitRange(std::span<const std::byte> data, const PluginFileVisitor& visitor, bool& isDecoded, size_t depth = 0) const;
+
+		public:
+			PluginFile() noexcept = default;
+			PluginFile(const PluginFile&) = delete;
+
+		public:
+			bool Open(const kxf::FSPath& path);
+			bool IsOpen() const noexcept
+			{
+				return m_File.IsOpen();
+			}
+
+			// File name with extension
+			const std::string& GetName() const noexcept
+			{
+				return m_Name;
+			}
+			size_t GetSize() const noexcept
+			{
+				return m_File.GetSize();
+			}
+
+			// The 'TES4' record
+			const RecordView& GetHeader() const noexcept
+			{
+				return m_Header;
+			}
+
+			// Either flagged so or implied by the extension, same as the game decides it
+			bool IsMaster() const noexcept
+			{
+				return m_IsMaster;
+			}
+			bool IsLight() const noexcept
+			{
+				return m_IsLight;
+			}
+			bool IsLocalized() const noexcept
+			{
+				return m_Header.HasFlag(RecordFlag::Localized);
+			}
+			std::span<const std::string_view> GetMasters() const noexcept
+			{
+				return m_Masters;
+			}
+			std::span<const TopGroup> GetGroups() const noexcept
+			{
+				return m_Groups;
+			}
+
+			// Whether a visitor interested in the given types needs to walk the group at all
+			bool IsGroupVisited(const TopGroup& group, const PluginFileVisitor& visitor) const noexcept;
+
+			// Walks a single top-level group or the whole file on the calling thread. Returns false if the data is malformed,
+			// records up to that point are still delivered. Compressed records which can't be decompressed are skipped
+			// and also make it return false.
+			bool VisitGroup(const TopGroup& group, const PluginFileVisitor& visitor) const;
+			bool Visit(const PluginFileVisitor& visitor) const;
+
+		public:
+			PluginFile& operator=(const PluginFile&) = delete;
+	};
+}
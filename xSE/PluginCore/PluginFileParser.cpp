@@ -0,0 +1,106 @@
+#include "pch.hpp"
+#include "PluginFileParser.h"
+#include "WorkerPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+
+namespace xSE
+{
+	std::vector<std::shared_ptr<PluginFile>> PluginFileParser::Open(std::span<const kxf::FSPath> paths) const
+	{
+		xSE_PROFILE_FUNCTION();
+
+		std::vector<std::shared_ptr<PluginFile>> files(paths.size());
+		auto OpenFile = [&](size_t index)
+		{
+			auto file = std::make_shared<PluginFile>();
+			if (file->Open(paths[index]))
+			{
+				files[index] = std::move(file);
+			}
+		};
+
+		if (m_WorkerPool)
+		{
+			m_WorkerPool->ParallelFor(paths.size(), OpenFile);
+		}
+		else
+		{
+			for (size_t i = 0; i < paths.size(); i++)
+			{
+				OpenFile(i);
+			}
+		}
+		return files;
+	}
+	size_t PluginFileParser::Parse(std::span<const std::shared_ptr<PluginFile>> files, const PluginFileVisitor& visitor) const
+	{
+		xSE_PROFILE_FUNCTION();
+
+		struct Task final
+		{
+			size_t FileIndex = 0;
+			const PluginFile::TopGroup* Group = nullptr;
+		};
+
+		// 'OnFile' is promised to run on the calling thread, so it's done for all files before anything is scheduled
+		std::vector<Task> tasks;
+		auto failed = std::make_unique<std::atomic<bool>[]>(files.size());
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			const PluginFile* file = files[i].get();
+			if (!file)
+			{
+				failed[i] = true;
+				continue;
+			}
+			if (visitor.OnFile && !visitor.OnFile(*file))
+			{
+				continue;
+			}
+
+			for (const PluginFile::TopGroup& group: file->GetGroups())
+			{
+				if (file->IsGroupVisited(group, visitor))
+				{
+					tasks.push_back({i, &group});
+				}
+			}
+		}
+		std::sort(tasks.begin(), tasks.end(), [](const Task& left, const Task& right)
+		{
+			return left.Group->Size > right.Group->Size;
+		});
+
+		auto VisitTask = [&](size_t index)
+		{
+			const Task& task = tasks[index];
+			if (!files[task.FileIndex]->VisitGroup(*task.Group, visitor))
+			{
+				failed[task.FileIndex].store(true, std::memory_order_relaxed);
+			}
+		};
+		if (m_WorkerPool)
+		{
+			m_WorkerPool->ParallelFor(tasks.size(), VisitTask);
+		}
+		else
+		{
+			for (size_t i = 0; i < tasks.size(); i++)
+			{
+				VisitTask(i);
+			}
+		}
+
+		size_t count = 0;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			if (!failed[i].load(std::memory_order_relaxed))
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Framework.hpp"
+#include "PluginFile.h"
+#include <span>
+#include <memory>
+#include <vector>
+
+namespace xSE
+{
+	class WorkerPool;
+}
+
+namespace xSE
+{
+	// Visits records of many plugin files at once. Files are opened in parallel, then every top-level group of every
+	// file becomes a separate task on the worker pool, largest first, so a single huge master doesn't keep one thread
+	// busy while the others are idle. Records of one group are delivered in file order, there's no order across groups.
+	class xSE_API PluginFileParser final
+	{
+		private:
+			WorkerPool* m_WorkerPool = nullptr;
+
+		public:
+			PluginFileParser(WorkerPool* workerPool = nullptr) noexcept
+				:m_WorkerPool(workerPool)
+			{
+			}
+
+		public:
+			// Files which couldn't be opened are left null
+			std::vector<std::shared_ptr<PluginFile>> Open(std::span<const kxf::FSPath> paths) const;
+
+			// Returns the number of files which were walked without errors
+			size_t Parse(std::span<const std::shared_ptr<PluginFile>> files, const PluginFileVisitor& visitor) const;
+			size_t Parse(std::span<const kxf::FSPath> paths, const PluginFileVisitor& visitor) const
+			{
+				return Parse(Open(paths), visitor);
+			}
+	};
+}
@@ -0,0 +1,278 @@
+#include "pch.hpp"
+#include "Profiler.h"
+#include <kxf/IO/IStream.h>
+#include <format>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	constexpr xSE::ProfilerZoneInfo g_FrameZone = {"Frame", __FILE__, __LINE__};
+
+	template<class TOutputIt>
+	TOutputIt FormatEscaped(TOutputIt it, std::string_view value)
+	{
+		for (char c: value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				*it++ = '\\';
+			}
+			*it++ = c;
+		}
+		return it;
+	}
+}
+
+namespace xSE
+{
+	Profiler& Profiler::GetInstance() noexcept
+	{
+		static Profiler g_Instance;
+		return g_Instance;
+	}
+	uint64_t Profiler::GetTimestamp() noexcept
+	{
+		#ifdef _MSC_VER
+		return __rdtsc();
+		#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+		#endif
+	}
+
+	auto Profiler::GetThreadBuffer() -> ThreadBuffer&
+	{
+		// The registry keeps its own reference so events of exited threads can still be exported
+		thread_local std::shared_ptr<ThreadBuffer> g_Buffer;
+		if (!g_Buffer)
+		{
+			auto buffer = std::make_shared<ThreadBuffer>();
+
+			std::lock_guard lock(m_BuffersLock);
+			buffer->ThreadIndex = m_NextThreadIndex++;
+			m_Buffers.emplace_back(buffer);
+			g_Buffer = std::move(buffer);
+		}
+		return *g_Buffer;
+	}
+	void Profiler::Calibrate()
+	{
+		#ifdef _MSC_VER
+		// TSC is invariant on every CPU the games run on, measure its frequency against the steady clock once
+		using namespace std::chrono;
+
+		const auto clockStart = steady_clock::now();
+		const uint64_t ticksStart = GetTimestamp();
+		while (steady_clock::now() - clockStart < milliseconds(10))
+		{
+			std::this_thread::yield();
+		}
+		const uint64_t ticksEnd = GetTimestamp();
+		const auto clockEnd = steady_clock::now();
+
+		m_TicksPerMicrosecond = (ticksEnd - ticksStart) / duration<double, std::micro>(clockEnd - clockStart).count();
+		#else
+		m_TicksPerMicrosecond = 1000.0;
+		#endif
+
+		m_BaseTimestamp = GetTimestamp();
+	}
+	size_t Profiler::DrainEvents(kxf::IOutputStream& stream, bool& isFirstEvent)
+	{
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		{
+			std::lock_guard lock(m_BuffersLock);
+			buffers = m_Buffers;
+
+			// Forget buffers of threads which have exited and have nothing left to export
+			std::erase_if(m_Buffers, [](const std::shared_ptr<ThreadBuffer>& buffer)
+			{
+				return buffer.use_count() == 2 && buffer->Head.load(std::memory_order_acquire) == buffer->Tail.load(std::memory_order_relaxed);
+			});
+		}
+
+		size_t count = 0;
+		std::string output;
+		for (const auto& buffer: buffers)
+		{
+			const size_t head = buffer->Head.load(std::memory_order_acquire);
+			size_t tail = buffer->Tail.load(std::memory_order_relaxed);
+
+			for (; tail != head; tail++)
+			{
+				const ProfilerEvent& event = buffer->Events[tail % BufferCapacity];
+
+				// Events recorded before calibration can't be placed on the timeline
+				const double time = event.Timestamp >= m_BaseTimestamp ? (event.Timestamp - m_BaseTimestamp) / m_TicksPerMicrosecond : 0.0;
+
+				output += isFirstEvent ? "\n" : ",\n";
+				isFirstEvent = false;
+
+				output += "{\"name\":\"";
+				FormatEscaped(std::back_inserter(output), event.Zone->Name);
+				switch (event.Type)
+				{
+					case ProfilerEventType::Begin:
+					{
+						std::format_to(std::back_inserter(output), "\",\"ph\":\"B\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}}", time, buffer->ThreadIndex);
+						break;
+					}
+					case ProfilerEventType::End:
+					{
+						std::format_to(std::back_inserter(output), "\",\"ph\":\"E\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}}", time, buffer->ThreadIndex);
+						break;
+					}
+					case ProfilerEventType::Instant:
+					{
+						const char scope = event.Zone == &g_FrameZone ? 'g' : 't';
+						std::format_to(std::back_inserter(output), "\",\"ph\":\"i\",\"s\":\"{}\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}}", scope, time, buffer->ThreadIndex);
+						break;
+					}
+				};
+				count++;
+			}
+			buffer->Tail.store(tail, std::memory_order_release);
+
+			if (output.size() >= 64 * 1024)
+			{
+				stream.Write(output.data(), output.size());
+				output.clear();
+			}
+		}
+
+		if (!output.empty())
+		{
+			stream.Write(output.data(), output.size());
+		}
+		return count;
+	}
+
+	Profiler::~Profiler()
+	{
+		StopCapture();
+	}
+
+	void Profiler::Enable(bool enable)
+	{
+		if (enable && m_TicksPerMicrosecond == 0)
+		{
+			std::lock_guard lock(m_ExportLock);
+			Calibrate();
+		}
+		m_Enabled.store(enable, std::memory_order_relaxed);
+	}
+
+	bool Profiler::Record(const ProfilerZoneInfo& zone, ProfilerEventType type) noexcept
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		const size_t head = buffer.Head.load(std::memory_order_relaxed);
+		const size_t capacity = type == ProfilerEventType::End ? BufferCapacity : BufferCapacity - BufferReserve;
+		if (head - buffer.Tail.load(std::memory_order_acquire) >= capacity)
+		{
+			buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		ProfilerEvent& event = buffer.Events[head % BufferCapacity];
+		event.Timestamp = GetTimestamp();
+		event.Zone = &zone;
+		event.Type = type;
+		buffer.Head.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+	void Profiler::MarkFrame() noexcept
+	{
+		if (IsEnabled())
+		{
+			Record(g_FrameZone, ProfilerEventType::Instant);
+		}
+	}
+	uint64_t Profiler::GetDroppedCount() noexcept
+	{
+		std::lock_guard lock(m_BuffersLock);
+
+		uint64_t count = 0;
+		for (const auto& buffer: m_Buffers)
+		{
+			count += buffer->Dropped.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	size_t Profiler::ExportChromeTrace(kxf::IOutputStream& stream)
+	{
+		std::lock_guard lock(m_ExportLock);
+
+		constexpr std::string_view header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		constexpr std::string_view footer = "\n]}\n";
+
+		bool isFirstEvent = true;
+		stream.Write(header.data(), header.size());
+		const size_t count = DrainEvents(stream, isFirstEvent);
+		stream.Write(footer.data(), footer.size());
+		stream.Flush();
+
+		return count;
+	}
+
+	bool Profiler::StartCapture(std::unique_ptr<kxf::IOutputStream> stream, std::chrono::milliseconds interval)
+	{
+		if (!stream || IsCapturing())
+		{
+			return false;
+		}
+		Enable();
+
+		// JSON array form of the format, the closing bracket is optional for the viewers so a truncated file is still usable
+		constexpr std::string_view header = "[";
+		stream->Write(header.data(), header.size());
+
+		m_CaptureStream = std::move(stream);
+		m_StopCapture = false;
+		m_CaptureThread = std::thread([this, interval]()
+		{
+			bool isFirstEvent = true;
+			bool stop = false;
+			while (!stop)
+			{
+				{
+					std::unique_lock lock(m_CaptureLock);
+					m_CaptureCondition.wait_for(lock, interval, [&]()
+					{
+						return m_StopCapture;
+					});
+					stop = m_StopCapture;
+				}
+
+				std::lock_guard lock(m_ExportLock);
+				if (DrainEvents(*m_CaptureStream, isFirstEvent) != 0)
+				{
+					m_CaptureStream->Flush();
+				}
+			}
+
+			constexpr std::string_view footer = "\n]\n";
+			m_CaptureStream->Write(footer.data(), footer.size());
+			m_CaptureStream->Flush();
+		});
+		return true;
+	}
+	void Profiler::StopCapture()
+	{
+		if (m_CaptureThread.joinable())
+		{
+			{
+				std::lock_guard lock(m_CaptureLock);
+				m_StopCapture = true;
+			}
+			m_CaptureCondition.notify_all();
+			m_CaptureThread.join();
+
+			m_CaptureStream = nullptr;
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+// Set to 0 to compile all profiler macros out entirely
+#ifndef xSE_PROFILER_ENABLED
+#define xSE_PROFILER_ENABLED 1
+#endif
+
+namespace kxf
+{
+	class IOutputStream;
+}
+
+namespace xSE
+{
+	// Static per call-site information, events only store a pointer to it
+	struct ProfilerZoneInfo final
+	{
+		const char* Name = nullptr;
+		const char* File = nullptr;
+		uint32_t Line = 0;
+	};
+
+	enum class ProfilerEventType: uint32_t
+	{
+		Begin,
+		End,
+		Instant
+	};
+
+	struct ProfilerEvent final
+	{
+		uint64_t Timestamp = 0;
+		const ProfilerZoneInfo* Zone = nullptr;
+		ProfilerEventType Type = ProfilerEventType::Instant;
+	};
+}
+
+namespace xSE
+{
+	// Collects zone events into per-thread single-producer/single-consumer ring buffers. Recording never locks or allocates
+	// (except for the first event on a thread), when a buffer is full new events are dropped and counted. The buffers are
+	// drained either on demand by 'ExportChromeTrace' or continuously by the capture thread, output is in the Chrome
+	// trace event format which can be opened in chrome://tracing, Perfetto or converted for Tracy with 'import-chrome'.
+	class xSE_API Profiler final
+	{
+		public:
+			static constexpr size_t BufferCapacity = 1 << 14;
+
+			// Slots only usable by end events so zones that made it into the buffer can still be closed when it fills up
+			static constexpr size_t BufferReserve = 64;
+
+		public:
+			static Profiler& GetInstance() noexcept;
+			static uint64_t GetTimestamp() noexcept;
+
+		private:
+			struct ThreadBuffer final
+			{
+				std::array<ProfilerEvent, BufferCapacity> Events;
+				alignas(64) std::atomic<size_t> Head = 0;
+				alignas(64) std::atomic<size_t> Tail = 0;
+				std::atomic<uint64_t> Dropped = 0;
+				uint32_t ThreadIndex = 0;
+			};
+
+		private:
+			std::atomic<bool> m_Enabled = false;
+			double m_TicksPerMicrosecond = 0;
+			uint64_t m_BaseTimestamp = 0;
+
+			std::mutex m_BuffersLock;
+			std::vector<std::shared_ptr<ThreadBuffer>> m_Buffers;
+			uint32_t m_NextThreadIndex = 1;
+
+			// Only one consumer may drain the buffers at a time
+			std::mutex m_ExportLock;
+
+			std::thread m_CaptureThread;
+			std::mutex m_CaptureLock;
+			std::condition_variable m_CaptureCondition;
+			std::unique_ptr<kxf::IOutputStream> m_CaptureStream;
+			bool m_StopCapture = false;
+
+		private:
+			Profiler() = default;
+
+			ThreadBuffer& GetThreadBuffer();
+			void Calibrate();
+			size_t DrainEvents(kxf::IOutputStream& stream, bool& isFirstEvent);
+
+		public:
+			Profiler(const Profiler&) = delete;
+			~Profiler();
+
+		public:
+			bool IsEnabled() const noexcept
+			{
+				return m_Enabled.load(std::memory_order_relaxed);
+			}
+			void Enable(bool enable = true);
+
+			bool Record(const ProfilerZoneInfo& zone, ProfilerEventType type) noexcept;
+			void MarkFrame() noexcept;
+			uint64_t GetDroppedCount() noexcept;
+
+			// Writes everything recorded so far as a complete Chrome trace and removes it from the buffers
+			size_t ExportChromeTrace(kxf::IOutputStream& stream);
+
+			// Streams the events to the given stream every 'interval' until stopped. The file is a valid trace after
+			// 'StopCapture' and can still be loaded if the game crashes in the middle of the capture.
+			bool StartCapture(std::unique_ptr<kxf::IOutputStream> stream, std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+			void StopCapture();
+			bool IsCapturing() const noexcept
+			{
+				return m_CaptureThread.joinable();
+			}
+
+		public:
+			Profiler& operator=(const Profiler&) = delete;
+	};
+
+	class ProfilerZone final
+	{
+		private:
+			const ProfilerZoneInfo* m_Zone = nullptr;
+
+		public:
+			ProfilerZone(const ProfilerZoneInfo& zone) noexcept
+			{
+				auto& profiler = Profiler::GetInstance();
+				if (profiler.IsEnabled() && profiler.Record(zone, ProfilerEventType::Begin))
+				{
+					m_Zone = &zone;
+				}
+			}
+			ProfilerZone(const ProfilerZone&) = delete;
+			~ProfilerZone()
+			{
+				// Closed even if the profiler was disabled in the meantime so the trace stays balanced
+				if (m_Zone)
+				{
+					Profiler::GetInstance().Record(*m_Zone, ProfilerEventType::End);
+				}
+			}
+
+		public:
+			ProfilerZone& operator=(const ProfilerZone&) = delete;
+	};
+}
+
+#define xSE_PROFILER_CONCAT_(a, b)	a##b
+#define xSE_PROFILER_CONCAT(a, b)	xSE_PROFILER_CONCAT_(a, b)
+
+#if xSE_PROFILER_ENABLED
+
+#define xSE_PROFILE_ZONE(name)	\
+	static constexpr ::xSE::ProfilerZoneInfo xSE_PROFILER_CONCAT(xSE_ProfilerZoneInfo_, __LINE__) = {name, __FILE__, __LINE__};	\
+	::xSE::ProfilerZone xSE_PROFILER_CONCAT(xSE_ProfilerZone_, __LINE__)(xSE_PROFILER_CONCAT(xSE_ProfilerZoneInfo_, __LINE__))
+
+#define xSE_PROFILE_FUNCTION()	xSE_PROFILE_ZONE(__FUNCTION__)
+
+#define xSE_PROFILE_MARK(name)	\
+	do	\
+	{	\
+		static constexpr ::xSE::ProfilerZoneInfo xSE_ProfilerZoneInfo = {name, __FILE__, __LINE__};	\
+		if (auto& profiler = ::xSE::Profiler::GetInstance(); profiler.IsEnabled())	\
+		{	\
+			profiler.Record(xSE_ProfilerZoneInfo, ::xSE::ProfilerEventType::Instant);	\
+		}	\
+	}	\
+	while (false)
+
+#else
+
+#define xSE_PROFILE_ZONE(name)		static_cast<void>(0)
+#define xSE_PROFILE_FUNCTION()		static_cast<void>(0)
+#define xSE_PROFILE_MARK(name)		static_cast<void>(0)
+
+#endif
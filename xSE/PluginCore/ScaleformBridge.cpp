@@ -0,0 +1,209 @@
+#include "pch.hpp"
+#include "ScaleformBridge.h"
+#include "ScriptExtenderDefinesBase.h"
+#include "ScriptExtenderDefinesExtra.h"
+#include "ScriptExtenderInterfaceIncludes.h"
+
+#if !xSE_HAS_SCALEFORM_INTERFACE
+// No Scaleform on this platform, the backend is still compiled but never creates any values
+class GFxValue final
+{
+};
+#endif
+
+namespace
+{
+	constexpr uint64_t g_FNVOffsetBasis = 14695981039346656037ull;
+	constexpr uint64_t g_FNVPrime = 1099511628211ull;
+
+	uint64_t HashBytes(const void* data, size_t size, uint64_t hash = g_FNVOffsetBasis) noexcept
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= g_FNVPrime;
+		}
+		return hash;
+	}
+}
+
+namespace xSE
+{
+	uint64_t ScaleformValue::GetFingerprint() const noexcept
+	{
+		uint64_t hash = HashBytes(&Type, sizeof(Type));
+		switch (Type)
+		{
+			case ScaleformValueType::Bool:
+			{
+				return HashBytes(&Bool, sizeof(Bool), hash);
+			}
+			case ScaleformValueType::Number:
+			{
+				return HashBytes(&Number, sizeof(Number), hash);
+			}
+			case ScaleformValueType::String:
+			{
+				return HashBytes(String.data(), String.size(), hash);
+			}
+		};
+		return hash;
+	}
+}
+
+namespace xSE
+{
+	GFxScaleformBackend::GFxScaleformBackend(GFxMovieView& movie)
+		:m_Movie(&movie)
+	{
+	}
+	GFxScaleformBackend::~GFxScaleformBackend() = default;
+
+	auto GFxScaleformBackend::AllocateHandle() -> Handle
+	{
+		if (!m_FreeHandles.empty())
+		{
+			Handle handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+
+			return handle;
+		}
+		else
+		{
+			m_Values.emplace_back(std::make_unique<GFxValue>());
+			return static_cast<Handle>(m_Values.size() - 1);
+		}
+	}
+
+	auto GFxScaleformBackend::GetVariable(const char* path) -> Handle
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		Handle handle = AllocateHandle();
+		if (xSE_SCALEFORM_ROOT(m_Movie)->GetVariable(m_Values[handle].get(), path))
+		{
+			return handle;
+		}
+		m_FreeHandles.push_back(handle);
+		#endif
+		return InvalidHandle;
+	}
+	GFxValue* GFxScaleformBackend::GetValue(Handle handle) noexcept
+	{
+		if (handle < m_Values.size())
+		{
+			return m_Values[handle].get();
+		}
+		return nullptr;
+	}
+
+	auto GFxScaleformBackend::CreateObject() -> Handle
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		Handle handle = AllocateHandle();
+		xSE_SCALEFORM_ROOT(m_Movie)->CreateObject(m_Values[handle].get());
+		return handle;
+		#else
+		return InvalidHandle;
+		#endif
+	}
+	auto GFxScaleformBackend::CreateArray() -> Handle
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		Handle handle = AllocateHandle();
+		xSE_SCALEFORM_ROOT(m_Movie)->CreateArray(m_Values[handle].get());
+		return handle;
+		#else
+		return InvalidHandle;
+		#endif
+	}
+	void GFxScaleformBackend::ReleaseValue(Handle handle)
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		if (auto value = GetValue(handle))
+		{
+			// Drops the reference to the managed value but keeps the slot for the next allocation
+			value->SetUndefined();
+			m_FreeHandles.push_back(handle);
+		}
+		#endif
+	}
+
+	void GFxScaleformBackend::SetMember(Handle object, const char* name, const ScaleformValue& value)
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		if (auto target = GetValue(object))
+		{
+			GFxValue item;
+			switch (value.Type)
+			{
+				case ScaleformValueType::Null:
+				{
+					item.SetNull();
+					break;
+				}
+				case ScaleformValueType::Bool:
+				{
+					item.SetBool(value.Bool);
+					break;
+				}
+				case ScaleformValueType::Number:
+				{
+					item.SetNumber(value.Number);
+					break;
+				}
+				case ScaleformValueType::String:
+				{
+					// Strings have to be managed by the movie since the source view is only valid during this call.
+					// 'CreateString' expects a null-terminated string so short ones are copied into a stack buffer.
+					std::array<char, 256> buffer;
+					if (value.String.size() < buffer.size())
+					{
+						*std::copy(value.String.begin(), value.String.end(), buffer.begin()) = '\0';
+						xSE_SCALEFORM_ROOT(m_Movie)->CreateString(&item, buffer.data());
+					}
+					else
+					{
+						std::string copy(value.String);
+						xSE_SCALEFORM_ROOT(m_Movie)->CreateString(&item, copy.c_str());
+					}
+					break;
+				}
+			};
+			target->SetMember(name, &item);
+		}
+		#endif
+	}
+	void GFxScaleformBackend::SetMember(Handle object, const char* name, Handle value)
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		auto target = GetValue(object);
+		auto item = GetValue(value);
+		if (target && item)
+		{
+			target->SetMember(name, item);
+		}
+		#endif
+	}
+
+	void GFxScaleformBackend::SetArraySize(Handle array, size_t size)
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		if (auto target = GetValue(array))
+		{
+			target->SetArraySize(static_cast<uint32_t>(size));
+		}
+		#endif
+	}
+	void GFxScaleformBackend::SetElement(Handle array, size_t index, Handle value)
+	{
+		#if xSE_HAS_SCALEFORM_INTERFACE
+		auto target = GetValue(array);
+		auto item = GetValue(value);
+		if (target && item)
+		{
+			target->SetElement(static_cast<uint32_t>(index), item);
+		}
+		#endif
+	}
+}
@@ -0,0 +1,410 @@
+#pragma once
+#include "Framework.hpp"
+#include <span>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <string_view>
+#include <type_traits>
+
+class GFxValue;
+class GFxMovieView;
+
+namespace xSE
+{
+	enum class ScaleformValueType: uint8_t
+	{
+		Undefined,
+		Null,
+		Bool,
+		Number,
+		String
+	};
+
+	// Non-owning scalar passed to the backend. String values are UTF-8 and only need to stay valid for the duration of the call.
+	struct ScaleformValue final
+	{
+		public:
+			ScaleformValueType Type = ScaleformValueType::Undefined;
+			bool Bool = false;
+			double Number = 0;
+			std::string_view String;
+
+		public:
+			constexpr ScaleformValue() noexcept = default;
+			constexpr ScaleformValue(std::nullptr_t) noexcept
+				:Type(ScaleformValueType::Null)
+			{
+			}
+			constexpr ScaleformValue(bool value) noexcept
+				:Type(ScaleformValueType::Bool), Bool(value)
+			{
+			}
+			constexpr ScaleformValue(double value) noexcept
+				:Type(ScaleformValueType::Number), Number(value)
+			{
+			}
+			constexpr ScaleformValue(std::string_view value) noexcept
+				:Type(ScaleformValueType::String), String(value)
+			{
+			}
+
+		public:
+			// Cheap fingerprint used to detect changed fields without keeping a copy of the previous value
+			uint64_t GetFingerprint() const noexcept;
+	};
+
+	template<class T>
+	ScaleformValue ToScaleformValue(const T& value) noexcept
+	{
+		if constexpr(std::is_same_v<T, bool>)
+		{
+			return value;
+		}
+		else if constexpr(std::is_enum_v<T>)
+		{
+			return static_cast<double>(static_cast<std::underlying_type_t<T>>(value));
+		}
+		else if constexpr(std::is_arithmetic_v<T>)
+		{
+			return static_cast<double>(value);
+		}
+		else if constexpr(std::is_convertible_v<const T&, std::string_view>)
+		{
+			return std::string_view(value);
+		}
+		else
+		{
+			static_assert(sizeof(T*) == 0, "Provide a 'ToScaleformValue' overload for this type");
+		}
+	}
+}
+
+namespace xSE
+{
+	// Minimal set of operations the marshalling layer needs. Values are referred to by handles owned by the backend,
+	// so the bindings below can be exercised against a recording or mock backend outside of the game.
+	class xSE_API IScaleformBackend
+	{
+		public:
+			using Handle = uint32_t;
+			static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
+
+		public:
+			virtual ~IScaleformBackend() = default;
+
+		public:
+			virtual Handle CreateObject() = 0;
+			virtual Handle CreateArray() = 0;
+			virtual void ReleaseValue(Handle handle) = 0;
+
+			virtual void SetMember(Handle object, const char* name, const ScaleformValue& value) = 0;
+			virtual void SetMember(Handle object, const char* name, Handle value) = 0;
+
+			virtual void SetArraySize(Handle array, size_t size) = 0;
+			virtual void SetElement(Handle array, size_t index, Handle value) = 0;
+	};
+
+	// Backend over a real movie, only functional on the platforms providing the Scaleform interface.
+	class xSE_API GFxScaleformBackend final: public IScaleformBackend
+	{
+		private:
+			GFxMovieView* m_Movie = nullptr;
+			std::vector<std::unique_ptr<GFxValue>> m_Values;
+			std::vector<Handle> m_FreeHandles;
+
+		private:
+			Handle AllocateHandle();
+
+		public:
+			GFxScaleformBackend(GFxMovieView& movie);
+			GFxScaleformBackend(const GFxScaleformBackend&) = delete;
+			~GFxScaleformBackend();
+
+		public:
+			// Retrieves a variable of the movie (for example an array created by the movie script) into a new handle
+			Handle GetVariable(const char* path);
+			GFxValue* GetValue(Handle handle) noexcept;
+
+		public:
+			// IScaleformBackend
+			Handle CreateObject() override;
+			Handle CreateArray() override;
+			void ReleaseValue(Handle handle) override;
+
+			void SetMember(Handle object, const char* name, const ScaleformValue& value) override;
+			void SetMember(Handle object, const char* name, Handle value) override;
+
+			void SetArraySize(Handle array, size_t size) override;
+			void SetElement(Handle array, size_t index, Handle value) override;
+
+		public:
+			GFxScaleformBackend& operator=(const GFxScaleformBackend&) = delete;
+	};
+}
+
+namespace xSE
+{
+	template<class TStruct, class TMember>
+	struct ScaleformField final
+	{
+		const char* Name = nullptr;
+		TMember TStruct::* Member = nullptr;
+
+		constexpr ScaleformField(const char* name, TMember TStruct::* member) noexcept
+			:Name(name), Member(member)
+		{
+		}
+	};
+
+	// Compile-time list of the fields marshalled for a struct. Field names are string literals so they are
+	// shared across all frames and elements instead of being rebuilt for every 'SetMember' call.
+	template<class TStruct, class... TMembers>
+	class ScaleformStruct final
+	{
+		public:
+			static constexpr size_t FieldCount = sizeof...(TMembers);
+
+		private:
+			std::tuple<ScaleformField<TStruct, TMembers>...> m_Fields;
+
+		public:
+			constexpr ScaleformStruct(ScaleformField<TStruct, TMembers>... fields) noexcept
+				:m_Fields(fields...)
+			{
+			}
+
+		public:
+			template<class TFunc>
+			void ForEachField(const TStruct& value, TFunc&& func) const
+			{
+				[&]<size_t... i>(std::index_sequence<i...>)
+				{
+					(func(i, std::get<i>(m_Fields).Name, ToScaleformValue(value.*(std::get<i>(m_Fields).Member))), ...);
+				}(std::index_sequence_for<TMembers...>());
+			}
+	};
+
+	template<class TStruct, class... TMembers>
+	constexpr auto ScaleformDescribe(ScaleformField<TStruct, TMembers>... fields) noexcept
+	{
+		return ScaleformStruct<TStruct, TMembers...>(fields...);
+	}
+
+	struct ScaleformUpdateStats final
+	{
+		size_t ObjectsCreated = 0;
+		size_t ElementsAssigned = 0;
+		size_t FieldsPushed = 0;
+		size_t FieldsSkipped = 0;
+	};
+}
+
+namespace xSE
+{
+	// Keeps a single object in sync with a struct, pushing only the fields that changed since the previous update
+	template<class TStruct, class TDescriptor>
+	class ScaleformObjectBinding final
+	{
+		public:
+			using Handle = IScaleformBackend::Handle;
+
+		private:
+			IScaleformBackend* m_Backend = nullptr;
+			const TDescriptor* m_Descriptor = nullptr;
+			Handle m_Object = IScaleformBackend::InvalidHandle;
+			std::array<uint64_t, TDescriptor::FieldCount> m_Fingerprints = {};
+			bool m_IsPopulated = false;
+
+		public:
+			ScaleformObjectBinding(IScaleformBackend& backend, const TDescriptor& descriptor, Handle object = IScaleformBackend::InvalidHandle)
+				:m_Backend(&backend), m_Descriptor(&descriptor), m_Object(object)
+			{
+			}
+			ScaleformObjectBinding(ScaleformObjectBinding&& other) noexcept
+			{
+				*this = std::move(other);
+			}
+			ScaleformObjectBinding(const ScaleformObjectBinding&) = delete;
+			~ScaleformObjectBinding()
+			{
+				if (m_Backend && m_Object != IScaleformBackend::InvalidHandle)
+				{
+					m_Backend->ReleaseValue(m_Object);
+				}
+			}
+
+		public:
+			Handle GetHandle() const noexcept
+			{
+				return m_Object;
+			}
+			bool EnsureObject(ScaleformUpdateStats& stats)
+			{
+				if (m_Object == IScaleformBackend::InvalidHandle)
+				{
+					m_Object = m_Backend->CreateObject();
+					m_IsPopulated = false;
+					stats.ObjectsCreated++;
+				}
+				return m_Object != IScaleformBackend::InvalidHandle;
+			}
+			void Invalidate() noexcept
+			{
+				m_IsPopulated = false;
+			}
+
+			void Update(const TStruct& value, ScaleformUpdateStats& stats)
+			{
+				if (!EnsureObject(stats))
+				{
+					return;
+				}
+
+				m_Descriptor->ForEachField(value, [&](size_t index, const char* name, const ScaleformValue& fieldValue)
+				{
+					const uint64_t fingerprint = fieldValue.GetFingerprint();
+					if (!m_IsPopulated || m_Fingerprints[index] != fingerprint)
+					{
+						m_Backend->SetMember(m_Object, name, fieldValue);
+						m_Fingerprints[index] = fingerprint;
+						stats.FieldsPushed++;
+					}
+					else
+					{
+						stats.FieldsSkipped++;
+					}
+				});
+				m_IsPopulated = true;
+			}
+			ScaleformUpdateStats Update(const TStruct& value)
+			{
+				ScaleformUpdateStats stats;
+				Update(value, stats);
+				return stats;
+			}
+
+		public:
+			ScaleformObjectBinding& operator=(ScaleformObjectBinding&& other) noexcept
+			{
+				if (this == &other)
+				{
+					return *this;
+				}
+
+				// Same as the destructor, the object this binding owned so far isn't referenced by anything else
+				if (m_Backend && m_Object != IScaleformBackend::InvalidHandle)
+				{
+					m_Backend->ReleaseValue(m_Object);
+				}
+
+				m_Backend = std::exchange(other.m_Backend, nullptr);
+				m_Descriptor = other.m_Descriptor;
+				m_Object = std::exchange(other.m_Object, IScaleformBackend::InvalidHandle);
+				m_Fingerprints = other.m_Fingerprints;
+				m_IsPopulated = std::exchange(other.m_IsPopulated, false);
+
+				return *this;
+			}
+			ScaleformObjectBinding& operator=(const ScaleformObjectBinding&) = delete;
+	};
+
+	// Keeps an array of objects in sync with a range of structs. Element objects are cached across updates,
+	// so a refresh of an unchanged list costs no backend calls at all and a changed one only touches the modified fields.
+	template<class TStruct, class TDescriptor>
+	class ScaleformArrayBinding final
+	{
+		public:
+			using Handle = IScaleformBackend::Handle;
+
+		private:
+			IScaleformBackend* m_Backend = nullptr;
+			const TDescriptor* m_Descriptor = nullptr;
+			Handle m_Array = IScaleformBackend::InvalidHandle;
+			bool m_OwnsArray = false;
+
+			std::vector<ScaleformObjectBinding<TStruct, TDescriptor>> m_Elements;
+			size_t m_Size = 0;
+			bool m_IsDirty = true;
+
+		public:
+			ScaleformArrayBinding(IScaleformBackend& backend, const TDescriptor& descriptor, Handle array = IScaleformBackend::InvalidHandle)
+				:m_Backend(&backend), m_Descriptor(&descriptor), m_Array(array)
+			{
+			}
+			ScaleformArrayBinding(const ScaleformArrayBinding&) = delete;
+			~ScaleformArrayBinding()
+			{
+				m_Elements.clear();
+				if (m_OwnsArray)
+				{
+					m_Backend->ReleaseValue(m_Array);
+				}
+			}
+
+		public:
+			Handle GetHandle() const noexcept
+			{
+				return m_Array;
+			}
+			void Invalidate() noexcept
+			{
+				for (auto& element: m_Elements)
+				{
+					element.Invalidate();
+				}
+				m_IsDirty = true;
+			}
+
+			template<class TRange>
+			ScaleformUpdateStats Update(TRange&& range)
+			{
+				ScaleformUpdateStats stats;
+				if (m_Array == IScaleformBackend::InvalidHandle)
+				{
+					m_Array = m_Backend->CreateArray();
+					m_OwnsArray = true;
+					if (m_Array == IScaleformBackend::InvalidHandle)
+					{
+						return stats;
+					}
+				}
+
+				size_t index = 0;
+				for (const TStruct& value: range)
+				{
+					bool isNew = false;
+					if (index == m_Elements.size())
+					{
+						m_Elements.emplace_back(*m_Backend, *m_Descriptor);
+						isNew = true;
+					}
+
+					auto& element = m_Elements[index];
+					isNew = isNew || element.GetHandle() == IScaleformBackend::InvalidHandle;
+					element.Update(value, stats);
+
+					// Elements beyond the previous size were detached from the array and need to be reassigned
+					if (isNew || m_IsDirty || index >= m_Size)
+					{
+						m_Backend->SetElement(m_Array, index, element.GetHandle());
+						stats.ElementsAssigned++;
+					}
+					index++;
+				}
+
+				// Shrinking keeps the cached element objects around so they can be reused when the list grows back
+				if (m_IsDirty || index != m_Size)
+				{
+					m_Backend->SetArraySize(m_Array, index);
+					m_Size = index;
+				}
+				m_IsDirty = false;
+				return stats;
+			}
+
+		public:
+			ScaleformArrayBinding& operator=(const ScaleformArrayBinding&) = delete;
+	};
+}
@@ -76,6 +76,14 @@
 #define xSE_LOADFUNCTION F4SEPlugin_Load
 #define xSE_QUERYFUNCTION F4SEPlugin_Query
 
+#elif xSE_PLATFORM_MOCK
+
+#define xSE_NAME MockSE
+#define xSE_PACKED_VERSION MOCKSE_VERSION_INTEGER
+
+#define xSE_LOADFUNCTION MockSEPlugin_Load
+#define xSE_QUERYFUNCTION MockSEPlugin_Query
+
 #else
 
 #error "Unsupported configuration"
@@ -18,6 +18,11 @@ using xSE_Interface = struct NVSEInterface;
 #define xSE_INTERFACE_VERSION(xSE)	(xSE)->nvseVersion
 #define xSE_INTERFACE_NOSE 1
 
+#elif xSE_PLATFORM_MOCK
+
+using xSE_Interface = struct MockSEInterface;
+#define xSE_INTERFACE_VERSION(xSE)	(xSE)->mockseVersion
+
 #else
 using xSE_Interface = void;
 #endif
@@ -29,11 +34,13 @@ using xSE_Interface = void;
 
 using xSE_ScaleformInterface = struct SKSEScaleformInterface;
 #define xSE_HAS_SCALEFORM_INTERFACE 1
+#define xSE_SCALEFORM_ROOT(movieView)	(movieView)
 
 #elif xSE_PLATFORM_F4SE || xSE_PLATFORM_F4SEVR
 
 using xSE_ScaleformInterface = struct F4SEScaleformInterface;
 #define xSE_HAS_SCALEFORM_INTERFACE 1
+#define xSE_SCALEFORM_ROOT(movieView)	(movieView)->movieRoot
 
 #else
 using xSE_ScaleformInterface = void;
@@ -46,11 +53,13 @@ using xSE_ScaleformInterface = void;
 
 using xSE_MessagingInterface = struct SKSEMessagingInterface;
 #define xSE_HAS_MESSAGING_INTERFACE 1
+#define xSE_MESSAGING_SENDER	"SKSE"
 
 #elif xSE_PLATFORM_F4SE || xSE_PLATFORM_F4SEVR
 
 using xSE_MessagingInterface = struct F4SEMessagingInterface;
 #define xSE_HAS_MESSAGING_INTERFACE 1
+#define xSE_MESSAGING_SENDER	"F4SE"
 
 #else
 using xSE_MessagingInterface = void;
@@ -60,7 +69,24 @@ using xSE_MessagingInterface = void;
 // Console command struct
 //////////////////////////////////////////////////////////////////////////
 #if xSE_PLATFORM_SKSEVR || xSE_PLATFORM_SKSE64 || xSE_PLATFORM_SKSE64AE || xSE_PLATFORM_F4SE || xSE_PLATFORM_F4SEVR
+
+using xSE_ConsoleCommandInfo = struct ObScriptCommand;
 #define xSE_HAS_CONSOLE_COMMAND_INFO 1
+#define xSE_CONSOLE_COMMAND_TABLE()	g_firstConsoleCommand.GetPtr()
+#define xSE_CONSOLE_COMMAND_COUNT	kObScript_NumConsoleCommands
+
+#else
+using xSE_ConsoleCommandInfo = void;
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Form lookup
+//////////////////////////////////////////////////////////////////////////
+#if xSE_PLATFORM_SKSE || xSE_PLATFORM_SKSEVR || xSE_PLATFORM_SKSE64 || xSE_PLATFORM_SKSE64AE || xSE_PLATFORM_F4SE || xSE_PLATFORM_F4SEVR
+
+#define xSE_HAS_FORM_LOOKUP 1
+#define xSE_LOOKUP_FORM(formID)	LookupFormByID(formID)
+
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -82,6 +108,8 @@ using xSE_MessagingInterface = void;
 // Other forward declarations
 //////////////////////////////////////////////////////////////////////////
 struct PluginInfo;
+struct ObScriptCommand;
+class TESForm;
 class TESObjectREFR;
 class GFxMovieView;
 class GFxValue;
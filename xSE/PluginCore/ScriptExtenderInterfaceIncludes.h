@@ -7,7 +7,10 @@
 #include <skse/SafeWrite.h>
 #include <skse/PluginAPI.h>
 #include <skse/GameAPI.h>
+#include <skse/GameForms.h>
 #include <skse/CommandTable.h>
+#include <skse/ScaleformCallbacks.h>
+#include <skse/ScaleformMovie.h>
 
 #pragma comment(lib, "skse/Release/skse.lib")
 #pragma comment(lib, "skse/Release/loader_common.lib")
@@ -21,7 +24,10 @@
 #include <skse64_common/SafeWrite.h>
 #include <skse64/PluginAPI.h>
 #include <skse64/GameAPI.h>
+#include <skse64/GameForms.h>
 #include <skse64/ObScript.h>
+#include <skse64/ScaleformValue.h>
+#include <skse64/ScaleformMovie.h>
 
 #pragma comment(lib, "skseVR/x64/Release_Lib_VC142/sksevr_1_4_15.lib")
 #pragma comment(lib, "skseVR/x64/Release_VC142/skse64_common.lib")
@@ -36,7 +42,10 @@
 #include <skse64_common/SafeWrite.h>
 #include <skse64/PluginAPI.h>
 #include <skse64/GameAPI.h>
+#include <skse64/GameForms.h>
 #include <skse64/ObScript.h>
+#include <skse64/ScaleformValue.h>
+#include <skse64/ScaleformMovie.h>
 
 #pragma comment(lib, "skse64/x64/Release_Lib_VC142/skse64_1_5_97.lib")
 #pragma comment(lib, "skse64/x64/Release_VC142/skse64_common.lib")
@@ -51,7 +60,10 @@
 #include <f4se_common/SafeWrite.h>
 #include <f4se/PluginAPI.h>
 #include <f4se/GameAPI.h>
+#include <f4se/GameForms.h>
 #include <f4se/ObScript.h>
+#include <f4se/ScaleformValue.h>
+#include <f4se/ScaleformMovie.h>
 
 #pragma comment(lib, "f4se/x64/Release/f4se_1_10_163.lib")
 #pragma comment(lib, "f4se/x64/Release/f4se_common.lib")
@@ -66,7 +78,10 @@
 #include <f4sevr/f4se_common/SafeWrite.h>
 #include <f4sevr/f4se/PluginAPI.h>
 #include <f4sevr/f4se/GameAPI.h>
+#include <f4sevr/f4se/GameForms.h>
 #include <f4sevr/f4se/ObScript.h>
+#include <f4sevr/f4se/ScaleformValue.h>
+#include <f4sevr/f4se/ScaleformMovie.h>
 
 #pragma comment(lib, "f4sevr/x64/Release/f4sevr_1_2_72.lib")
 #pragma comment(lib, "f4sevr/x64/Release/f4se_common.lib")
@@ -82,4 +97,8 @@
 #pragma comment(lib, "nvse/Release/nvse.lib")
 #pragma comment(lib, "nvse/Release/loader_common.lib")
 
+#elif xSE_PLATFORM_MOCK
+
+#include "MockScriptExtender.h"
+
 #endif
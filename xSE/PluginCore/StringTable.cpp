@@ -0,0 +1,315 @@
+#include "pch.hpp"
+#include "StringTable.h"
+#include "DataPath.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// Windows-1252 code points for 0x80-0x9F, the rest of the range maps directly to Unicode
+	constexpr char16_t g_Windows1252[32] =
+	{
+		0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+		0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+	};
+
+	void AppendCodePoint(std::wstring& result, char32_t c)
+	{
+		if constexpr (sizeof(wchar_t) == 2)
+		{
+			if (c >= 0x10000)
+			{
+				c -= 0x10000;
+				result += static_cast<wchar_t>(0xD800 + (c >> 10));
+				result += static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+				return;
+			}
+		}
+		result += static_cast<wchar_t>(c);
+	}
+	bool DecodeUTF8(std::string_view text, std::wstring& result)
+	{
+		for (size_t i = 0; i < text.size();)
+		{
+			const auto lead = static_cast<uint8_t>(text[i]);
+			if (lead < 0x80)
+			{
+				result += static_cast<wchar_t>(lead);
+				i++;
+				continue;
+			}
+
+			size_t length = 0;
+			char32_t c = 0;
+			char32_t min = 0;
+			if ((lead & 0xE0) == 0xC0)
+			{
+				length = 2;
+				c = lead & 0x1F;
+				min = 0x80;
+			}
+			else if ((lead & 0xF0) == 0xE0)
+			{
+				length = 3;
+				c = lead & 0x0F;
+				min = 0x800;
+			}
+			else if ((lead & 0xF8) == 0xF0)
+			{
+				length = 4;
+				c = lead & 0x07;
+				min = 0x10000;
+			}
+			else
+			{
+				return false;
+			}
+
+			if (text.size() - i < length)
+			{
+				return false;
+			}
+			for (size_t j = 1; j < length; j++)
+			{
+				const auto next = static_cast<uint8_t>(text[i + j]);
+				if ((next & 0xC0) != 0x80)
+				{
+					return false;
+				}
+				c = (c << 6)|(next & 0x3F);
+			}
+
+			// Overlong forms, surrogates and anything past the Unicode range aren't valid UTF-8
+			if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+			{
+				return false;
+			}
+			AppendCodePoint(result, c);
+			i += length;
+		}
+		return true;
+	}
+	void DecodeWindows1252(std::string_view text, std::wstring& result)
+	{
+		for (char c: text)
+		{
+			const auto value = static_cast<uint8_t>(c);
+			result += static_cast<wchar_t>(value >= 0x80 && value < 0xA0 ? g_Windows1252[value - 0x80] : value);
+		}
+	}
+}
+
+namespace xSE
+{
+	StringTableType StringTable::GetTypeFromExtension(std::string_view extension) noexcept
+	{
+		if (extension.starts_with('.'))
+		{
+			extension.remove_prefix(1);
+		}
+
+		if (DataPath::EqualsNormalized(extension, "strings"))
+		{
+			return StringTableType::Strings;
+		}
+		else if (DataPath::EqualsNormalized(extension, "dlstrings"))
+		{
+			return StringTableType::DLStrings;
+		}
+		else if (DataPath::EqualsNormalized(extension, "ilstrings"))
+		{
+			return StringTableType::ILStrings;
+		}
+		return StringTableType::None;
+	}
+
+	bool StringTable::Parse(std::span<const std::byte> data, StringTableType type)
+	{
+		// Header is the string count and the size of the string data, followed by the directory and the data itself
+		uint32_t count = 0;
+		uint32_t dataSize = 0;
+		if (type == StringTableType::None || data.size() < sizeof(count) + sizeof(dataSize))
+		{
+			return false;
+		}
+		std::memcpy(&count, data.data(), sizeof(count));
+		std::memcpy(&dataSize, data.data() + sizeof(count), sizeof(dataSize));
+
+		const uint64_t directoryOffset = sizeof(count) + sizeof(dataSize);
+		const uint64_t dataOffset = directoryOffset + uint64_t(count) * sizeof(DirectoryEntry);
+		if (dataOffset > data.size() || dataSize > data.size() - dataOffset)
+		{
+			return false;
+		}
+
+		m_Directory = data.data() + directoryOffset;
+		m_Count = count;
+		m_StringData = data.subspan(static_cast<size_t>(dataOffset), dataSize);
+		m_Data = data;
+		m_Type = type;
+
+		// The game writes the directory sorted, if someone else didn't, a sorted index is built instead of copying it
+		bool isSorted = true;
+		for (uint32_t i = 1; i < count && isSorted; i++)
+		{
+			isSorted = GetEntry(i - 1).ID <= GetEntry(i).ID;
+		}
+		if (!isSorted)
+		{
+			m_SortedIndex.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				m_SortedIndex[i] = i;
+			}
+			std::stable_sort(m_SortedIndex.begin(), m_SortedIndex.end(), [&](uint32_t left, uint32_t right)
+			{
+				return GetEntry(left).ID < GetEntry(right).ID;
+			});
+		}
+		return true;
+	}
+	StringTable::DirectoryEntry StringTable::GetEntry(uint32_t index) const noexcept
+	{
+		// Files inside archives don't have to be aligned
+		DirectoryEntry entry;
+		std::memcpy(&entry, m_Directory + size_t(index) * sizeof(DirectoryEntry), sizeof(DirectoryEntry));
+		return entry;
+	}
+	std::optional<StringTable::DirectoryEntry> StringTable::FindEntry(uint32_t id) const noexcept
+	{
+		// Binary search over either the directory itself or the sorted index into it
+		uint32_t first = 0;
+		uint32_t count = m_Count;
+		auto GetID = [&](uint32_t position)
+		{
+			return GetEntry(m_SortedIndex.empty() ? position : m_SortedIndex[position]).ID;
+		};
+
+		while (count > 0)
+		{
+			const uint32_t step = count / 2;
+			if (GetID(first + step) < id)
+			{
+				first += step + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+
+		if (first < m_Count)
+		{
+			const DirectoryEntry entry = GetEntry(m_SortedIndex.empty() ? first : m_SortedIndex[first]);
+			if (entry.ID == id)
+			{
+				return entry;
+			}
+		}
+		return {};
+	}
+	std::string_view StringTable::GetRawString(const DirectoryEntry& entry) const noexcept
+	{
+		if (entry.Offset >= m_StringData.size())
+		{
+			return {};
+		}
+
+		const char* begin = reinterpret_cast<const char*>(m_StringData.data() + entry.Offset);
+		size_t available = m_StringData.size() - entry.Offset;
+		if (m_Type != StringTableType::Strings)
+		{
+			// Length prefixed, the length includes the null terminator
+			uint32_t length = 0;
+			if (available < sizeof(length))
+			{
+				return {};
+			}
+			std::memcpy(&length, begin, sizeof(length));
+
+			begin += sizeof(length);
+			available = std::min<size_t>(available - sizeof(length), length);
+		}
+
+		// Up to the terminator, a missing one ends the string at the end of the data
+		const void* terminator = std::memchr(begin, 0, available);
+		return {begin, terminator ? static_cast<size_t>(static_cast<const char*>(terminator) - begin) : available};
+	}
+
+	bool StringTable::Open(const kxf::FSPath& path)
+	{
+		if (!IsOpen() && m_File.Open(path))
+		{
+			if (Parse(m_File.GetView(), GetTypeFromExtension(path.GetExtension().ToUTF8())))
+			{
+				return true;
+			}
+			m_File.Close();
+		}
+		return false;
+	}
+	bool StringTable::Open(std::shared_ptr<ArchiveFileSystem> archive, const ArchiveEntry& entry)
+	{
+		if (!IsOpen() && archive)
+		{
+			// Uncompressed entries are views into the archive mapping, so the archive is kept alive with the table
+			const size_t extension = entry.Name.rfind('.');
+			const StringTableType type = GetTypeFromExtension(extension != std::string_view::npos ? entry.Name.substr(extension) : std::string_view());
+
+			m_ArchiveData = archive->ReadEntry(entry);
+			if (Parse(m_ArchiveData.GetView(), type))
+			{
+				m_Archive = std::move(archive);
+				return true;
+			}
+			m_ArchiveData = {};
+		}
+		return false;
+	}
+
+	std::string_view StringTable::GetRawString(uint32_t id) const noexcept
+	{
+		if (auto entry = FindEntry(id))
+		{
+			return GetRawString(*entry);
+		}
+		return {};
+	}
+	std::wstring_view StringTable::GetString(uint32_t id) const
+	{
+		{
+			std::shared_lock lock(m_Lock);
+			if (auto it = m_Decoded.find(id); it != m_Decoded.end())
+			{
+				return it->second;
+			}
+		}
+
+		const auto entry = FindEntry(id);
+		if (!entry)
+		{
+			return {};
+		}
+
+		std::lock_guard lock(m_Lock);
+		if (auto it = m_Decoded.find(id); it != m_Decoded.end())
+		{
+			return it->second;
+		}
+
+		// The decoded length isn't known up front, only the final string is copied into the table's own storage
+		const std::string_view raw = GetRawString(*entry);
+		std::wstring decoded;
+		decoded.reserve(raw.size());
+		if (!DecodeUTF8(raw, decoded))
+		{
+			decoded.clear();
+			DecodeWindows1252(raw, decoded);
+		}
+
+		auto buffer = static_cast<wchar_t*>(m_DecodedStorage.allocate((decoded.size() + 1) * sizeof(wchar_t), alignof(wchar_t)));
+		std::copy_n(decoded.c_str(), decoded.size() + 1, buffer);
+		return m_Decoded.emplace(id, std::wstring_view(buffer, decoded.size())).first->second;
+	}
+}
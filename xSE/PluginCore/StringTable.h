@@ -0,0 +1,106 @@
+#pragma once
+#include "Framework.hpp"
+#include "MappedFile.h"
+#include "ArchiveFileSystem.h"
+#include <memory_resource>
+#include <unordered_map>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+namespace xSE
+{
+	enum class StringTableType
+	{
+		None = -1,
+
+		// Short strings such as names, null-terminated
+		Strings,
+
+		// Descriptions and dialogue, both prefixed with their length
+		DLStrings,
+		ILStrings
+	};
+}
+
+namespace xSE
+{
+	// Single '.STRINGS', '.DLSTRINGS' or '.ILSTRINGS' file. The file is kept mapped (or, for archived ones, in the buffer
+	// the archive returned) and its ID directory is binary searched in place, only strings which are actually requested
+	// get decoded to UTF-16. Decoded strings are kept until the table is destroyed, so the returned views stay valid for
+	// its lifetime. Text is decoded as UTF-8 and falls back to Windows-1252 when it isn't valid UTF-8, which is what
+	// the English tables of the older games use.
+	class xSE_API StringTable final
+	{
+		public:
+			static StringTableType GetTypeFromExtension(std::string_view extension) noexcept;
+
+		private:
+			struct DirectoryEntry final
+			{
+				uint32_t ID = 0;
+				uint32_t Offset = 0;
+			};
+
+		private:
+			MappedFile m_File;
+			ArchiveData m_ArchiveData;
+			std::shared_ptr<ArchiveFileSystem> m_Archive;
+			std::span<const std::byte> m_Data;
+			StringTableType m_Type = StringTableType::None;
+
+			const std::byte* m_Directory = nullptr;
+			uint32_t m_Count = 0;
+			std::span<const std::byte> m_StringData;
+
+			// Only used for the rare files whose directory isn't sorted by ID
+			std::vector<uint32_t> m_SortedIndex;
+
+			mutable std::shared_mutex m_Lock;
+			mutable std::unordered_map<uint32_t, std::wstring_view> m_Decoded;
+			mutable std::pmr::monotonic_buffer_resource m_DecodedStorage;
+
+		private:
+			bool Parse(std::span<const std::byte> data, StringTableType type);
+			DirectoryEntry GetEntry(uint32_t index) const noexcept;
+			std::optional<DirectoryEntry> FindEntry(uint32_t id) const noexcept;
+			std::string_view GetRawString(const DirectoryEntry& entry) const noexcept;
+
+		public:
+			StringTable() = default;
+			StringTable(const StringTable&) = delete;
+
+		public:
+			// The type is taken from the file extension
+			bool Open(const kxf::FSPath& path);
+			bool Open(std::shared_ptr<ArchiveFileSystem> archive, const ArchiveEntry& entry);
+
+			bool IsOpen() const noexcept
+			{
+				return m_Type != StringTableType::None;
+			}
+			StringTableType GetType() const noexcept
+			{
+				return m_Type;
+			}
+			size_t GetCount() const noexcept
+			{
+				return m_Count;
+			}
+
+			bool Contains(uint32_t id) const noexcept
+			{
+				return FindEntry(id).has_value();
+			}
+
+			// Undecoded bytes of the string, a view into the file
+			std::string_view GetRawString(uint32_t id) const noexcept;
+
+			// Empty if there's no such string
+			std::wstring_view GetString(uint32_t id) const;
+
+		public:
+			StringTable& operator=(const StringTable&) = delete;
+	};
+}
@@ -0,0 +1,222 @@
+#include "pch.hpp"
+#include "SymbolTable.h"
+#include "UTF8.h"
+#include <memory_resource>
+#include <array>
+
+namespace
+{
+	constexpr size_t g_InitialTableCapacity = 1024;
+
+	constexpr uint32_t HashString(std::string_view value) noexcept
+	{
+		uint32_t hash = 2166136261u;
+		for (char c: value)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+
+		// Zero is reserved to mark empty slots, see 'PackSlot'
+		return hash != 0 ? hash : 1;
+	}
+	constexpr uint64_t PackSlot(uint32_t hash, uint32_t symbol) noexcept
+	{
+		return (static_cast<uint64_t>(hash) << 32)|symbol;
+	}
+	constexpr uint32_t GetSlotHash(uint64_t slot) noexcept
+	{
+		return static_cast<uint32_t>(slot >> 32);
+	}
+	constexpr uint32_t GetSlotSymbol(uint64_t slot) noexcept
+	{
+		return static_cast<uint32_t>(slot);
+	}
+}
+
+namespace xSE
+{
+	SymbolTable& SymbolTable::GetInstance() noexcept
+	{
+		static SymbolTable g_Instance;
+		return g_Instance;
+	}
+
+	SymbolTable::HashTable::HashTable(size_t capacity)
+		:Capacity(capacity), Slots(std::make_unique<std::atomic<uint64_t>[]>(capacity))
+	{
+	}
+
+	const SymbolTable::Entry* SymbolTable::GetEntry(uint32_t index) const noexcept
+	{
+		if (Entry* page = m_Pages[index / PageSize].load(std::memory_order_acquire))
+		{
+			return &page[index % PageSize];
+		}
+		return nullptr;
+	}
+	Symbol SymbolTable::FindInTable(const HashTable& table, std::string_view value, uint32_t hash) const noexcept
+	{
+		const size_t mask = table.Capacity - 1;
+		for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		{
+			const uint64_t slot = table.Slots[i].load(std::memory_order_acquire);
+			if (slot == 0)
+			{
+				return {};
+			}
+
+			if (GetSlotHash(slot) == hash)
+			{
+				const uint32_t symbol = GetSlotSymbol(slot);
+				const Entry* entry = GetEntry(symbol - 1);
+				if (entry && std::string_view(entry->Data, entry->Length) == value)
+				{
+					return Symbol(symbol);
+				}
+			}
+		}
+	}
+	void SymbolTable::InsertIntoTable(HashTable& table, uint32_t hash, uint32_t symbol) noexcept
+	{
+		const size_t mask = table.Capacity - 1;
+		for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		{
+			if (table.Slots[i].load(std::memory_order_relaxed) == 0)
+			{
+				table.Slots[i].store(PackSlot(hash, symbol), std::memory_order_release);
+				return;
+			}
+		}
+	}
+	const char* SymbolTable::StoreString(std::string_view value)
+	{
+		// Strings are stored null-terminated so they can be passed to C APIs directly
+		const size_t size = value.size() + 1;
+
+		char* buffer = nullptr;
+		if (size > StorageBlockSize / 8)
+		{
+			buffer = m_Storage.emplace_back(std::make_unique<char[]>(size)).get();
+		}
+		else
+		{
+			if (!m_StorageBlock || m_StorageBlockUsed + size > StorageBlockSize)
+			{
+				m_StorageBlock = m_Storage.emplace_back(std::make_unique<char[]>(StorageBlockSize)).get();
+				m_StorageBlockUsed = 0;
+			}
+			buffer = m_StorageBlock + m_StorageBlockUsed;
+			m_StorageBlockUsed += size;
+		}
+
+		std::copy(value.begin(), value.end(), buffer);
+		buffer[value.size()] = '\0';
+		return buffer;
+	}
+
+	SymbolTable::SymbolTable()
+	{
+		m_Table = m_Tables.emplace_back(std::make_unique<HashTable>(g_InitialTableCapacity)).get();
+	}
+	SymbolTable::~SymbolTable()
+	{
+		for (auto& page: m_Pages)
+		{
+			delete[] page.exchange(nullptr);
+		}
+	}
+
+	Symbol SymbolTable::Intern(std::string_view value)
+	{
+		if (value.empty())
+		{
+			return {};
+		}
+
+		const uint32_t hash = HashString(value);
+		if (Symbol symbol = FindInTable(*m_Table.load(std::memory_order_acquire), value, hash))
+		{
+			return symbol;
+		}
+
+		std::lock_guard lock(m_WriteLock);
+
+		// Someone else could have added it while we were waiting for the lock
+		HashTable* table = m_Table.load(std::memory_order_relaxed);
+		if (Symbol symbol = FindInTable(*table, value, hash))
+		{
+			return symbol;
+		}
+
+		const uint32_t index = m_Count.load(std::memory_order_relaxed);
+		if (index >= PageSize * MaxPages)
+		{
+			return {};
+		}
+
+		Entry* page = m_Pages[index / PageSize].load(std::memory_order_relaxed);
+		if (!page)
+		{
+			page = new Entry[PageSize];
+			m_Pages[index / PageSize].store(page, std::memory_order_release);
+		}
+
+		Entry& entry = page[index % PageSize];
+		entry.Data = StoreString(value);
+		entry.Length = static_cast<uint32_t>(value.size());
+		entry.Hash = hash;
+		m_Count.store(index + 1, std::memory_order_release);
+
+		// Grow at 50% load. Readers may still be probing the old table so it's kept alive until the table is destroyed.
+		const uint32_t symbol = index + 1;
+		if ((index + 1) * 2 > table->Capacity)
+		{
+			auto newTable = std::make_unique<HashTable>(table->Capacity * 2);
+			for (uint32_t i = 0; i < index; i++)
+			{
+				InsertIntoTable(*newTable, GetEntry(i)->Hash, i + 1);
+			}
+			InsertIntoTable(*newTable, hash, symbol);
+
+			table = m_Tables.emplace_back(std::move(newTable)).get();
+			m_Table.store(table, std::memory_order_release);
+		}
+		else
+		{
+			InsertIntoTable(*table, hash, symbol);
+		}
+		return Symbol(symbol);
+	}
+	Symbol SymbolTable::Intern(const kxf::String& value)
+	{
+		// Interning copies the string anyway, short ones are transcoded on the stack
+		std::array<char, 256> stackBuffer;
+		std::pmr::monotonic_buffer_resource resource(stackBuffer.data(), stackBuffer.size());
+
+		std::pmr::string buffer(&resource);
+		UTF8::Append(buffer, value);
+		return Intern(std::string_view(buffer));
+	}
+
+	Symbol SymbolTable::Find(std::string_view value) const noexcept
+	{
+		if (!value.empty())
+		{
+			return FindInTable(*m_Table.load(std::memory_order_acquire), value, HashString(value));
+		}
+		return {};
+	}
+	std::string_view SymbolTable::GetString(Symbol symbol) const noexcept
+	{
+		const uint32_t value = symbol.GetValue();
+		if (value != 0 && value <= m_Count.load(std::memory_order_acquire))
+		{
+			if (const Entry* entry = GetEntry(value - 1))
+			{
+				return {entry->Data, entry->Length};
+			}
+		}
+		return {};
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string_view>
+
+namespace xSE
+{
+	// Stable 32-bit handle to an interned string. Comparing and hashing symbols is a single integer operation,
+	// the null symbol represents an empty string.
+	class Symbol final
+	{
+		friend class SymbolTable;
+
+		private:
+			uint32_t m_Value = 0;
+
+		private:
+			constexpr explicit Symbol(uint32_t value) noexcept
+				:m_Value(value)
+			{
+			}
+
+		public:
+			constexpr Symbol() noexcept = default;
+
+		public:
+			constexpr bool IsNull() const noexcept
+			{
+				return m_Value == 0;
+			}
+			constexpr uint32_t GetValue() const noexcept
+			{
+				return m_Value;
+			}
+
+			std::string_view GetString() const noexcept;
+
+		public:
+			constexpr explicit operator bool() const noexcept
+			{
+				return !IsNull();
+			}
+			constexpr bool operator!() const noexcept
+			{
+				return IsNull();
+			}
+
+			constexpr auto operator<=>(const Symbol&) const noexcept = default;
+	};
+}
+
+namespace xSE
+{
+	class xSE_API SymbolTable final
+	{
+		public:
+			static SymbolTable& GetInstance() noexcept;
+
+		private:
+			static constexpr size_t PageSize = 4096;
+			static constexpr size_t MaxPages = 4096;
+			static constexpr size_t StorageBlockSize = 64 * 1024;
+
+			struct Entry final
+			{
+				const char* Data = nullptr;
+				uint32_t Length = 0;
+				uint32_t Hash = 0;
+			};
+			struct HashTable final
+			{
+				size_t Capacity = 0;
+				std::unique_ptr<std::atomic<uint64_t>[]> Slots;
+
+				HashTable(size_t capacity);
+			};
+
+		private:
+			std::array<std::atomic<Entry*>, MaxPages> m_Pages = {};
+			std::atomic<uint32_t> m_Count = 0;
+			std::atomic<HashTable*> m_Table = nullptr;
+
+			// Writer-side state, only touched under the lock
+			std::mutex m_WriteLock;
+			std::vector<std::unique_ptr<HashTable>> m_Tables;
+			std::vector<std::unique_ptr<char[]>> m_Storage;
+			char* m_StorageBlock = nullptr;
+			size_t m_StorageBlockUsed = 0;
+
+		private:
+			const Entry* GetEntry(uint32_t index) const noexcept;
+			Symbol FindInTable(const HashTable& table, std::string_view value, uint32_t hash) const noexcept;
+			void InsertIntoTable(HashTable& table, uint32_t hash, uint32_t symbol) noexcept;
+			const char* StoreString(std::string_view value);
+
+		public:
+			SymbolTable();
+			SymbolTable(const SymbolTable&) = delete;
+			~SymbolTable();
+
+		public:
+			// Returns the symbol for the string, adding it to the table if needed. Strings are treated as UTF-8
+			// and compared case-sensitively.
+			Symbol Intern(std::string_view value);
+			Symbol Intern(const kxf::String& value);
+
+			// Lock-free lookups, safe to call concurrently with 'Intern'
+			Symbol Find(std::string_view value) const noexcept;
+			std::string_view GetString(Symbol symbol) const noexcept;
+
+			size_t GetCount() const noexcept
+			{
+				return m_Count.load(std::memory_order_acquire);
+			}
+
+		public:
+			SymbolTable& operator=(const SymbolTable&) = delete;
+	};
+}
+
+namespace xSE
+{
+	inline std::string_view Symbol::GetString() const noexcept
+	{
+		return SymbolTable::GetInstance().GetString(*this);
+	}
+}
+
+namespace std
+{
+	template<>
+	struct hash<xSE::Symbol> final
+	{
+		size_t operator()(const xSE::Symbol& symbol) const noexcept
+		{
+			return std::hash<uint32_t>()(symbol.GetValue());
+		}
+	};
+}
@@ -0,0 +1,235 @@
+#include "pch.hpp"
+#include "TelemetryChannel.h"
+#include "MetricsRegistry.h"
+#include <Windows.h>
+#include <chrono>
+#include <bit>
+
+namespace
+{
+	using namespace xSE::Telemetry;
+
+	constexpr size_t MinCapacity = 64 * 1024;
+	constexpr size_t MaxCapacity = 1024 * 1024 * 1024;
+
+	constexpr size_t AlignUp(size_t value, size_t alignment) noexcept
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	template<class T>
+	std::span<const std::byte> AsBytes(const T& value) noexcept
+	{
+		return std::as_bytes(std::span(&value, 1));
+	}
+	std::span<const std::byte> AsBytes(std::string_view value) noexcept
+	{
+		return std::as_bytes(std::span(value.data(), value.size()));
+	}
+
+	uint64_t GetTimestamp() noexcept
+	{
+		using namespace std::chrono;
+		return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+	}
+}
+
+namespace xSE
+{
+	bool TelemetryChannel::Write(Telemetry::RecordType type, std::initializer_list<std::span<const std::byte>> parts)
+	{
+		size_t payloadSize = 0;
+		for (const auto& part: parts)
+		{
+			payloadSize += part.size();
+		}
+
+		const size_t recordSize = AlignUp(sizeof(TelemetryRecordHeader) + payloadSize, RecordAlignment);
+		const uint64_t timestamp = GetTimestamp();
+
+		std::lock_guard lock(m_Lock);
+		if (!m_Header)
+		{
+			return false;
+		}
+		else if (recordSize > m_Capacity / 2)
+		{
+			m_Header->DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		uint64_t writePosition = m_Header->WritePosition.load(std::memory_order_relaxed);
+		uint64_t readPosition = m_Header->ReadPosition.load(std::memory_order_acquire);
+		if (readPosition > writePosition)
+		{
+			// A consumer stored a position from before our reset, whatever it hasn't read yet is dropped
+			if (m_Header->ReadPosition.compare_exchange_strong(readPosition, writePosition, std::memory_order_acq_rel))
+			{
+				readPosition = writePosition;
+			}
+			else if (readPosition > writePosition)
+			{
+				m_Header->DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		// Records don't wrap, if the tail of the ring is too short it's skipped with a padding record
+		const size_t offset = static_cast<size_t>(writePosition & (m_Capacity - 1));
+		const size_t tailSize = m_Capacity - offset;
+		const size_t requiredSize = tailSize < recordSize ? tailSize + recordSize : recordSize;
+		if (m_Capacity - (writePosition - readPosition) < requiredSize)
+		{
+			m_Header->DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (tailSize < recordSize)
+		{
+			TelemetryRecordHeader padding = {};
+			padding.Size = static_cast<uint32_t>(tailSize);
+			padding.Type = RecordType::Padding;
+			padding.Timestamp = timestamp;
+			std::memcpy(m_Ring + offset, &padding, sizeof(padding));
+
+			writePosition += tailSize;
+		}
+
+		std::byte* record = m_Ring + (writePosition & (m_Capacity - 1));
+		TelemetryRecordHeader header = {};
+		header.Size = static_cast<uint32_t>(recordSize);
+		header.Type = type;
+		header.Timestamp = timestamp;
+		std::memcpy(record, &header, sizeof(header));
+
+		std::byte* payload = record + sizeof(header);
+		for (const auto& part: parts)
+		{
+			std::memcpy(payload, part.data(), part.size());
+			payload += part.size();
+		}
+
+		m_Header->WritePosition.store(writePosition + recordSize, std::memory_order_release);
+		return true;
+	}
+
+	bool TelemetryChannel::Open(const kxf::String& name, size_t capacity)
+	{
+		Close();
+		std::lock_guard lock(m_Lock);
+
+		const size_t ringSize = std::bit_ceil(std::clamp(capacity, MinCapacity, MaxCapacity));
+		const size_t headerSize = AlignUp(sizeof(TelemetryChannelHeader), 64);
+		const uint64_t totalSize = headerSize + ringSize;
+
+		std::wstring mappingName = MappingPrefix;
+		mappingName += name.wc_str();
+
+		// Pagefile-backed, the section stays alive as long as either side has it open
+		HANDLE mappingHandle = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(totalSize >> 32), static_cast<DWORD>(totalSize), mappingName.c_str());
+		if (!mappingHandle)
+		{
+			return false;
+		}
+
+		// A consumer may still hold a section from a previous session, it's reused if it's large enough
+		void* view = ::MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(totalSize));
+		if (!view)
+		{
+			::CloseHandle(mappingHandle);
+			return false;
+		}
+
+		m_MappingHandle = mappingHandle;
+		m_Header = static_cast<TelemetryChannelHeader*>(view);
+		m_Ring = static_cast<std::byte*>(view) + headerSize;
+		m_Capacity = static_cast<uint32_t>(ringSize);
+
+		m_Header->Magic.store(0, std::memory_order_relaxed);
+		m_Header->Version = Telemetry::Version;
+		m_Header->HeaderSize = static_cast<uint32_t>(headerSize);
+		m_Header->Capacity = m_Capacity;
+		m_Header->SessionID = (static_cast<uint64_t>(::GetCurrentProcessId()) << 32) ^ GetTimestamp();
+		m_Header->ProcessID = ::GetCurrentProcessId();
+		m_Header->WritePosition.store(0, std::memory_order_relaxed);
+		m_Header->ReadPosition.store(0, std::memory_order_relaxed);
+		m_Header->DroppedRecords.store(0, std::memory_order_relaxed);
+		m_Header->Magic.store(Telemetry::Magic, std::memory_order_release);
+		m_IsOpen.store(true, std::memory_order_release);
+		return true;
+	}
+	void TelemetryChannel::Close() noexcept
+	{
+		std::lock_guard lock(m_Lock);
+		m_IsOpen.store(false, std::memory_order_release);
+		if (m_Header)
+		{
+			::UnmapViewOfFile(m_Header);
+			m_Header = nullptr;
+			m_Ring = nullptr;
+			m_Capacity = 0;
+		}
+		if (m_MappingHandle)
+		{
+			::CloseHandle(m_MappingHandle);
+			m_MappingHandle = nullptr;
+		}
+	}
+
+	uint64_t TelemetryChannel::GetDroppedCount() const noexcept
+	{
+		std::lock_guard lock(m_Lock);
+		return m_Header ? m_Header->DroppedRecords.load(std::memory_order_relaxed) : 0;
+	}
+
+	bool TelemetryChannel::PublishLog(std::string_view category, std::string_view message, size_t indent)
+	{
+		if (!IsOpen())
+		{
+			return false;
+		}
+
+		TelemetryLogRecord record = {};
+		record.ThreadID = ::GetCurrentThreadId();
+		record.Indent = static_cast<uint16_t>(std::min<size_t>(indent, std::numeric_limits<uint16_t>::max()));
+		record.CategoryLength = static_cast<uint16_t>(std::min<size_t>(category.size(), std::numeric_limits<uint16_t>::max()));
+		record.MessageLength = static_cast<uint32_t>(message.size());
+
+		return Write(RecordType::Log, {AsBytes(record), AsBytes(category.substr(0, record.CategoryLength)), AsBytes(message)});
+	}
+	bool TelemetryChannel::PublishMetric(const MetricValue& value)
+	{
+		if (!IsOpen())
+		{
+			return false;
+		}
+
+		const std::string_view name = value.Name.GetString();
+
+		TelemetryMetricRecord record = {};
+		record.Kind = static_cast<MetricKind>(value.Type);
+		record.NameLength = static_cast<uint16_t>(std::min<size_t>(name.size(), std::numeric_limits<uint16_t>::max()));
+		record.Value = value.Value;
+		record.Count = value.Count;
+		record.Sum = value.Sum;
+		record.P50 = value.P50;
+		record.P90 = value.P90;
+		record.P99 = value.P99;
+		record.Max = value.Max;
+
+		return Write(RecordType::Metric, {AsBytes(record), AsBytes(name.substr(0, record.NameLength))});
+	}
+	bool TelemetryChannel::PublishEvent(std::string_view name, std::span<const std::byte> data)
+	{
+		if (!IsOpen())
+		{
+			return false;
+		}
+
+		TelemetryEventRecord record = {};
+		record.NameLength = static_cast<uint16_t>(std::min<size_t>(name.size(), std::numeric_limits<uint16_t>::max()));
+		record.DataSize = static_cast<uint32_t>(data.size());
+
+		return Write(RecordType::Event, {AsBytes(record), AsBytes(name.substr(0, record.NameLength)), data});
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Framework.hpp"
+#include "TelemetryProtocol.h"
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <string_view>
+#include <initializer_list>
+
+namespace xSE
+{
+	struct MetricValue;
+}
+
+namespace xSE
+{
+	// Producer side of the shared memory telemetry channel, see 'TelemetryProtocol.h' for the layout. Publishing copies
+	// the record straight into the shared ring and never blocks on the consumer, records which don't fit are dropped.
+	// Threads of the plugin are serialized with a lock so from the consumer's point of view there's a single producer.
+	class xSE_API TelemetryChannel final
+	{
+		private:
+			void* m_MappingHandle = nullptr;
+			Telemetry::TelemetryChannelHeader* m_Header = nullptr;
+			std::byte* m_Ring = nullptr;
+			uint32_t m_Capacity = 0;
+			std::atomic<bool> m_IsOpen = false;
+			mutable std::mutex m_Lock;
+
+		private:
+			bool Write(Telemetry::RecordType type, std::initializer_list<std::span<const std::byte>> parts);
+
+		public:
+			TelemetryChannel() noexcept = default;
+			TelemetryChannel(const TelemetryChannel&) = delete;
+			~TelemetryChannel()
+			{
+				Close();
+			}
+
+		public:
+			// Capacity is rounded up to a power of two
+			bool Open(const kxf::String& name, size_t capacity);
+			void Close() noexcept;
+			bool IsOpen() const noexcept
+			{
+				return m_IsOpen.load(std::memory_order_acquire);
+			}
+			uint64_t GetDroppedCount() const noexcept;
+
+			bool PublishLog(std::string_view category, std::string_view message, size_t indent = 0);
+			bool PublishMetric(const MetricValue& value);
+			bool PublishEvent(std::string_view name, std::span<const std::byte> data = {});
+
+		public:
+			TelemetryChannel& operator=(const TelemetryChannel&) = delete;
+	};
+}
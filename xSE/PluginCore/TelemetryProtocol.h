@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+// Wire layout of the telemetry channel. This header has no dependencies on purpose, consumers are expected to copy it.
+//
+// The channel is a named, pagefile-backed shared memory section called 'Local\xSE.Telemetry.<PluginName>', created by
+// the plugin. It starts with a 'TelemetryChannelHeader' of 'HeaderSize' bytes followed by a ring buffer of 'Capacity'
+// bytes, a power of two. 'WritePosition' and 'ReadPosition' are monotonically increasing byte counters, the offset into
+// the ring is the position modulo the capacity. The plugin is the only writer of 'WritePosition' and the consumer the
+// only writer of 'ReadPosition'. Both are published with release and read with acquire semantics.
+//
+// Every record starts with a 'TelemetryRecordHeader' and is padded to 'RecordAlignment' bytes, 'Size' includes the header
+// and the padding. Records never wrap around the end of the ring, when the remaining space is too small a 'Padding'
+// record fills it and the next record starts at offset zero. Strings are UTF-8 and not null-terminated, they follow
+// the fixed part of the payload in the order the lengths are declared in.
+//
+// The producer never waits for the consumer: a record which doesn't fit is dropped and counted in 'DroppedRecords'.
+// A consumer detects a restarted producer by a change of 'SessionID'.
+
+namespace xSE::Telemetry
+{
+	inline constexpr uint32_t Magic = 0x54455358; // 'XSET'
+	inline constexpr uint32_t Version = 1;
+	inline constexpr size_t RecordAlignment = 16;
+	inline constexpr wchar_t MappingPrefix[] = L"Local\\xSE.Telemetry.";
+
+	enum class RecordType: uint16_t
+	{
+		Padding = 0,
+		Log = 1,
+		Metric = 2,
+		Event = 3
+	};
+	enum class MetricKind: uint8_t
+	{
+		Counter = 0,
+		Gauge = 1,
+		Histogram = 2
+	};
+
+	struct TelemetryChannelHeader final
+	{
+		// Written last by the producer, a consumer must not read anything else until it matches
+		std::atomic<uint32_t> Magic;
+		uint32_t Version;
+		uint32_t HeaderSize;
+		uint32_t Capacity;
+		uint64_t SessionID;
+		uint32_t ProcessID;
+		uint32_t Reserved;
+
+		alignas(64) std::atomic<uint64_t> WritePosition;
+		alignas(64) std::atomic<uint64_t> ReadPosition;
+		alignas(64) std::atomic<uint64_t> DroppedRecords;
+	};
+
+	struct TelemetryRecordHeader final
+	{
+		uint32_t Size;
+		RecordType Type;
+		uint16_t Reserved;
+
+		// Microseconds since the Unix epoch
+		uint64_t Timestamp;
+	};
+
+	// Followed by the category and the message
+	struct TelemetryLogRecord final
+	{
+		uint32_t ThreadID;
+		uint16_t Indent;
+		uint16_t CategoryLength;
+		uint32_t MessageLength;
+		uint32_t Reserved;
+	};
+
+	// Followed by the name. Counters and gauges only use 'Value', histograms (nanoseconds) use the rest.
+	struct TelemetryMetricRecord final
+	{
+		MetricKind Kind;
+		uint8_t Reserved;
+		uint16_t NameLength;
+		uint32_t Reserved2;
+		int64_t Value;
+		uint64_t Count;
+		uint64_t Sum;
+		uint64_t P50;
+		uint64_t P90;
+		uint64_t P99;
+		uint64_t Max;
+	};
+
+	// Followed by the name and the data, the data is opaque to the channel
+	struct TelemetryEventRecord final
+	{
+		uint16_t NameLength;
+		uint16_t Reserved;
+		uint32_t DataSize;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free);
+	static_assert(sizeof(TelemetryRecordHeader) == RecordAlignment);
+}
@@ -0,0 +1,262 @@
+#include "pch.hpp"
+#include "TimerService.h"
+#include "Profiler.h"
+
+namespace xSE
+{
+	uint32_t TimerService::AllocateNode()
+	{
+		if (m_FreeList != InvalidIndex)
+		{
+			const uint32_t index = m_FreeList;
+			m_FreeList = m_Nodes[index].Next;
+			m_Nodes[index].Next = InvalidIndex;
+			return index;
+		}
+
+		m_Nodes.emplace_back();
+		return static_cast<uint32_t>(m_Nodes.size() - 1);
+	}
+	void TimerService::FreeNode(uint32_t index) noexcept
+	{
+		Node& node = m_Nodes[index];
+		node.Callback = nullptr;
+		node.State = NodeState::Free;
+		node.Previous = InvalidIndex;
+		node.Next = m_FreeList;
+
+		// Invalidates all outstanding handles, zero is reserved for null ones
+		if (++node.Generation == 0)
+		{
+			node.Generation = 1;
+		}
+		m_FreeList = index;
+	}
+
+	void TimerService::Link(Wheel& wheel, uint32_t index) noexcept
+	{
+		Node& node = m_Nodes[index];
+
+		// The level is picked by the distance, the slot by the expiry bits of that level. Anything beyond the range
+		// of the top level is parked at its far end and re-linked by the cascades until it fits.
+		constexpr uint64_t maxDistance = (uint64_t(1) << (SlotBits * LevelCount)) - 1;
+		const uint64_t distance = node.Expiry > wheel.CurrentTick ? node.Expiry - wheel.CurrentTick : 0;
+		const uint64_t expiry = distance > maxDistance ? wheel.CurrentTick + maxDistance : std::max(node.Expiry, wheel.CurrentTick);
+
+		size_t level = 0;
+		while (level + 1 < LevelCount && distance >= (uint64_t(1) << (SlotBits * (level + 1))))
+		{
+			level++;
+		}
+		node.Slot = static_cast<uint16_t>(level * SlotCount + ((expiry >> (SlotBits * level)) & (SlotCount - 1)));
+
+		uint32_t& head = wheel.Slots[node.Slot];
+		node.Previous = InvalidIndex;
+		node.Next = head;
+		if (head != InvalidIndex)
+		{
+			m_Nodes[head].Previous = index;
+		}
+		head = index;
+	}
+	void TimerService::Unlink(Wheel& wheel, uint32_t index) noexcept
+	{
+		Node& node = m_Nodes[index];
+		if (node.Previous != InvalidIndex)
+		{
+			m_Nodes[node.Previous].Next = node.Next;
+		}
+		else
+		{
+			wheel.Slots[node.Slot] = node.Next;
+		}
+		if (node.Next != InvalidIndex)
+		{
+			m_Nodes[node.Next].Previous = node.Previous;
+		}
+
+		node.Previous = InvalidIndex;
+		node.Next = InvalidIndex;
+	}
+	void TimerService::Cascade(Wheel& wheel, size_t level) noexcept
+	{
+		// Moves everything from the slot the current tick has just entered down to the lower levels
+		const size_t slot = level * SlotCount + ((wheel.CurrentTick >> (SlotBits * level)) & (SlotCount - 1));
+
+		uint32_t index = wheel.Slots[slot];
+		wheel.Slots[slot] = InvalidIndex;
+		while (index != InvalidIndex)
+		{
+			const uint32_t next = m_Nodes[index].Next;
+			Link(wheel, index);
+			index = next;
+		}
+	}
+	void TimerService::AdvanceWheel(Wheel& wheel, std::chrono::microseconds delta)
+	{
+		using namespace std::chrono;
+
+		wheel.Remainder += std::max(delta, microseconds::zero());
+		const auto ticks = duration_cast<milliseconds>(wheel.Remainder);
+		wheel.Remainder -= ticks;
+
+		for (int64_t i = 0; i < ticks.count(); i++)
+		{
+			// Nothing to visit, jump straight to the end
+			if (wheel.Count == 0)
+			{
+				wheel.CurrentTick += ticks.count() - i;
+				break;
+			}
+			wheel.CurrentTick++;
+
+			// Higher levels go first so what they move down gets cascaded further in the same tick
+			size_t levels = 1;
+			while (levels < LevelCount && (wheel.CurrentTick & ((uint64_t(1) << (SlotBits * levels)) - 1)) == 0)
+			{
+				levels++;
+			}
+			for (size_t level = levels - 1; level > 0; level--)
+			{
+				Cascade(wheel, level);
+			}
+
+			uint32_t& head = wheel.Slots[wheel.CurrentTick & (SlotCount - 1)];
+			while (head != InvalidIndex)
+			{
+				const uint32_t index = head;
+				Unlink(wheel, index);
+				m_Nodes[index].State = NodeState::Expired;
+				m_Expired.push_back(index);
+				wheel.Count--;
+			}
+		}
+	}
+	void TimerService::Deliver()
+	{
+		// Callbacks can schedule and cancel timers, so nodes are looked up again after every call
+		m_IsDelivering = true;
+		for (const uint32_t index: m_Expired)
+		{
+			if (m_Nodes[index].State != NodeState::Expired)
+			{
+				continue;
+			}
+
+			TCallback callback = std::move(m_Nodes[index].Callback);
+			callback();
+
+			Node& node = m_Nodes[index];
+			if (node.State == NodeState::Expired)
+			{
+				if (node.IsRepeating)
+				{
+					Wheel& wheel = GetWheel(node.Clock);
+					node.Expiry = std::max(node.Expiry + node.Interval, wheel.CurrentTick + 1);
+					node.Callback = std::move(callback);
+					node.State = NodeState::Pending;
+
+					Link(wheel, index);
+					wheel.Count++;
+				}
+				else
+				{
+					FreeNode(index);
+				}
+			}
+		}
+
+		m_Expired.clear();
+		m_IsDelivering = false;
+	}
+
+	TimerHandle TimerService::Schedule(TimerClock clock, std::chrono::milliseconds delay, std::chrono::milliseconds interval, bool repeating, TCallback callback)
+	{
+		if (!callback)
+		{
+			return {};
+		}
+
+		Wheel& wheel = GetWheel(clock);
+		const uint32_t index = AllocateNode();
+
+		Node& node = m_Nodes[index];
+		node.Callback = std::move(callback);
+		node.Expiry = wheel.CurrentTick + std::max<int64_t>(delay.count(), 1);
+		node.Interval = static_cast<uint64_t>(std::max<int64_t>(interval.count(), 0));
+		node.Clock = clock;
+		node.IsRepeating = repeating;
+		node.State = NodeState::Pending;
+
+		Link(wheel, index);
+		wheel.Count++;
+
+		return {index, node.Generation};
+	}
+
+	bool TimerService::Cancel(TimerHandle handle) noexcept
+	{
+		if (!IsPending(handle))
+		{
+			return false;
+		}
+
+		// Expired timers are already off the wheel and only wait for delivery
+		Node& node = m_Nodes[handle.Index];
+		if (node.State == NodeState::Pending)
+		{
+			Wheel& wheel = GetWheel(node.Clock);
+			Unlink(wheel, handle.Index);
+			wheel.Count--;
+		}
+		FreeNode(handle.Index);
+		return true;
+	}
+	bool TimerService::IsPending(TimerHandle handle) const noexcept
+	{
+		if (!handle.IsNull() && handle.Index < m_Nodes.size())
+		{
+			const Node& node = m_Nodes[handle.Index];
+			return node.Generation == handle.Generation && node.State != NodeState::Free;
+		}
+		return false;
+	}
+	size_t TimerService::GetPendingCount() const noexcept
+	{
+		return m_Wheels[0].Count + m_Wheels[1].Count;
+	}
+	void TimerService::Clear() noexcept
+	{
+		for (uint32_t i = 0; i < m_Nodes.size(); i++)
+		{
+			if (m_Nodes[i].State != NodeState::Free)
+			{
+				FreeNode(i);
+			}
+		}
+		for (Wheel& wheel: m_Wheels)
+		{
+			wheel.Slots.fill(InvalidIndex);
+			wheel.Count = 0;
+		}
+
+		// Pending deliveries see the freed nodes and skip them
+		if (!m_IsDelivering)
+		{
+			m_Expired.clear();
+		}
+	}
+
+	void TimerService::Advance(std::chrono::microseconds realTimeDelta, std::chrono::microseconds gameTimeDelta)
+	{
+		xSE_PROFILE_FUNCTION();
+
+		// A callback advancing the timers again would deliver the rest of the current batch twice
+		if (!m_IsDelivering)
+		{
+			AdvanceWheel(GetWheel(TimerClock::RealTime), realTimeDelta);
+			AdvanceWheel(GetWheel(TimerClock::GameTime), gameTimeDelta);
+			Deliver();
+		}
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "Framework.hpp"
+#include <array>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <functional>
+
+namespace xSE
+{
+	enum class TimerClock
+	{
+		// Wall clock time between frames
+		RealTime,
+
+		// Time as reported by the game through 'ProcessFrame(gameTimeDelta)', so it only stops while the game is paused
+		// if the platform passes the game's own delta. With the argument-less 'ProcessFrame' it follows real time.
+		GameTime
+	};
+
+	struct TimerHandle final
+	{
+		uint32_t Index = 0;
+		uint32_t Generation = 0;
+
+		bool IsNull() const noexcept
+		{
+			return Generation == 0;
+		}
+		bool operator==(const TimerHandle&) const noexcept = default;
+	};
+}
+
+namespace xSE
+{
+	// One-shot and repeating timers on two hierarchical timing wheels, one per clock, with a resolution of one
+	// millisecond. Scheduling and cancelling are O(1), advancing costs one slot visit per elapsed tick plus the
+	// expired timers. Both wheels are advanced together once per frame and everything that expired is delivered
+	// as one batch afterwards, a repeating timer fires at most once per frame no matter how short its interval is.
+	// The service isn't thread-safe, it's meant to be used from the main thread only.
+	class xSE_API TimerService final
+	{
+		public:
+			using TCallback = std::function<void()>;
+
+		private:
+			static constexpr size_t SlotBits = 8;
+			static constexpr size_t SlotCount = 1 << SlotBits;
+			static constexpr size_t LevelCount = 4;
+			static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+			enum class NodeState: uint8_t
+			{
+				Free,
+				Pending,
+				Expired
+			};
+			struct Node final
+			{
+				TCallback Callback;
+				uint64_t Expiry = 0;
+				uint64_t Interval = 0;
+				uint32_t Generation = 1;
+				uint32_t Previous = InvalidIndex;
+				uint32_t Next = InvalidIndex;
+				uint16_t Slot = 0;
+				TimerClock Clock = TimerClock::RealTime;
+				NodeState State = NodeState::Free;
+				bool IsRepeating = false;
+			};
+			struct Wheel final
+			{
+				std::array<uint32_t, SlotCount * LevelCount> Slots;
+				std::chrono::microseconds Remainder = {};
+				uint64_t CurrentTick = 0;
+				size_t Count = 0;
+
+				Wheel() noexcept
+				{
+					Slots.fill(InvalidIndex);
+				}
+			};
+
+		private:
+			std::vector<Node> m_Nodes;
+			std::vector<uint32_t> m_Expired;
+			std::array<Wheel, 2> m_Wheels;
+			uint32_t m_FreeList = InvalidIndex;
+			bool m_IsDelivering = false;
+
+		private:
+			Wheel& GetWheel(TimerClock clock) noexcept
+			{
+				return m_Wheels[static_cast<size_t>(clock)];
+			}
+			uint32_t AllocateNode();
+			void FreeNode(uint32_t index) noexcept;
+
+			void Link(Wheel& wheel, uint32_t index) noexcept;
+			void Unlink(Wheel& wheel, uint32_t index) noexcept;
+			void Cascade(Wheel& wheel, size_t level) noexcept;
+			void AdvanceWheel(Wheel& wheel, std::chrono::microseconds delta);
+			void Deliver();
+
+			TimerHandle Schedule(TimerClock clock, std::chrono::milliseconds delay, std::chrono::milliseconds interval, bool repeating, TCallback callback);
+
+		public:
+			TimerService() = default;
+			TimerService(const TimerService&) = delete;
+
+		public:
+			// Fires once after 'delay', zero delay means the next frame
+			TimerHandle Schedule(TimerClock clock, std::chrono::milliseconds delay, TCallback callback)
+			{
+				return Schedule(clock, delay, {}, false, std::move(callback));
+			}
+
+			// Fires every 'interval', zero interval means every frame
+			TimerHandle ScheduleRepeating(TimerClock clock, std::chrono::milliseconds interval, TCallback callback)
+			{
+				return Schedule(clock, interval, interval, true, std::move(callback));
+			}
+
+			// Can be called from a timer callback, including the callback of the timer being cancelled
+			bool Cancel(TimerHandle handle) noexcept;
+			bool IsPending(TimerHandle handle) const noexcept;
+			size_t GetPendingCount() const noexcept;
+			void Clear() noexcept;
+
+			void Advance(std::chrono::microseconds realTimeDelta, std::chrono::microseconds gameTimeDelta);
+
+		public:
+			TimerService& operator=(const TimerService&) = delete;
+	};
+}
@@ -0,0 +1,191 @@
+#include "pch.hpp"
+#include "UTF8.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define xSE_UTF8_X86 1
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define xSE_UTF8_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define xSE_UTF8_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	using TEncodeASCII = size_t(*)(const char16_t* source, size_t length, char* destination) noexcept;
+
+	// Converts the leading ASCII run and returns its length
+	size_t EncodeASCIIScalar(const char16_t* source, size_t length, char* destination) noexcept
+	{
+		size_t i = 0;
+		while (i < length && source[i] < 0x80)
+		{
+			destination[i] = static_cast<char>(source[i]);
+			i++;
+		}
+		return i;
+	}
+
+	#if xSE_UTF8_X86
+	size_t EncodeASCIISSE2(const char16_t* source, size_t length, char* destination) noexcept
+	{
+		const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(value, mask), zero)) != 0xFFFF)
+			{
+				break;
+			}
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(value, value));
+		}
+		return i + EncodeASCIIScalar(source + i, length - i, destination + i);
+	}
+
+	xSE_UTF8_TARGET_AVX2
+	size_t EncodeASCIIAVX2(const char16_t* source, size_t length, char* destination) noexcept
+	{
+		const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFF80));
+
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			if (!_mm256_testz_si256(value, mask))
+			{
+				break;
+			}
+
+			// Packing works per 128-bit lane, the two low quadwords hold the sixteen bytes in order
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(value, value), 0b00'00'10'00);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm256_castsi256_si128(packed));
+		}
+		return i + EncodeASCIISSE2(source + i, length - i, destination + i);
+	}
+
+	bool IsAVX2Supported() noexcept
+	{
+		#if defined(_MSC_VER)
+		int info[4] = {};
+		__cpuid(info, 1);
+
+		// The OS has to save the YMM registers as well, not only the CPU support the instructions
+		const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+		const bool hasAVX = (info[2] & (1 << 28)) != 0;
+		if (!hasOSXSAVE || !hasAVX || (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+		#else
+		return __builtin_cpu_supports("avx2");
+		#endif
+	}
+	#endif
+
+	TEncodeASCII SelectEncodeASCII() noexcept
+	{
+		#if xSE_UTF8_X86
+		return IsAVX2Supported() ? EncodeASCIIAVX2 : EncodeASCIISSE2;
+		#else
+		return EncodeASCIIScalar;
+		#endif
+	}
+
+	size_t EncodeWith(TEncodeASCII encodeASCII, std::u16string_view source, char* destination) noexcept
+	{
+		const char16_t* data = source.data();
+		const size_t length = source.size();
+		char* out = destination;
+
+		size_t i = 0;
+		while (i < length)
+		{
+			const size_t asciiLength = encodeASCII(data + i, length - i, out);
+			i += asciiLength;
+			out += asciiLength;
+
+			// Everything up to the next ASCII character
+			while (i < length && data[i] >= 0x80)
+			{
+				const char32_t c = data[i];
+				if (c < 0x800)
+				{
+					*out++ = static_cast<char>(0xC0|(c >> 6));
+					*out++ = static_cast<char>(0x80|(c & 0x3F));
+					i++;
+				}
+				else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF)
+				{
+					const char32_t codePoint = 0x10000 + ((c - 0xD800) << 10) + (data[i + 1] - 0xDC00);
+					*out++ = static_cast<char>(0xF0|(codePoint >> 18));
+					*out++ = static_cast<char>(0x80|((codePoint >> 12) & 0x3F));
+					*out++ = static_cast<char>(0x80|((codePoint >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80|(codePoint & 0x3F));
+					i += 2;
+				}
+				else
+				{
+					// Unpaired surrogates become U+FFFD, which happens to have the same three byte form as the rest
+					const char32_t codePoint = c >= 0xD800 && c <= 0xDFFF ? 0xFFFD : c;
+					*out++ = static_cast<char>(0xE0|(codePoint >> 12));
+					*out++ = static_cast<char>(0x80|((codePoint >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80|(codePoint & 0x3F));
+					i++;
+				}
+			}
+		}
+		return static_cast<size_t>(out - destination);
+	}
+}
+
+namespace xSE::UTF8
+{
+	size_t Encode(std::u16string_view source, char* destination) noexcept
+	{
+		// Selected on first use rather than during static initialization, loggers may run before that
+		static const TEncodeASCII g_EncodeASCII = SelectEncodeASCII();
+
+		return EncodeWith(g_EncodeASCII, source, destination);
+	}
+	bool EncodeUsing(EncodePath path, std::u16string_view source, char* destination, size_t& written) noexcept
+	{
+		TEncodeASCII encodeASCII = nullptr;
+		switch (path)
+		{
+			case EncodePath::Scalar:
+			{
+				encodeASCII = EncodeASCIIScalar;
+				break;
+			}
+			#if xSE_UTF8_X86
+			case EncodePath::SSE2:
+			{
+				encodeASCII = EncodeASCIISSE2;
+				break;
+			}
+			case EncodePath::AVX2:
+			{
+				encodeASCII = IsAVX2Supported() ? EncodeASCIIAVX2 : nullptr;
+				break;
+			}
+			#endif
+		};
+
+		if (encodeASCII)
+		{
+			written = EncodeWith(encodeASCII, source, destination);
+			return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Framework.hpp"
+#include <string>
+#include <string_view>
+
+// UTF-16 to UTF-8 conversion for the log and path hot paths. ASCII runs are converted 16 (AVX2) or 8 (SSE2) characters
+// at a time, everything else falls back to a scalar loop until the next ASCII run. Unpaired surrogates are replaced
+// with U+FFFD. Conversions append to an existing buffer so callers can build whole lines without temporaries.
+namespace xSE::UTF8
+{
+	// Worst case, three bytes per UTF-16 code unit
+	constexpr size_t GetMaxEncodedLength(size_t length) noexcept
+	{
+		return length * 3;
+	}
+
+	// Writes at most 'GetMaxEncodedLength(source.size())' bytes and returns the number of bytes written
+	xSE_API size_t Encode(std::u16string_view source, char* destination) noexcept;
+
+	// Same as 'Encode' but converting ASCII runs with the given implementation, for testing the vectorized ones against
+	// the scalar loop. Returns false without writing anything if the CPU doesn't support it.
+	enum class EncodePath
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+	xSE_API bool EncodeUsing(EncodePath path, std::u16string_view source, char* destination, size_t& written) noexcept;
+
+	inline std::u16string_view View(std::wstring_view value) noexcept
+	{
+		static_assert(sizeof(wchar_t) == sizeof(char16_t));
+		return {reinterpret_cast<const char16_t*>(value.data()), value.size()};
+	}
+	inline std::u16string_view View(const kxf::String& value) noexcept
+	{
+		return View(std::wstring_view(value.wc_str(), value.length()));
+	}
+
+	template<class TString>
+	void Append(TString& buffer, std::u16string_view source)
+	{
+		const size_t offset = buffer.size();
+
+		#if __cpp_lib_string_resize_and_overwrite
+		buffer.resize_and_overwrite(offset + GetMaxEncodedLength(source.size()), [&](char* data, size_t)
+		{
+			return offset + Encode(source, data + offset);
+		});
+		#else
+		buffer.resize(offset + GetMaxEncodedLength(source.size()));
+		buffer.resize(offset + Encode(source, buffer.data() + offset));
+		#endif
+	}
+	template<class TString>
+	void Append(TString& buffer, const kxf::String& source)
+	{
+		Append(buffer, View(source));
+	}
+
+	inline std::string ToString(const kxf::String& source)
+	{
+		std::string result;
+		Append(result, View(source));
+		return result;
+	}
+}
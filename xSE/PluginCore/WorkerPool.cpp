@@ -0,0 +1,146 @@
+#include "pch.hpp"
+#include "WorkerPool.h"
+#include <atomic>
+
+namespace xSE
+{
+	void WorkerPool::Run()
+	{
+		for (;;)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock lock(m_Lock);
+				m_Condition.wait(lock, [&]()
+				{
+					return m_Stop || !m_Tasks.empty();
+				});
+
+				if (m_Tasks.empty())
+				{
+					return;
+				}
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	WorkerPool::WorkerPool(size_t threadCount)
+		:m_ThreadCount(threadCount)
+	{
+		if (m_ThreadCount == 0)
+		{
+			const size_t hardwareThreads = std::thread::hardware_concurrency();
+			m_ThreadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+	}
+	WorkerPool::~WorkerPool()
+	{
+		Shutdown();
+	}
+
+	void WorkerPool::Post(std::function<void()> func)
+	{
+		{
+			std::unique_lock lock(m_Lock);
+			if (m_IsShutDown)
+			{
+				lock.unlock();
+				func();
+				return;
+			}
+
+			if (m_Threads.empty())
+			{
+				m_Threads.reserve(m_ThreadCount);
+				for (size_t i = 0; i < m_ThreadCount; i++)
+				{
+					m_Threads.emplace_back([this]()
+					{
+						Run();
+					});
+				}
+			}
+			m_Tasks.emplace_back(std::move(func));
+		}
+		m_Condition.notify_one();
+	}
+	void WorkerPool::ParallelFor(size_t count, std::function<void(size_t)> func)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		else if (count == 1)
+		{
+			func(0);
+			return;
+		}
+
+		// Helpers may start after all the work is done, so the state is shared with them rather than living on this stack
+		struct State final
+		{
+			std::function<void(size_t)> Func;
+			size_t Count = 0;
+			std::atomic<size_t> NextIndex = 0;
+			std::atomic<size_t> Completed = 0;
+			std::mutex Lock;
+			std::condition_variable Condition;
+
+			void Process()
+			{
+				size_t processed = 0;
+				for (size_t i = NextIndex.fetch_add(1, std::memory_order_relaxed); i < Count; i = NextIndex.fetch_add(1, std::memory_order_relaxed))
+				{
+					Func(i);
+					processed++;
+				}
+
+				if (processed != 0 && Completed.fetch_add(processed, std::memory_order_acq_rel) + processed == Count)
+				{
+					std::lock_guard lock(Lock);
+					Condition.notify_all();
+				}
+			}
+		};
+		auto state = std::make_shared<State>();
+		state->Func = std::move(func);
+		state->Count = count;
+
+		const size_t helperCount = std::min(m_ThreadCount, count - 1);
+		for (size_t i = 0; i < helperCount; i++)
+		{
+			Post([state]()
+			{
+				state->Process();
+			});
+		}
+		state->Process();
+
+		std::unique_lock lock(state->Lock);
+		state->Condition.wait(lock, [&]()
+		{
+			return state->Completed.load(std::memory_order_acquire) == count;
+		});
+	}
+
+	void WorkerPool::Shutdown()
+	{
+		std::vector<std::thread> threads;
+		{
+			std::lock_guard lock(m_Lock);
+			m_Stop = true;
+			m_IsShutDown = true;
+			threads = std::move(m_Threads);
+		}
+		m_Condition.notify_all();
+
+		// Workers only exit once the queue is empty
+		for (auto& thread: threads)
+		{
+			thread.join();
+		}
+	}
+}
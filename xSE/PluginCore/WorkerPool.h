@@ -0,0 +1,68 @@
+#pragma once
+#include "Framework.hpp"
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <future>
+#include <functional>
+#include <condition_variable>
+
+namespace xSE
+{
+	// Fixed set of background threads for CPU-bound work such as decompression and parsing. Threads are only started
+	// when the first task is posted so a pool nobody uses costs nothing. The platform shuts the pool down from
+	// 'Terminate', joining the threads from a static destructor would happen under the loader lock.
+	class xSE_API WorkerPool final
+	{
+		private:
+			std::mutex m_Lock;
+			std::condition_variable m_Condition;
+			std::deque<std::function<void()>> m_Tasks;
+			std::vector<std::thread> m_Threads;
+			size_t m_ThreadCount = 0;
+			bool m_Stop = false;
+			bool m_IsShutDown = false;
+
+		private:
+			void Run();
+
+		public:
+			// Zero means one thread less than the number of hardware threads, the game keeps the main thread busy anyway
+			WorkerPool(size_t threadCount = 0);
+			WorkerPool(const WorkerPool&) = delete;
+			~WorkerPool();
+
+		public:
+			size_t GetThreadCount() const noexcept
+			{
+				return m_ThreadCount;
+			}
+
+			// After 'Shutdown' the task runs on the calling thread instead
+			void Post(std::function<void()> func);
+
+			template<class TFunc>
+			auto Submit(TFunc&& func) -> std::future<std::invoke_result_t<TFunc>>
+			{
+				using TResult = std::invoke_result_t<TFunc>;
+
+				auto task = std::make_shared<std::packaged_task<TResult()>>(std::forward<TFunc>(func));
+				auto future = task->get_future();
+				Post([task = std::move(task)]()
+				{
+					(*task)();
+				});
+				return future;
+			}
+
+			// Calls 'func' for every index in [0, count) on the pool threads and the calling thread, returns when all calls are done
+			void ParallelFor(size_t count, std::function<void(size_t)> func);
+
+			// Runs the tasks already posted and joins the threads, must not be called from a pool thread
+			void Shutdown();
+
+		public:
+			WorkerPool& operator=(const WorkerPool&) = delete;
+	};
+}